@@ -22,11 +22,77 @@ TEMPLATE = app
 SOURCES += \
 	src/main.cpp\
     src/ui/dialog.cpp \
+    src/ui/graph_loader.cpp \
+    src/ui/include_tree_model.cpp \
+    src/ui/removal_simulator.cpp \
+    src/analysis/compile_driver.cpp \
+    src/analysis/dominator_tree.cpp \
+    src/analysis/graph_diff.cpp \
+    src/analysis/include_aggregate.cpp \
+    src/analysis/include_chains.cpp \
+    src/analysis/path_rollups.cpp \
+    src/analysis/pch_recommender.cpp \
+    src/analysis/redundant_includes.cpp \
+    src/analysis/size_changes.cpp \
+    src/analysis/top_offenders.cpp \
+    src/parse/compile_commands.cpp \
+    src/parse/graph_snapshot.cpp \
+    src/parse/include_log_parser.cpp \
+    src/parse/json_reader.cpp \
+    src/parse/path_normaliser.cpp \
+    src/parse/time_trace.cpp \
+    src/report/aggregate_report.cpp \
+    src/report/chain_report.cpp \
+    src/report/diff_report.cpp \
+    src/report/include_report.cpp \
+    src/report/offender_report.cpp \
+    src/report/pch_report.cpp \
+    src/report/redundant_report.cpp \
+    src/report/report_format.cpp \
+    src/report/report_command.cpp \
     contrib/cpp_dep/cpp_dep.cpp
 
 HEADERS  += \
 	src/ui/dialog.hpp \
-	src/ui/include_tree_widget_item.hpp \
+	src/ui/async_ui_task.hpp \
+	src/ui/graph_loader.hpp \
+	src/ui/include_tree.hpp \
+	src/ui/include_tree_model.hpp \
+	src/ui/removal_simulator.hpp \
+	src/ui/tree_view_builder.hpp \
+	src/util/fenwick_tree.hpp \
+	src/util/filter_query.hpp \
+	src/util/incremental_tree_filter.hpp \
+	src/util/parallel_for.hpp \
+	src/util/parallel_top_n.hpp \
+	src/util/path_table.hpp \
+	src/util/substring_index.hpp \
+	src/util/task_monitor.hpp \
+    src/analysis/compile_driver.hpp \
+    src/analysis/dominator_tree.hpp \
+    src/analysis/graph_diff.hpp \
+    src/analysis/include_aggregate.hpp \
+    src/analysis/include_chains.hpp \
+    src/analysis/path_rollups.hpp \
+    src/analysis/pch_recommender.hpp \
+    src/analysis/redundant_includes.hpp \
+    src/analysis/size_changes.hpp \
+    src/analysis/top_offenders.hpp \
+    src/parse/compile_commands.hpp \
+    src/parse/graph_snapshot.hpp \
+    src/parse/include_log_parser.hpp \
+    src/parse/json_reader.hpp \
+    src/parse/path_normaliser.hpp \
+    src/parse/time_trace.hpp \
+    src/report/aggregate_report.hpp \
+    src/report/chain_report.hpp \
+    src/report/diff_report.hpp \
+    src/report/include_report.hpp \
+    src/report/offender_report.hpp \
+    src/report/pch_report.hpp \
+    src/report/redundant_report.hpp \
+    src/report/report_format.hpp \
+    src/report/report_command.hpp \
     contrib/cpp_dep/cpp_dep.hpp
 
 FORMS += forms/dialog.ui
@@ -0,0 +1,156 @@
+// *****************************************************************************
+//
+// analysis/compile_driver.cpp
+//
+// Generates include logs by running the compiler.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "analysis/compile_driver.hpp"
+#include "parse/include_log_parser.hpp"
+#include "util/parallel_for.hpp"
+#include <boost/filesystem.hpp>
+#include <boost/process.hpp>
+#include <atomic>
+#include <stdexcept>
+
+// -----------------------------------------------------------------------------
+//
+cpp_dep::include_graph_t run_include_listing(
+    compile_command const& command,
+    task_monitor const* monitor,
+    path_normaliser const& normaliser)
+{
+    namespace bp = boost::process;
+    namespace fs = boost::filesystem;
+
+    std::vector<std::string> args = make_include_listing_command(command);
+    fs::path compiler = args.front();
+    if(!compiler.has_parent_path())
+        compiler = bp::search_path(compiler);
+
+    if(compiler.empty())
+        throw std::runtime_error("Compiler \"" + args.front() + "\" not found");
+
+    fs::path directory = command.directory.empty()
+        ? fs::current_path()
+        : fs::path(command.directory);
+
+    include_log_builder builder(fs::absolute(command.file, directory).string(), normaliser);
+
+    // The preprocessed source is thrown away, the include listing is
+    // on stderr for both gcc and msvc style compilers.
+    bp::ipstream listing;
+    bp::child child(
+        compiler,
+        bp::args(std::vector<std::string>(args.begin() + 1, args.end())),
+        bp::start_dir(directory),
+        bp::std_in < bp::null,
+        bp::std_out > bp::null,
+        bp::std_err > listing);
+
+    std::string line;
+    std::string absolute_line;
+    while(std::getline(listing, line))
+    {
+        if(monitor && monitor->cancelled())
+        {
+            child.terminate();
+            monitor->check_cancelled();
+        }
+
+        if(!line.empty() && line.back() == '\r')
+            line.pop_back();
+
+        char const* first = line.data();
+        char const* last = first + line.size();
+        include_log_line parsed = classify_include_log_line(first, last);
+
+        // msvc echoes the source name, which is already the root.
+        if(parsed.kind == include_log_line::source)
+            continue;
+
+        if(parsed.kind != include_log_line::include)
+        {
+            builder.add_line(first, last);
+            continue;
+        }
+
+        // Names are printed relative to the compiler's working directory,
+        // which isn't ours and differs between commands.
+        fs::path name(parsed.name_first, parsed.name_last);
+        if(name.is_absolute())
+        {
+            builder.add_line(first, last);
+            continue;
+        }
+
+        absolute_line.assign(first, parsed.name_first);
+        absolute_line += (directory / name).lexically_normal().string();
+        builder.add_line(absolute_line.data(), absolute_line.data() + absolute_line.size());
+    }
+
+    child.wait();
+    if(child.exit_code() != 0)
+    {
+        throw std::runtime_error(
+            "\"" + compiler.string() + "\" exited with " +
+            std::to_string(child.exit_code()));
+    }
+
+    return builder.finish(1);
+}
+
+// -----------------------------------------------------------------------------
+//
+include_aggregate aggregate_compile_commands(
+    std::vector<compile_command> const& commands,
+    unsigned num_threads,
+    task_monitor* monitor,
+    path_normaliser const& normaliser)
+{
+    num_threads = resolve_thread_count(num_threads, commands.size());
+
+    // Threads pull the next command as they finish the last, so a few
+    // slow translation units don't hold up the rest, and each result is
+    // folded into the thread's own aggregate and dropped straight away.
+    std::vector<include_aggregate> partials(num_threads);
+    std::atomic<std::size_t> commands_done(0);
+    parallel_for(
+        commands.size(),
+        num_threads,
+        [&commands, &partials, &commands_done, &normaliser, monitor](unsigned thread, std::size_t i)
+        {
+            check_cancelled(monitor);
+            try
+            {
+                partials[thread].add(run_include_listing(commands[i], monitor, normaliser));
+            }
+            catch(task_cancelled&)
+            {
+                throw;
+            }
+            catch(std::exception& e)
+            {
+                partials[thread].add_error(commands[i].file + ": " + e.what());
+            }
+
+            report_progress(
+                monitor, "Compiling",
+                static_cast<int>((++commands_done * 100) / commands.size()));
+        }
+    );
+
+    include_aggregate result;
+    for(auto&& partial : partials)
+    {
+        result.merge(partial);
+    }
+
+    return result;
+}
@@ -0,0 +1,45 @@
+// *****************************************************************************
+//
+// analysis/compile_driver.hpp
+//
+// Generates include logs by running the compiler over every entry of a
+// compilation database. Each compiler's include listing is streamed
+// straight into a parser, nothing is written to disk, and each translation
+// unit is folded into the aggregate as soon as it finishes so memory stays
+// bounded however many there are.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_ANALYSIS_COMPILEDRIVER_HPP_
+#define CPPSIZE_ANALYSIS_COMPILEDRIVER_HPP_
+
+#include "analysis/include_aggregate.hpp"
+#include "parse/compile_commands.hpp"
+#include "parse/path_normaliser.hpp"
+#include "util/task_monitor.hpp"
+
+// -----------------------------------------------------------------------------
+//
+// Runs the include listing for one command and builds its graph. Header
+// names are made absolute against the command's directory. Throws
+// std::runtime_error if the compiler can't be run or fails.
+cpp_dep::include_graph_t run_include_listing(
+    compile_command const& command,
+    task_monitor const* monitor = nullptr,
+    path_normaliser const& normaliser = path_normaliser());
+
+// Runs every command with at most num_threads compilers at once (0 picks
+// the hardware concurrency) and aggregates the results. Commands that fail
+// are recorded in errors().
+include_aggregate aggregate_compile_commands(
+    std::vector<compile_command> const& commands,
+    unsigned num_threads = 0,
+    task_monitor* monitor = nullptr,
+    path_normaliser const& normaliser = path_normaliser());
+
+#endif // CPPSIZE_ANALYSIS_COMPILEDRIVER_HPP_
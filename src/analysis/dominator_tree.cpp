@@ -0,0 +1,310 @@
+// *****************************************************************************
+//
+// analysis/dominator_tree.cpp
+//
+// Dominator tree of an include graph.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "analysis/dominator_tree.hpp"
+#include <boost/range/iterator_range.hpp>
+#include <cstdint>
+#include <utility>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+typedef std::uint32_t dfs_index_t;
+dfs_index_t const kNone = ~dfs_index_t(0);
+
+// Lengauer-Tarjan over vertices renumbered in depth first order, with
+// number 0 being the virtual root. Uses the simple link/eval with path
+// compression, which is O(E log V) and close enough to linear for include
+// graphs. Everything is iterative because include chains can be deep.
+class dominator_builder
+{
+public:
+
+    explicit dominator_builder(cpp_dep::include_graph_t const& g)
+        : g_(g)
+    {}
+
+    // Returns the immediate dominator of each dfs number, 0 for the
+    // virtual root.
+    std::vector<dfs_index_t> build()
+    {
+        number_vertices();
+        collect_predecessors();
+
+        std::size_t n = vertex_of_.size();
+        std::vector<dfs_index_t> idom(n, 0);
+        semi_.resize(n);
+        label_.resize(n);
+        ancestor_.assign(n, kNone);
+        for(dfs_index_t i = 0; i < n; ++i)
+        {
+            semi_[i] = i;
+            label_[i] = i;
+        }
+
+        std::vector<std::vector<dfs_index_t>> bucket(n);
+        for(dfs_index_t w = static_cast<dfs_index_t>(n); w-- > 1; )
+        {
+            for(std::size_t p = pred_offsets_[w]; p < pred_offsets_[w + 1]; ++p)
+            {
+                dfs_index_t u = eval(preds_[p]);
+                if(semi_[u] < semi_[w])
+                    semi_[w] = semi_[u];
+            }
+
+            bucket[semi_[w]].push_back(w);
+            ancestor_[w] = parent_[w];
+
+            for(dfs_index_t v : bucket[parent_[w]])
+            {
+                dfs_index_t u = eval(v);
+                idom[v] = semi_[u] < semi_[v] ? u : parent_[w];
+            }
+
+            bucket[parent_[w]].clear();
+        }
+
+        for(dfs_index_t w = 1; w < n; ++w)
+        {
+            if(idom[w] != semi_[w])
+                idom[w] = idom[idom[w]];
+        }
+
+        return idom;
+    }
+
+    cpp_dep::include_vertex_descriptor_t vertex(dfs_index_t i) const
+    {
+        return vertex_of_[i];
+    }
+
+    std::size_t size() const
+    {
+        return vertex_of_.size();
+    }
+
+private:
+
+    void number_vertices()
+    {
+        std::size_t num_vertices = boost::num_vertices(g_);
+        dfs_number_.assign(num_vertices, kNone);
+        vertex_of_.assign(1, boost::graph_traits<cpp_dep::include_graph_t>::null_vertex());
+        parent_.assign(1, 0);
+
+        // Everything nothing includes hangs off the virtual root. Anything
+        // left over after that is only reachable through a cycle, so it
+        // gets hung off the root too.
+        std::vector<bool> included(num_vertices, false);
+        for(auto v : boost::make_iterator_range(boost::vertices(g_)))
+        {
+            for(auto child : boost::make_iterator_range(boost::adjacent_vertices(v, g_)))
+            {
+                included[child] = true;
+            }
+        }
+
+        for(auto v : boost::make_iterator_range(boost::vertices(g_)))
+        {
+            if(!included[v])
+                visit_from_root(v);
+        }
+
+        for(auto v : boost::make_iterator_range(boost::vertices(g_)))
+        {
+            if(dfs_number_[v] == kNone)
+                visit_from_root(v);
+        }
+    }
+
+    void visit_from_root(cpp_dep::include_vertex_descriptor_t start)
+    {
+        typedef boost::graph_traits<
+            cpp_dep::include_graph_t
+        >::adjacency_iterator adjacency_iterator;
+
+        struct frame
+        {
+            cpp_dep::include_vertex_descriptor_t vertex;
+            adjacency_iterator next;
+            adjacency_iterator last;
+        };
+
+        roots_.push_back(start);
+        add_vertex(start, 0);
+
+        std::vector<frame> stack;
+        auto children = boost::adjacent_vertices(start, g_);
+        stack.push_back(frame{start, children.first, children.second});
+        while(!stack.empty())
+        {
+            frame& top = stack.back();
+            if(top.next == top.last)
+            {
+                stack.pop_back();
+                continue;
+            }
+
+            cpp_dep::include_vertex_descriptor_t child = *top.next++;
+            if(dfs_number_[child] != kNone)
+                continue;
+
+            add_vertex(child, dfs_number_[top.vertex]);
+            children = boost::adjacent_vertices(child, g_);
+            stack.push_back(frame{child, children.first, children.second});
+        }
+    }
+
+    void add_vertex(cpp_dep::include_vertex_descriptor_t v, dfs_index_t parent)
+    {
+        dfs_number_[v] = static_cast<dfs_index_t>(vertex_of_.size());
+        vertex_of_.push_back(v);
+        parent_.push_back(parent);
+    }
+
+    void collect_predecessors()
+    {
+        std::size_t n = vertex_of_.size();
+        pred_offsets_.assign(n + 1, 0);
+        auto count_edges = [&](bool fill)
+        {
+            std::vector<std::size_t> next;
+            if(fill)
+                next.assign(pred_offsets_.begin(), pred_offsets_.end() - 1);
+
+            auto add = [&](dfs_index_t from, dfs_index_t to)
+            {
+                if(fill)
+                    preds_[next[to]++] = from;
+                else
+                    ++pred_offsets_[to + 1];
+            };
+
+            for(auto root : roots_)
+            {
+                add(0, dfs_number_[root]);
+            }
+
+            for(auto v : boost::make_iterator_range(boost::vertices(g_)))
+            {
+                for(auto child : boost::make_iterator_range(boost::adjacent_vertices(v, g_)))
+                {
+                    add(dfs_number_[v], dfs_number_[child]);
+                }
+            }
+        };
+
+        count_edges(false);
+        for(std::size_t i = 1; i <= n; ++i)
+        {
+            pred_offsets_[i] += pred_offsets_[i - 1];
+        }
+
+        preds_.resize(pred_offsets_[n]);
+        count_edges(true);
+    }
+
+    dfs_index_t eval(dfs_index_t v)
+    {
+        if(ancestor_[v] == kNone)
+            return v;
+
+        compress(v);
+        return label_[v];
+    }
+
+    void compress(dfs_index_t v)
+    {
+        // Walk up to the top of the forest, then shorten the path from
+        // the top down so each step sees its already compressed ancestor.
+        path_.clear();
+        for(dfs_index_t x = v; ancestor_[ancestor_[x]] != kNone; x = ancestor_[x])
+        {
+            path_.push_back(x);
+        }
+
+        while(!path_.empty())
+        {
+            dfs_index_t x = path_.back();
+            path_.pop_back();
+
+            dfs_index_t a = ancestor_[x];
+            if(semi_[label_[a]] < semi_[label_[x]])
+                label_[x] = label_[a];
+
+            ancestor_[x] = ancestor_[a];
+        }
+    }
+
+    cpp_dep::include_graph_t const& g_;
+    std::vector<dfs_index_t> dfs_number_;
+    std::vector<cpp_dep::include_vertex_descriptor_t> vertex_of_;
+    std::vector<cpp_dep::include_vertex_descriptor_t> roots_;
+    std::vector<dfs_index_t> parent_;
+    std::vector<std::size_t> pred_offsets_;
+    std::vector<dfs_index_t> preds_;
+    std::vector<dfs_index_t> semi_;
+    std::vector<dfs_index_t> label_;
+    std::vector<dfs_index_t> ancestor_;
+    std::vector<dfs_index_t> path_;
+};
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+//
+std::vector<cpp_dep::include_vertex_descriptor_t> immediate_dominators(
+    cpp_dep::include_graph_t const& g)
+{
+    dominator_builder builder(g);
+    std::vector<dfs_index_t> idom = builder.build();
+
+    std::vector<cpp_dep::include_vertex_descriptor_t> result(
+        boost::num_vertices(g),
+        boost::graph_traits<cpp_dep::include_graph_t>::null_vertex());
+
+    for(dfs_index_t w = 1; w < builder.size(); ++w)
+    {
+        if(idom[w] != 0)
+            result[builder.vertex(w)] = builder.vertex(idom[w]);
+    }
+
+    return result;
+}
+
+// -----------------------------------------------------------------------------
+//
+std::vector<std::size_t> exclusive_sizes(
+    cpp_dep::include_graph_t const& g)
+{
+    dominator_builder builder(g);
+    std::vector<dfs_index_t> idom = builder.build();
+
+    // A dominator is always numbered before what it dominates, so
+    // one pass in reverse order sums every dominator subtree.
+    std::vector<std::size_t> exclusive(builder.size(), 0);
+    for(dfs_index_t w = static_cast<dfs_index_t>(builder.size()); w-- > 1; )
+    {
+        exclusive[w] += g[builder.vertex(w)].size;
+        exclusive[idom[w]] += exclusive[w];
+    }
+
+    std::vector<std::size_t> result(boost::num_vertices(g), 0);
+    for(dfs_index_t w = 1; w < builder.size(); ++w)
+    {
+        result[builder.vertex(w)] = exclusive[w];
+    }
+
+    return result;
+}
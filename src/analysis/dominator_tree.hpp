@@ -0,0 +1,37 @@
+// *****************************************************************************
+//
+// analysis/dominator_tree.hpp
+//
+// Dominator tree of an include graph. A header dominates another if every
+// chain of includes that reaches the second passes through the first, so
+// removing the dominator takes everything it dominates with it.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_ANALYSIS_DOMINATORTREE_HPP_
+#define CPPSIZE_ANALYSIS_DOMINATORTREE_HPP_
+
+#include "cpp_dep/cpp_dep.hpp"
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+// Immediate dominator of every vertex, computed with Lengauer-Tarjan from a
+// virtual root above every vertex nothing includes. Vertices only dominated
+// by that virtual root get boost::graph_traits<include_graph_t>::null_vertex().
+std::vector<cpp_dep::include_vertex_descriptor_t> immediate_dominators(
+    cpp_dep::include_graph_t const& g);
+
+// -----------------------------------------------------------------------------
+//
+// Bytes that disappear if a header is removed: its own size plus the size
+// of everything it dominates. Indexed by vertex.
+std::vector<std::size_t> exclusive_sizes(
+    cpp_dep::include_graph_t const& g);
+
+#endif // CPPSIZE_ANALYSIS_DOMINATORTREE_HPP_
@@ -0,0 +1,270 @@
+// *****************************************************************************
+//
+// analysis/graph_diff.cpp
+//
+// Compares two include graphs.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "analysis/graph_diff.hpp"
+#include <boost/range/iterator_range.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <unordered_map>
+#include <unordered_set>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+typedef std::uint32_t header_id;
+
+// Can't be a path, so no header is mistaken for a log.
+char const kLogRootKey[] = "<log>";
+
+// Folded to lower case since log roots can have been normalised to lower
+// case and the logs themselves haven't been.
+std::string file_name(std::string const& path)
+{
+    std::size_t slash = path.find_last_of("/\\");
+    std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+    std::transform(
+        name.begin(), name.end(), name.begin(),
+        [](char c)
+        {
+            return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+        }
+    );
+
+    return name;
+}
+
+// Both graphs' vertices mapped onto one set of header ids, so headers and
+// edges can be compared as integers.
+class header_ids
+{
+public:
+
+    std::vector<header_id> add_graph(diff_input const& input)
+    {
+        // The root is named with whatever path the log was first loaded
+        // through, which a snapshot keeps, so roots are recognised by
+        // file name and by nothing including them.
+        std::unordered_set<std::string> logs;
+        for(auto&& log : input.logs)
+            logs.insert(file_name(log));
+
+        cpp_dep::include_graph_t const& g = *input.graph;
+        std::vector<char> included(boost::num_vertices(g), 0);
+        for(auto v : boost::make_iterator_range(boost::vertices(g)))
+        {
+            for(auto u : boost::make_iterator_range(boost::adjacent_vertices(v, g)))
+                included[u] = 1;
+        }
+
+        std::vector<header_id> ids;
+        ids.reserve(boost::num_vertices(g));
+        ids_.reserve(ids_.size() + boost::num_vertices(g));
+        for(auto v : boost::make_iterator_range(boost::vertices(g)))
+        {
+            bool is_log = !included[v] && logs.count(file_name(g[v].name));
+            std::string const& key = is_log ? std::string(kLogRootKey) : g[v].name;
+            auto inserted = ids_.emplace(key, header_id(ids_.size()));
+            ids.push_back(inserted.first->second);
+        }
+
+        return ids;
+    }
+
+    std::size_t size() const
+    {
+        return ids_.size();
+    }
+
+private:
+
+    std::unordered_map<std::string, header_id> ids_;
+};
+
+// Every edge of g as a pair of header ids, sorted. A sorted vector is
+// several times faster to build and probe than a hash set here.
+std::vector<std::uint64_t> edge_keys(
+    cpp_dep::include_graph_t const& g,
+    std::vector<header_id> const& ids)
+{
+    std::vector<std::uint64_t> keys;
+    keys.reserve(boost::num_edges(g));
+    for(auto v : boost::make_iterator_range(boost::vertices(g)))
+    {
+        for(auto u : boost::make_iterator_range(boost::adjacent_vertices(v, g)))
+            keys.push_back((std::uint64_t(ids[v]) << 32) | ids[u]);
+    }
+
+    std::sort(keys.begin(), keys.end());
+    return keys;
+}
+
+struct edge_ref
+{
+    cpp_dep::include_vertex_descriptor_t from;
+    cpp_dep::include_vertex_descriptor_t to;
+    std::size_t cost;
+};
+
+// Edges of g that other doesn't have, most expensive first.
+std::vector<edge_ref> missing_edges(
+    cpp_dep::include_graph_t const& g,
+    std::vector<header_id> const& ids,
+    std::vector<std::size_t> const& costs,
+    std::vector<std::uint64_t> const& other)
+{
+    std::vector<edge_ref> missing;
+    for(auto v : boost::make_iterator_range(boost::vertices(g)))
+    {
+        for(auto u : boost::make_iterator_range(boost::adjacent_vertices(v, g)))
+        {
+            std::uint64_t key = (std::uint64_t(ids[v]) << 32) | ids[u];
+            if(!std::binary_search(other.begin(), other.end(), key))
+                missing.push_back({ v, u, costs[u] });
+        }
+    }
+
+    std::stable_sort(
+        missing.begin(),
+        missing.end(),
+        [](edge_ref const& a, edge_ref const& b)
+        {
+            return a.cost > b.cost;
+        }
+    );
+
+    return missing;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+//
+std::vector<std::size_t> project_costs(
+    cpp_dep::include_graph_t const& g,
+    aggregate_stats_t const* stats)
+{
+    std::vector<std::size_t> costs(boost::num_vertices(g));
+    for(auto v : boost::make_iterator_range(boost::vertices(g)))
+    {
+        costs[v] = stats
+            ? (*stats)[v].transitive_size
+            : g[v].size + g[v].size_dependencies;
+    }
+
+    return costs;
+}
+
+// -----------------------------------------------------------------------------
+//
+graph_diff diff_graphs(diff_input const& before_input, diff_input const& after_input)
+{
+    cpp_dep::include_graph_t const& before = *before_input.graph;
+    cpp_dep::include_graph_t const& after = *after_input.graph;
+    std::vector<std::size_t> const& costs_before = before_input.costs;
+    std::vector<std::size_t> const& costs_after = after_input.costs;
+
+    header_ids ids;
+    std::vector<header_id> before_ids = ids.add_graph(before_input);
+    std::vector<header_id> after_ids = ids.add_graph(after_input);
+
+    // Per header id, the vertex on each side if there is one.
+    cpp_dep::include_vertex_descriptor_t const no_vertex =
+        boost::graph_traits<cpp_dep::include_graph_t>::null_vertex();
+    std::vector<cpp_dep::include_vertex_descriptor_t> before_vertex(ids.size(), no_vertex);
+    std::vector<cpp_dep::include_vertex_descriptor_t> after_vertex(ids.size(), no_vertex);
+    for(auto v : boost::make_iterator_range(boost::vertices(before)))
+        before_vertex[before_ids[v]] = v;
+    for(auto v : boost::make_iterator_range(boost::vertices(after)))
+        after_vertex[after_ids[v]] = v;
+
+    graph_diff diff;
+    diff.total_delta = 0;
+
+    // Header index in diff.headers by header id, once sorted.
+    std::vector<std::size_t> header_index(ids.size(), std::size_t(-1));
+    for(header_id id = 0; id < ids.size(); ++id)
+    {
+        bool in_before = before_vertex[id] != no_vertex;
+        bool in_after = after_vertex[id] != no_vertex;
+
+        header_diff h;
+        h.cost_before = in_before ? costs_before[before_vertex[id]] : 0;
+        h.cost_after = in_after ? costs_after[after_vertex[id]] : 0;
+        h.state = !in_before ? header_diff::added
+                : !in_after  ? header_diff::removed
+                : header_diff::changed;
+
+        if(h.cost_before == h.cost_after)
+            continue;
+
+        h.name = in_after ? after[after_vertex[id]].name : before[before_vertex[id]].name;
+        diff.total_delta += h.delta();
+        header_index[id] = diff.headers.size();
+        diff.headers.push_back(std::move(h));
+    }
+
+    std::vector<std::size_t> order(diff.headers.size());
+    for(std::size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+
+    std::stable_sort(
+        order.begin(),
+        order.end(),
+        [&diff](std::size_t a, std::size_t b)
+        {
+            return std::llabs(diff.headers[a].delta()) > std::llabs(diff.headers[b].delta());
+        }
+    );
+
+    std::vector<header_diff> sorted;
+    sorted.reserve(order.size());
+    std::vector<std::size_t> position(order.size());
+    for(std::size_t i = 0; i < order.size(); ++i)
+    {
+        position[order[i]] = i;
+        sorted.push_back(std::move(diff.headers[order[i]]));
+    }
+
+    diff.headers = std::move(sorted);
+    for(auto&& index : header_index)
+    {
+        if(index != std::size_t(-1))
+            index = position[index];
+    }
+
+    // Edges are compared as header id pairs so they match across graphs.
+    std::vector<edge_ref> added = missing_edges(
+        after, after_ids, costs_after, edge_keys(before, before_ids));
+
+    std::vector<edge_ref> removed = missing_edges(
+        before, before_ids, costs_before, edge_keys(after, after_ids));
+
+    diff.added_edges.reserve(added.size());
+    for(auto&& e : added)
+    {
+        std::size_t h = header_index[after_ids[e.to]];
+        if(h != std::size_t(-1))
+            diff.headers[h].new_includers.push_back(diff.added_edges.size());
+
+        diff.added_edges.push_back({ after[e.from].name, after[e.to].name, e.cost });
+    }
+
+    diff.removed_edges.reserve(removed.size());
+    for(auto&& e : removed)
+    {
+        diff.removed_edges.push_back({ before[e.from].name, before[e.to].name, e.cost });
+    }
+
+    return diff;
+}
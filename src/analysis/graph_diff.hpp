@@ -0,0 +1,115 @@
+// *****************************************************************************
+//
+// analysis/graph_diff.hpp
+//
+// Compares two include graphs, such as a release build against main or a
+// build before and after a change. Headers are matched by name and ranked
+// by how much their project wide cost changed, and the include edges that
+// appeared or disappeared are listed with the cost they pull in.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_ANALYSIS_GRAPHDIFF_HPP_
+#define CPPSIZE_ANALYSIS_GRAPHDIFF_HPP_
+
+#include "analysis/include_aggregate.hpp"
+#include "cpp_dep/cpp_dep.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+// Project wide cost of every vertex: transitive_size summed over every
+// translation unit for an aggregate, otherwise size + size_dependencies.
+std::vector<std::size_t> project_costs(
+    cpp_dep::include_graph_t const& g,
+    aggregate_stats_t const* stats = nullptr);
+
+// -----------------------------------------------------------------------------
+//
+struct header_diff
+{
+    enum state_t
+    {
+        changed,
+        added,
+        removed,
+    };
+
+    std::string name;
+    state_t state;
+    std::size_t cost_before;
+    std::size_t cost_after;
+
+    // Indices into graph_diff::added_edges of the new includes of this
+    // header, most expensive first.
+    std::vector<std::size_t> new_includers;
+
+    std::int64_t delta() const
+    {
+        return static_cast<std::int64_t>(cost_after) - static_cast<std::int64_t>(cost_before);
+    }
+};
+
+// -----------------------------------------------------------------------------
+//
+struct include_edge_diff
+{
+    std::string includer;
+    std::string included;
+
+    // Project wide cost of the included header on the side the edge is
+    // on.
+    std::size_t cost;
+};
+
+// -----------------------------------------------------------------------------
+//
+struct graph_diff
+{
+    // Headers whose cost changed, including headers only one side has,
+    // by the size of the change, largest first.
+    std::vector<header_diff> headers;
+
+    // Includes only in the after graph, most expensive first.
+    std::vector<include_edge_diff> added_edges;
+
+    // Includes only in the before graph, most expensive first.
+    std::vector<include_edge_diff> removed_edges;
+
+    // Sum of the change over every header.
+    std::int64_t total_delta;
+};
+
+// -----------------------------------------------------------------------------
+//
+// One side of a diff.
+struct diff_input
+{
+    diff_input()
+        : graph(nullptr)
+    {}
+
+    cpp_dep::include_graph_t const* graph;
+
+    // Indexed by vertex, see project_costs().
+    std::vector<std::size_t> costs;
+
+    // The logs the graph was read from. Each log is the root of its
+    // includes and is named after its file, which is rarely the same on
+    // both sides, so log roots all match each other instead.
+    std::vector<std::string> logs;
+};
+
+// Headers are matched by name, which the parser has already normalised, so
+// the same header logged with different separators or case is one header
+// as long as both sides were read with the same path_normaliser.
+graph_diff diff_graphs(diff_input const& before, diff_input const& after);
+
+#endif // CPPSIZE_ANALYSIS_GRAPHDIFF_HPP_
@@ -0,0 +1,247 @@
+// *****************************************************************************
+//
+// analysis/include_aggregate.cpp
+//
+// Merges the include graphs of many translation units.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "analysis/include_aggregate.hpp"
+#include <boost/filesystem.hpp>
+#include <boost/range/iterator_range.hpp>
+#include "analysis/pch_recommender.hpp"
+#include "parse/graph_snapshot.hpp"
+#include "util/parallel_for.hpp"
+#include <algorithm>
+#include <atomic>
+
+// -----------------------------------------------------------------------------
+//
+include_aggregate::include_aggregate()
+    : num_translation_units_(0)
+    , stats_current_(true)
+{}
+
+// -----------------------------------------------------------------------------
+//
+void include_aggregate::add(cpp_dep::include_graph_t const& g)
+{
+    // The merged graph only keeps the largest size_dependencies, so what
+    // each translation unit pulled in is summed while it's still known.
+    std::vector<std::size_t> counts = translation_unit_counts(g);
+    std::vector<cpp_dep::include_vertex_descriptor_t> remap(boost::num_vertices(g));
+    for(auto v : boost::make_iterator_range(boost::vertices(g)))
+    {
+        remap[v] = find_or_add_vertex(g[v]);
+        add_transitive_size(remap[v], (g[v].size + g[v].size_dependencies) * counts[v], counts[v]);
+    }
+
+    for(auto v : boost::make_iterator_range(boost::vertices(g)))
+    {
+        for(auto u : boost::make_iterator_range(boost::adjacent_vertices(v, g)))
+        {
+            add_edge(remap[v], remap[u]);
+        }
+    }
+
+    stats_current_ = false;
+}
+
+// -----------------------------------------------------------------------------
+//
+void include_aggregate::merge(include_aggregate const& other)
+{
+    cpp_dep::include_graph_t const& g = other.graph_;
+    std::vector<cpp_dep::include_vertex_descriptor_t> remap(boost::num_vertices(g));
+    for(auto v : boost::make_iterator_range(boost::vertices(g)))
+    {
+        remap[v] = find_or_add_vertex(g[v]);
+        add_transitive_size(remap[v], other.transitive_totals_[v], other.transitive_occurrences_[v]);
+    }
+
+    for(auto v : boost::make_iterator_range(boost::vertices(g)))
+    {
+        for(auto u : boost::make_iterator_range(boost::adjacent_vertices(v, g)))
+        {
+            add_edge(remap[v], remap[u]);
+        }
+    }
+
+    stats_current_ = false;
+    errors_.insert(errors_.end(), other.errors_.begin(), other.errors_.end());
+}
+
+// -----------------------------------------------------------------------------
+//
+aggregate_stats_t const& include_aggregate::stats() const
+{
+    update_stats();
+    return stats_;
+}
+
+// -----------------------------------------------------------------------------
+//
+std::size_t include_aggregate::num_translation_units() const
+{
+    update_stats();
+    return num_translation_units_;
+}
+
+// -----------------------------------------------------------------------------
+//
+void include_aggregate::update_stats() const
+{
+    if(stats_current_)
+        return;
+
+    // Include guards mean each header is parsed once per translation
+    // unit no matter how many times it's included.
+    std::vector<std::size_t> counts = translation_unit_counts(graph_);
+    stats_.assign(boost::num_vertices(graph_), aggregate_header_stats());
+    num_translation_units_ = 0;
+    for(auto v : boost::make_iterator_range(boost::vertices(graph_)))
+    {
+        cpp_dep::include_vertex_t const& file = graph_[v];
+        aggregate_header_stats& s = stats_[v];
+        s.num_translation_units = counts[v];
+        s.bytes_parsed = file.size * counts[v];
+
+        // The same translation unit read from two logs is only counted
+        // once, so its logs are averaged rather than added.
+        std::size_t total = transitive_totals_[v];
+        std::size_t occurrences = transitive_occurrences_[v];
+        if(occurrences == counts[v])
+            s.transitive_size = total;
+        else if(occurrences != 0)
+            s.transitive_size = static_cast<std::size_t>(
+                static_cast<double>(total) / static_cast<double>(occurrences) * static_cast<double>(counts[v]));
+
+        if(boost::in_degree(v, graph_) == 0 && boost::out_degree(v, graph_) != 0)
+            ++num_translation_units_;
+    }
+
+    stats_current_ = true;
+}
+
+// -----------------------------------------------------------------------------
+//
+cpp_dep::include_vertex_descriptor_t include_aggregate::find_or_add_vertex(
+    cpp_dep::include_vertex_t const& file)
+{
+    auto i = vertex_by_name_.find(file.name);
+    if(i == vertex_by_name_.end())
+    {
+        cpp_dep::include_vertex_descriptor_t v = boost::add_vertex(file, graph_);
+        vertex_by_name_.emplace(file.name, v);
+        transitive_totals_.push_back(0);
+        transitive_occurrences_.push_back(0);
+        return v;
+    }
+
+    cpp_dep::include_vertex_t& merged = graph_[i->second];
+    merged.size = std::max(merged.size, file.size);
+    merged.size_dependencies = std::max(merged.size_dependencies, file.size_dependencies);
+    return i->second;
+}
+
+// -----------------------------------------------------------------------------
+//
+void include_aggregate::add_edge(
+    cpp_dep::include_vertex_descriptor_t from,
+    cpp_dep::include_vertex_descriptor_t to)
+{
+    std::uint64_t key = (std::uint64_t(from) << 32) | std::uint64_t(to);
+    if(edges_.insert(key).second)
+    {
+        boost::add_edge(from, to, graph_);
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+void include_aggregate::add_transitive_size(
+    cpp_dep::include_vertex_descriptor_t v,
+    std::size_t total,
+    std::size_t occurrences)
+{
+    transitive_totals_[v] += total;
+    transitive_occurrences_[v] += occurrences;
+}
+
+// -----------------------------------------------------------------------------
+//
+std::vector<std::string> expand_log_paths(std::vector<std::string> const& paths)
+{
+    namespace fs = boost::filesystem;
+
+    std::vector<std::string> files;
+    for(auto&& path : paths)
+    {
+        if(!fs::is_directory(path))
+        {
+            files.push_back(path);
+            continue;
+        }
+
+        std::vector<std::string> dir_files;
+        for(auto&& entry : boost::make_iterator_range(fs::recursive_directory_iterator(path), {}))
+        {
+            if(fs::is_regular_file(entry.status()) && !is_snapshot_filename(entry.path().string()))
+                dir_files.push_back(entry.path().string());
+        }
+
+        std::sort(dir_files.begin(), dir_files.end());
+        files.insert(files.end(), dir_files.begin(), dir_files.end());
+    }
+
+    return files;
+}
+
+// -----------------------------------------------------------------------------
+//
+include_aggregate aggregate_deps_files(
+    std::vector<std::string> const& files,
+    unsigned num_threads,
+    task_monitor* monitor,
+    path_normaliser const& normaliser)
+{
+    num_threads = resolve_thread_count(num_threads, files.size());
+
+    // Each thread folds whole logs into its own partial aggregate so
+    // nothing is shared until the partials are merged.
+    std::vector<include_aggregate> partials(num_threads);
+    std::atomic<std::size_t> files_done(0);
+    parallel_for(
+        files.size(),
+        num_threads,
+        [&files, &partials, &files_done, &normaliser, monitor](unsigned thread, std::size_t i)
+        {
+            check_cancelled(monitor);
+            try
+            {
+                partials[thread].add(load_include_log(files[i], false, 1, nullptr, normaliser)->includes);
+            }
+            catch(std::exception& e)
+            {
+                partials[thread].add_error(files[i] + ": " + e.what());
+            }
+
+            report_progress(
+                monitor, "Parsing",
+                static_cast<int>((++files_done * 100) / files.size()));
+        }
+    );
+
+    include_aggregate result = std::move(partials[0]);
+    for(unsigned t = 1; t < num_threads; ++t)
+    {
+        result.merge(partials[t]);
+    }
+
+    return result;
+}
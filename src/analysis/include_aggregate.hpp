@@ -0,0 +1,139 @@
+// *****************************************************************************
+//
+// analysis/include_aggregate.hpp
+//
+// Merges the include graphs of many translation units into one graph where
+// each header is a single vertex, and accumulates its project wide cost.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_ANALYSIS_INCLUDEAGGREGATE_HPP_
+#define CPPSIZE_ANALYSIS_INCLUDEAGGREGATE_HPP_
+
+#include "cpp_dep/cpp_dep.hpp"
+#include "parse/path_normaliser.hpp"
+#include "util/task_monitor.hpp"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+struct aggregate_header_stats
+{
+    aggregate_header_stats()
+        : num_translation_units(0)
+        , bytes_parsed(0)
+        , transitive_size(0)
+    {}
+
+    // Number of translation units that include the header at least once,
+    // counted as the roots of the merged graph that reach it.
+    std::size_t num_translation_units;
+
+    // The header's own size, once per including translation unit.
+    std::size_t bytes_parsed;
+
+    // size + size_dependencies as the log it was read from saw it, once
+    // per including translation unit. A translation unit that turns up in
+    // several logs is counted once, at the mean of what they saw.
+    std::size_t transitive_size;
+};
+
+// Indexed by vertex of the aggregated graph.
+typedef std::vector<aggregate_header_stats> aggregate_stats_t;
+
+// -----------------------------------------------------------------------------
+//
+class include_aggregate
+{
+public:
+
+    include_aggregate();
+
+    // Folds one translation unit's include graph into the aggregate.
+    void add(cpp_dep::include_graph_t const& g);
+
+    // Folds another partial aggregate into this one.
+    void merge(include_aggregate const& other);
+
+    // The merged graph. Vertices are unified by name and size_dependencies
+    // holds the largest value seen in any one translation unit.
+    cpp_dep::include_graph_t const& graph() const
+    {
+        return graph_;
+    }
+
+    // Worked out from the merged graph the first time they're asked for
+    // after a change, since a log can hold any number of translation
+    // units and the same one can turn up in several logs.
+    aggregate_stats_t const& stats() const;
+
+    // Roots of the merged graph that include something. A log that names
+    // its sources is itself a root with nothing under it, so isn't counted.
+    std::size_t num_translation_units() const;
+
+    void add_error(std::string error)
+    {
+        errors_.push_back(std::move(error));
+    }
+
+    std::vector<std::string> const& errors() const
+    {
+        return errors_;
+    }
+
+private:
+
+    void update_stats() const;
+
+    cpp_dep::include_vertex_descriptor_t find_or_add_vertex(
+        cpp_dep::include_vertex_t const& file);
+
+    void add_edge(
+        cpp_dep::include_vertex_descriptor_t from,
+        cpp_dep::include_vertex_descriptor_t to);
+
+    void add_transitive_size(
+        cpp_dep::include_vertex_descriptor_t v,
+        std::size_t total,
+        std::size_t occurrences);
+
+    cpp_dep::include_graph_t graph_;
+    std::unordered_map<std::string, cpp_dep::include_vertex_descriptor_t> vertex_by_name_;
+    std::unordered_set<std::uint64_t> edges_;
+
+    // Per vertex, size + size_dependencies summed over every translation
+    // unit of every graph added, and how many were summed.
+    std::vector<std::size_t> transitive_totals_;
+    std::vector<std::size_t> transitive_occurrences_;
+    mutable aggregate_stats_t stats_;
+    mutable std::size_t num_translation_units_;
+    mutable bool stats_current_;
+    std::vector<std::string> errors_;
+};
+
+// -----------------------------------------------------------------------------
+//
+// Expands any directories in paths to the regular files they contain,
+// recursively, in a stable order. Snapshots written next to logs are
+// skipped.
+std::vector<std::string> expand_log_paths(std::vector<std::string> const& paths);
+
+// Loads every log with load_include_log across num_threads worker threads
+// (0 picks the hardware concurrency) and merges the per thread partial
+// aggregates. Logs that fail to parse are recorded in errors().
+include_aggregate aggregate_deps_files(
+    std::vector<std::string> const& files,
+    unsigned num_threads = 0,
+    task_monitor* monitor = nullptr,
+    path_normaliser const& normaliser = path_normaliser());
+
+#endif // CPPSIZE_ANALYSIS_INCLUDEAGGREGATE_HPP_
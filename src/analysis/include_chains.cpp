@@ -0,0 +1,271 @@
+// *****************************************************************************
+//
+// analysis/include_chains.cpp
+//
+// Answers "why is this header included?".
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "analysis/include_chains.hpp"
+#include <boost/range/iterator_range.hpp>
+#include <algorithm>
+#include <queue>
+#include <utility>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+typedef cpp_dep::include_vertex_descriptor_t vertex_t;
+
+std::uint32_t const kUnreachable = ~std::uint32_t(0);
+std::size_t const kNoParent = ~std::size_t(0);
+
+// A partial chain, from the header asked about back towards a translation
+// unit. Partial chains share their tails through parent.
+struct chain_step
+{
+    vertex_t vertex;
+    std::size_t parent;
+    std::uint32_t length;
+    std::size_t bytes;
+};
+
+struct queued_step
+{
+    // Length of the shortest chain this step can end up in.
+    std::uint32_t estimate;
+    std::size_t bytes;
+    std::size_t step;
+
+    bool operator<(queued_step const& other) const
+    {
+        if(estimate != other.estimate)
+            return estimate > other.estimate;
+        if(bytes != other.bytes)
+            return bytes < other.bytes;
+        return step > other.step;
+    }
+};
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+//
+include_chain_index::include_chain_index(cpp_dep::include_graph_t const& g)
+{
+    std::size_t num_vertices = boost::num_vertices(g);
+
+    // Both directions are bucketed by vertex, with the same include
+    // written twice listed once.
+    includer_offsets_.assign(num_vertices + 1, 0);
+    include_offsets_.assign(num_vertices + 1, 0);
+    std::vector<std::pair<vertex_t, vertex_t>> edges;
+    edges.reserve(boost::num_edges(g));
+    for(auto v : boost::make_iterator_range(boost::vertices(g)))
+    {
+        for(auto child : boost::make_iterator_range(boost::adjacent_vertices(v, g)))
+            edges.emplace_back(v, child);
+    }
+
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    for(auto&& e : edges)
+    {
+        ++include_offsets_[e.first + 1];
+        ++includer_offsets_[e.second + 1];
+    }
+
+    for(std::size_t v = 0; v < num_vertices; ++v)
+    {
+        include_offsets_[v + 1] += include_offsets_[v];
+        includer_offsets_[v + 1] += includer_offsets_[v];
+    }
+
+    includes_.resize(edges.size());
+    includers_.resize(edges.size());
+    std::vector<std::size_t> fill(includer_offsets_.begin(), includer_offsets_.end() - 1);
+    for(std::size_t i = 0; i < edges.size(); ++i)
+    {
+        includes_[i] = edges[i].second;
+        includers_[fill[edges[i].second]++] = edges[i].first;
+    }
+
+    // Breadth first from every translation unit at once.
+    sizes_.resize(num_vertices);
+    std::vector<vertex_t> roots;
+    for(auto v : boost::make_iterator_range(boost::vertices(g)))
+    {
+        sizes_[v] = g[v].size;
+        if(includer_offsets_[v] == includer_offsets_[v + 1])
+            roots.push_back(v);
+    }
+
+    breadth_first(depth_, std::move(roots));
+}
+
+// -----------------------------------------------------------------------------
+//
+include_chain include_chain_index::shortest_chain(
+    cpp_dep::include_vertex_descriptor_t v,
+    cpp_dep::include_vertex_descriptor_t root) const
+{
+    std::vector<depth_t> from_root;
+    std::vector<depth_t> const& depth = depths(root, from_root);
+    if(depth[v] == kUnreachable)
+        return include_chain();
+
+    // Any includer one closer to the root is on a shortest chain, and
+    // there's always one.
+    std::vector<vertex_t> files(1, v);
+    while(depth[v] != 0)
+    {
+        for(std::size_t i = includer_offsets_[v]; i < includer_offsets_[v + 1]; ++i)
+        {
+            if(depth[includers_[i]] + 1 == depth[v])
+            {
+                v = includers_[i];
+                break;
+            }
+        }
+
+        files.push_back(v);
+    }
+
+    std::reverse(files.begin(), files.end());
+    return make_chain(std::move(files));
+}
+
+// -----------------------------------------------------------------------------
+//
+std::vector<include_chain> include_chain_index::chains(
+    cpp_dep::include_vertex_descriptor_t v,
+    std::size_t max_chains,
+    cpp_dep::include_vertex_descriptor_t root,
+    std::size_t max_candidates,
+    std::size_t max_expansions) const
+{
+    std::vector<include_chain> result;
+    std::vector<depth_t> from_root;
+    std::vector<depth_t> const& depth = depths(root, from_root);
+    if(max_chains == 0 || depth[v] == kUnreachable)
+        return result;
+
+    // Best first back from v. A step's distance from the root is exact,
+    // so chains come out shortest first and the candidates ranked are
+    // the shortest ones.
+    max_candidates = std::max(max_candidates, max_chains);
+    std::vector<chain_step> steps;
+    std::priority_queue<queued_step> queue;
+    steps.push_back({ v, kNoParent, 0, sizes_[v] });
+    queue.push({ depth[v], sizes_[v], 0 });
+
+    std::size_t expansions = 0;
+    while(!queue.empty() && result.size() < max_candidates && expansions < max_expansions)
+    {
+        std::size_t s = queue.top().step;
+        queue.pop();
+        ++expansions;
+
+        chain_step const current = steps[s];
+        if(depth[current.vertex] == 0)
+        {
+            std::vector<vertex_t> files;
+            for(std::size_t i = s; i != kNoParent; i = steps[i].parent)
+                files.push_back(steps[i].vertex);
+
+            result.push_back(make_chain(std::move(files)));
+            continue;
+        }
+
+        for(std::size_t i = includer_offsets_[current.vertex]; i < includer_offsets_[current.vertex + 1]; ++i)
+        {
+            vertex_t includer = includers_[i];
+            if(depth[includer] == kUnreachable)
+                continue;
+
+            // Chains don't go round a cycle.
+            bool repeated = false;
+            for(std::size_t j = s; j != kNoParent && !repeated; j = steps[j].parent)
+                repeated = steps[j].vertex == includer;
+
+            if(repeated)
+                continue;
+
+            chain_step next = { includer, s, current.length + 1, current.bytes + sizes_[includer] };
+            steps.push_back(next);
+            queue.push({ next.length + depth[includer], next.bytes, steps.size() - 1 });
+        }
+    }
+
+    std::stable_sort(
+        result.begin(),
+        result.end(),
+        [](include_chain const& a, include_chain const& b)
+        {
+            if(a.bytes != b.bytes)
+                return a.bytes > b.bytes;
+            return a.files.size() < b.files.size();
+        }
+    );
+
+    if(result.size() > max_chains)
+        result.resize(max_chains);
+
+    return result;
+}
+
+// -----------------------------------------------------------------------------
+//
+std::vector<include_chain_index::depth_t> const& include_chain_index::depths(
+    cpp_dep::include_vertex_descriptor_t root,
+    std::vector<depth_t>& from_root) const
+{
+    if(root == kAnyTranslationUnit)
+        return depth_;
+
+    breadth_first(from_root, std::vector<vertex_t>(1, root));
+    return from_root;
+}
+
+// -----------------------------------------------------------------------------
+//
+void include_chain_index::breadth_first(
+    std::vector<depth_t>& depth,
+    std::vector<cpp_dep::include_vertex_descriptor_t> queue) const
+{
+    depth.assign(sizes_.size(), kUnreachable);
+    for(vertex_t v : queue)
+        depth[v] = 0;
+
+    for(std::size_t i = 0; i < queue.size(); ++i)
+    {
+        vertex_t v = queue[i];
+        for(std::size_t c = include_offsets_[v]; c < include_offsets_[v + 1]; ++c)
+        {
+            vertex_t child = includes_[c];
+            if(depth[child] == kUnreachable)
+            {
+                depth[child] = depth[v] + 1;
+                queue.push_back(child);
+            }
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+include_chain include_chain_index::make_chain(std::vector<cpp_dep::include_vertex_descriptor_t> files) const
+{
+    include_chain chain;
+    chain.files = std::move(files);
+    for(vertex_t v : chain.files)
+        chain.bytes += sizes_[v];
+
+    return chain;
+}
@@ -0,0 +1,104 @@
+// *****************************************************************************
+//
+// analysis/include_chains.hpp
+//
+// Answers "why is this header included?" with the chains of includes that
+// lead to it from a translation unit, either the single shortest chain or
+// a bounded set of chains ranked by size. The includers of every vertex and
+// each vertex's distance from the nearest translation unit are worked out
+// once, so a query only walks the chains it returns. A query can also be
+// limited to the chains from one translation unit, which costs a breadth
+// first walk from it.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_ANALYSIS_INCLUDECHAINS_HPP_
+#define CPPSIZE_ANALYSIS_INCLUDECHAINS_HPP_
+
+#include "cpp_dep/cpp_dep.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+struct include_chain
+{
+    include_chain()
+        : bytes(0)
+    {}
+
+    // The translation unit first and the header asked about last.
+    std::vector<cpp_dep::include_vertex_descriptor_t> files;
+
+    // Own size of every file on the chain.
+    std::size_t bytes;
+};
+
+// Passed as the root of a query to accept chains from any translation unit.
+cpp_dep::include_vertex_descriptor_t const kAnyTranslationUnit =
+    ~cpp_dep::include_vertex_descriptor_t(0);
+
+// -----------------------------------------------------------------------------
+//
+class include_chain_index
+{
+public:
+
+    explicit include_chain_index(cpp_dep::include_graph_t const& g);
+
+    // A chain from root with the fewest includes, or an empty one if root
+    // doesn't include v. With kAnyTranslationUnit, v may also be out of
+    // reach of every translation unit, such as a header only included from
+    // a cycle.
+    include_chain shortest_chain(
+        cpp_dep::include_vertex_descriptor_t v,
+        cpp_dep::include_vertex_descriptor_t root = kAnyTranslationUnit) const;
+
+    // Up to max_chains distinct chains from root without repeated files,
+    // the most bytes first and the shorter of two the same size first.
+    // Chains are found shortest first and only the first max_candidates
+    // are ranked, and at most max_expansions partial chains are looked at,
+    // so a header reached in millions of ways still answers quickly.
+    std::vector<include_chain> chains(
+        cpp_dep::include_vertex_descriptor_t v,
+        std::size_t max_chains,
+        cpp_dep::include_vertex_descriptor_t root = kAnyTranslationUnit,
+        std::size_t max_candidates = 1000,
+        std::size_t max_expansions = 100000) const;
+
+private:
+
+    typedef std::uint32_t depth_t;
+
+    include_chain make_chain(std::vector<cpp_dep::include_vertex_descriptor_t> files) const;
+
+    // Fewest includes from root to each vertex. For kAnyTranslationUnit
+    // that's depth_, otherwise it's worked out into from_root.
+    std::vector<depth_t> const& depths(
+        cpp_dep::include_vertex_descriptor_t root,
+        std::vector<depth_t>& from_root) const;
+
+    void breadth_first(
+        std::vector<depth_t>& depth,
+        std::vector<cpp_dep::include_vertex_descriptor_t> queue) const;
+
+    // Includers of vertex v are includers_[includer_offsets_[v]] up to
+    // includers_[includer_offsets_[v + 1]], each listed once, and the same
+    // for the files v includes.
+    std::vector<std::size_t> includer_offsets_;
+    std::vector<cpp_dep::include_vertex_descriptor_t> includers_;
+    std::vector<std::size_t> include_offsets_;
+    std::vector<cpp_dep::include_vertex_descriptor_t> includes_;
+
+    // Fewest includes from any translation unit.
+    std::vector<depth_t> depth_;
+    std::vector<std::size_t> sizes_;
+};
+
+#endif // CPPSIZE_ANALYSIS_INCLUDECHAINS_HPP_
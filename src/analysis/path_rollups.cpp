@@ -0,0 +1,153 @@
+// *****************************************************************************
+//
+// analysis/path_rollups.cpp
+//
+// Totals for every directory of the path graph.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "analysis/path_rollups.hpp"
+#include "analysis/top_offenders.hpp"
+#include <boost/range/iterator_range.hpp>
+#include <boost/utility/string_ref.hpp>
+#include <boost/functional/hash.hpp>
+#include <string>
+#include <unordered_map>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+struct string_ref_hash
+{
+    std::size_t operator()(boost::string_ref s) const
+    {
+        return boost::hash_range(s.begin(), s.end());
+    }
+};
+
+// True if name is parent or a path under it, by whole segments.
+bool is_under(std::string const& name, std::string const& parent)
+{
+    if(parent.empty() || name.compare(0, parent.size(), parent) != 0)
+        return false;
+
+    return name.size() == parent.size() ||
+           parent.back() == '/' ||
+           name[parent.size()] == '/';
+}
+
+std::string child_path(std::string const& parent, std::string const& name)
+{
+    if(parent.empty() || is_under(name, parent))
+        return name;
+
+    if(parent.back() == '/')
+        return parent + name;
+
+    return parent + '/' + name;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+//
+path_rollups_t rollup_paths(
+    cpp_dep::include_graph_t const& paths,
+    cpp_dep::include_graph_t const& includes)
+{
+    typedef cpp_dep::include_vertex_descriptor_t vertex_t;
+
+    std::size_t num_vertices = boost::num_vertices(paths);
+    vertex_t const no_parent = static_cast<vertex_t>(num_vertices);
+
+    // Parents before children. The path graph is a forest, but a vertex
+    // reached twice is only taken the first time so its files aren't
+    // counted twice by the root.
+    std::vector<vertex_t> order;
+    std::vector<vertex_t> parent(num_vertices, no_parent);
+    std::vector<char> seen(num_vertices, 0);
+    order.reserve(num_vertices);
+    {
+        std::vector<vertex_t> stack;
+        for(auto root : boost::make_iterator_range(boost::vertices(paths)))
+        {
+            if(boost::in_degree(root, paths) != 0)
+                continue;
+
+            seen[root] = 1;
+            stack.push_back(root);
+            while(!stack.empty())
+            {
+                vertex_t v = stack.back();
+                stack.pop_back();
+                order.push_back(v);
+                for(auto child : boost::make_iterator_range(boost::adjacent_vertices(v, paths)))
+                {
+                    if(seen[child])
+                        continue;
+
+                    seen[child] = 1;
+                    parent[child] = v;
+                    stack.push_back(child);
+                }
+            }
+        }
+    }
+
+    // Names are borrowed from the include graph, which outlives the map.
+    std::unordered_map<
+        boost::string_ref,
+        vertex_t,
+        string_ref_hash
+    > includes_by_name;
+
+    includes_by_name.reserve(boost::num_vertices(includes));
+    for(auto v : boost::make_iterator_range(boost::vertices(includes)))
+    {
+        includes_by_name.emplace(includes[v].name, v);
+    }
+
+    std::vector<int> counts = include_counts(includes);
+
+    path_rollups_t rollups(num_vertices);
+    std::vector<std::string> full_paths(num_vertices);
+    for(vertex_t v : order)
+    {
+        std::string const& name = paths[v].name;
+        full_paths[v] = parent[v] == no_parent ? name : child_path(full_paths[parent[v]], name);
+        if(boost::out_degree(v, paths) != 0)
+            continue;
+
+        path_rollup& file = rollups[v];
+        file.num_headers = 1;
+        auto i = includes_by_name.find(full_paths[v]);
+        if(i == includes_by_name.end())
+        {
+            file.total_bytes = paths[v].size;
+            continue;
+        }
+
+        file.total_bytes = includes[i->second].size;
+        file.inclusions = static_cast<std::size_t>(counts[i->second]);
+    }
+
+    for(auto i = order.rbegin(); i != order.rend(); ++i)
+    {
+        if(parent[*i] == no_parent)
+            continue;
+
+        path_rollup const& child = rollups[*i];
+        path_rollup& rollup = rollups[parent[*i]];
+        rollup.total_bytes += child.total_bytes;
+        rollup.num_headers += child.num_headers;
+        rollup.inclusions += child.inclusions;
+    }
+
+    return rollups;
+}
@@ -0,0 +1,56 @@
+// *****************************************************************************
+//
+// analysis/path_rollups.hpp
+//
+// Totals for every directory of the path graph, so a directory row can say
+// how much everything under it costs without expanding it. Computed once,
+// bottom-up, after the include graph is inverted to paths.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_ANALYSIS_PATHROLLUPS_HPP_
+#define CPPSIZE_ANALYSIS_PATHROLLUPS_HPP_
+
+#include "cpp_dep/cpp_dep.hpp"
+#include <cstddef>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+struct path_rollup
+{
+    path_rollup()
+        : total_bytes(0)
+        , num_headers(0)
+        , inclusions(0)
+    {}
+
+    // Own size of every file under the path, each counted once.
+    std::size_t total_bytes;
+
+    // Files under the path, or 1 for a file.
+    std::size_t num_headers;
+
+    // Times the files under the path are included, see
+    // inferred_include_visitor::get_include_count.
+    std::size_t inclusions;
+};
+
+// Indexed by vertex of the path graph.
+typedef std::vector<path_rollup> path_rollups_t;
+
+// paths is invert_to_paths(includes). Files, the vertices of paths without
+// children, are matched with includes by name for their size and include
+// count. A file's name is its path graph name if that already starts with
+// its parent's path, otherwise the two joined with '/', so paths named
+// either by component or in full are matched.
+path_rollups_t rollup_paths(
+    cpp_dep::include_graph_t const& paths,
+    cpp_dep::include_graph_t const& includes);
+
+#endif // CPPSIZE_ANALYSIS_PATHROLLUPS_HPP_
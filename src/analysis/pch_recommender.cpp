@@ -0,0 +1,313 @@
+// *****************************************************************************
+//
+// analysis/pch_recommender.cpp
+//
+// Picks the headers worth putting in a precompiled header.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "analysis/pch_recommender.hpp"
+#include "util/parallel_for.hpp"
+#include <boost/range/iterator_range.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <queue>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+typedef cpp_dep::include_vertex_descriptor_t vertex_t;
+
+// Walks everything a vertex includes, stopping at vertices marked in skip.
+// Visited vertices are stamped rather than cleared, so a walk costs what it
+// visits and not the size of the graph.
+class closure_walker
+{
+public:
+
+    explicit closure_walker(std::size_t num_vertices)
+        : visited_(num_vertices, 0)
+        , stamp_(0)
+    {}
+
+    template<typename Visit>
+    void operator()(
+        cpp_dep::include_graph_t const& g,
+        vertex_t from,
+        std::vector<char> const& skip,
+        Visit visit)
+    {
+        if(skip[from])
+            return;
+
+        if(++stamp_ == 0)
+        {
+            std::fill(visited_.begin(), visited_.end(), 0);
+            stamp_ = 1;
+        }
+
+        visited_[from] = stamp_;
+        stack_.push_back(from);
+        while(!stack_.empty())
+        {
+            vertex_t v = stack_.back();
+            stack_.pop_back();
+            visit(v);
+            for(auto child : boost::make_iterator_range(boost::adjacent_vertices(v, g)))
+            {
+                if(skip[child] || visited_[child] == stamp_)
+                    continue;
+
+                visited_[child] = stamp_;
+                stack_.push_back(child);
+            }
+        }
+    }
+
+private:
+
+    std::vector<std::uint32_t> visited_;
+    std::vector<vertex_t> stack_;
+    std::uint32_t stamp_;
+};
+
+// What adding a header to the pch would add and save.
+struct gain
+{
+    gain()
+        : cost(0)
+        , value(0)
+    {}
+
+    std::size_t cost;
+    std::size_t value;
+
+    double ratio() const
+    {
+        if(cost == 0)
+            return value ? std::numeric_limits<double>::max() : 0;
+
+        return static_cast<double>(value) / static_cast<double>(cost);
+    }
+};
+
+gain measure_gain(
+    closure_walker& walk,
+    cpp_dep::include_graph_t const& g,
+    vertex_t v,
+    std::vector<char> const& in_pch,
+    std::vector<std::size_t> const& translation_units)
+{
+    gain result;
+    walk(g, v, in_pch,
+        [&](vertex_t file)
+        {
+            result.cost += g[file].size;
+            result.value += g[file].size * translation_units[file];
+        }
+    );
+
+    return result;
+}
+
+struct candidate
+{
+    vertex_t vertex;
+    gain measured;
+
+    // Headers picked when measured was taken. Once more have been picked
+    // it may count some of theirs and has to be measured again.
+    std::size_t picks;
+
+    // For the priority queue, so the best ratio is on top and ties go to
+    // the lower vertex.
+    bool operator<(candidate const& other) const
+    {
+        double a = measured.ratio();
+        double b = other.measured.ratio();
+        if(a != b)
+            return a < b;
+
+        return vertex > other.vertex;
+    }
+};
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+//
+std::vector<std::size_t> translation_unit_counts(cpp_dep::include_graph_t const& g)
+{
+    std::size_t num_vertices = boost::num_vertices(g);
+    std::vector<vertex_t> roots;
+    for(auto v : boost::make_iterator_range(boost::vertices(g)))
+    {
+        if(boost::in_degree(v, g) == 0)
+            roots.push_back(v);
+    }
+
+    // Each thread counts into its own vector and walks with its own
+    // stamps, then the counts are summed.
+    unsigned num_threads = resolve_thread_count(0, roots.size());
+    std::vector<std::vector<std::size_t>> partial(num_threads);
+    std::vector<closure_walker> walkers(num_threads, closure_walker(num_vertices));
+    std::vector<char> const nothing_skipped(num_vertices, 0);
+    parallel_for(
+        roots.size(),
+        num_threads,
+        [&](unsigned thread, std::size_t i)
+        {
+            std::vector<std::size_t>& counts = partial[thread];
+            if(counts.empty())
+                counts.resize(num_vertices, 0);
+
+            walkers[thread](g, roots[i], nothing_skipped,
+                [&counts](vertex_t v)
+                {
+                    ++counts[v];
+                }
+            );
+        }
+    );
+
+    std::vector<std::size_t> counts(num_vertices, 0);
+    for(auto&& p : partial)
+    {
+        for(std::size_t v = 0; v < p.size(); ++v)
+            counts[v] += p[v];
+    }
+
+    return counts;
+}
+
+// -----------------------------------------------------------------------------
+//
+pch_recommendation recommend_pch(
+    cpp_dep::include_graph_t const& g,
+    std::vector<std::size_t> const& translation_units,
+    pch_options const& options,
+    task_monitor* monitor)
+{
+    std::size_t num_vertices = boost::num_vertices(g);
+    pch_recommendation result;
+
+    std::size_t num_roots = 0;
+    for(auto v : boost::make_iterator_range(boost::vertices(g)))
+    {
+        result.bytes_parsed += g[v].size * translation_units[v];
+        if(boost::in_degree(v, g) == 0)
+            ++num_roots;
+    }
+
+    std::size_t min_translation_units = std::max<std::size_t>(
+        1, std::min(options.min_translation_units, num_roots));
+
+    std::vector<vertex_t> eligible;
+    for(auto v : boost::make_iterator_range(boost::vertices(g)))
+    {
+        // Translation units aren't included by anything, so can't be
+        // precompiled.
+        if(boost::in_degree(v, g) != 0 && translation_units[v] >= min_translation_units)
+            eligible.push_back(v);
+    }
+
+    // Every candidate is measured once up front, across threads, and after
+    // that only when it reaches the top of the queue with a stale measure.
+    std::vector<char> in_pch(num_vertices, 0);
+    std::vector<candidate> measured(eligible.size());
+    unsigned num_threads = resolve_thread_count(options.num_threads, eligible.size());
+    std::vector<closure_walker> walkers(num_threads, closure_walker(num_vertices));
+    parallel_for(
+        eligible.size(),
+        num_threads,
+        [&](unsigned thread, std::size_t i)
+        {
+            check_cancelled(monitor);
+            candidate& c = measured[i];
+            c.vertex = eligible[i];
+            c.measured = measure_gain(walkers[thread], g, c.vertex, in_pch, translation_units);
+            c.picks = 0;
+        }
+    );
+
+    // The ratio can favour a lot of small headers over one big one that
+    // would save more, so the best single header that fits is the
+    // fallback.
+    candidate const* best_single = nullptr;
+    std::priority_queue<candidate> queue;
+    for(auto&& c : measured)
+    {
+        if(c.measured.cost > options.budget || c.measured.value == 0)
+            continue;
+
+        queue.push(c);
+        if(!best_single || c.measured.value > best_single->measured.value)
+            best_single = &c;
+    }
+
+    // Every pass walks some of the graph, so it's checked often.
+    closure_walker& walk = walkers.front();
+    cancellation_poll poll(monitor, 16);
+    while(!queue.empty())
+    {
+        poll();
+
+        candidate c = queue.top();
+        queue.pop();
+
+        if(in_pch[c.vertex])
+            continue;
+
+        if(c.picks != result.headers.size())
+        {
+            // Dropped once it doesn't fit what's left of the budget, even
+            // though later picks could still shrink what it would add.
+            c.measured = measure_gain(walk, g, c.vertex, in_pch, translation_units);
+            c.picks = result.headers.size();
+            if(c.measured.value != 0 && result.pch_bytes + c.measured.cost <= options.budget)
+                queue.push(c);
+
+            continue;
+        }
+
+        if(result.pch_bytes + c.measured.cost > options.budget)
+            continue;
+
+        walk(g, c.vertex, in_pch,
+            [&in_pch](vertex_t v)
+            {
+                in_pch[v] = 1;
+            }
+        );
+
+        pch_header picked;
+        picked.vertex = c.vertex;
+        picked.added_bytes = c.measured.cost;
+        picked.saved_bytes = c.measured.value;
+        picked.num_translation_units = translation_units[c.vertex];
+        result.headers.push_back(picked);
+        result.pch_bytes += c.measured.cost;
+        result.bytes_saved += c.measured.value;
+    }
+
+    if(best_single && best_single->measured.value > result.bytes_saved)
+    {
+        pch_header picked;
+        picked.vertex = best_single->vertex;
+        picked.added_bytes = best_single->measured.cost;
+        picked.saved_bytes = best_single->measured.value;
+        picked.num_translation_units = translation_units[best_single->vertex];
+        result.headers.assign(1, picked);
+        result.pch_bytes = picked.added_bytes;
+        result.bytes_saved = picked.saved_bytes;
+    }
+
+    return result;
+}
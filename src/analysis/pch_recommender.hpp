@@ -0,0 +1,97 @@
+// *****************************************************************************
+//
+// analysis/pch_recommender.hpp
+//
+// Picks the headers worth putting in a precompiled header. A header in the
+// pch takes everything it includes with it, and every translation unit
+// that would have parsed any of that no longer does, so the pick is scored
+// by the bytes not reparsed, size times translation units, for each header
+// the pch ends up holding, counting headers shared by several picks once.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_ANALYSIS_PCHRECOMMENDER_HPP_
+#define CPPSIZE_ANALYSIS_PCHRECOMMENDER_HPP_
+
+#include "cpp_dep/cpp_dep.hpp"
+#include "util/task_monitor.hpp"
+#include <cstddef>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+struct pch_options
+{
+    pch_options()
+        : budget(16 * 1024 * 1024)
+        , min_translation_units(2)
+        , num_threads(0)
+    {}
+
+    // Most bytes of header text the pch may hold.
+    std::size_t budget;
+
+    // Headers included by fewer translation units aren't picked, although
+    // they can still be pulled in by one that is. Lowered to the number of
+    // translation units if there are fewer.
+    std::size_t min_translation_units;
+
+    // 0 uses the hardware concurrency.
+    unsigned num_threads;
+};
+
+struct pch_header
+{
+    cpp_dep::include_vertex_descriptor_t vertex;
+
+    // Bytes picking the header added to the pch, its own size plus
+    // whatever it includes that wasn't already in.
+    std::size_t added_bytes;
+
+    // Bytes no longer reparsed because of what it added.
+    std::size_t saved_bytes;
+
+    std::size_t num_translation_units;
+};
+
+struct pch_recommendation
+{
+    pch_recommendation()
+        : pch_bytes(0)
+        , bytes_saved(0)
+        , bytes_parsed(0)
+    {}
+
+    // The headers to include from the pch, in the order they were picked.
+    std::vector<pch_header> headers;
+
+    // Own size of every header in the pch, within the budget.
+    std::size_t pch_bytes;
+
+    // Header bytes no longer reparsed across every translation unit.
+    std::size_t bytes_saved;
+
+    // Bytes parsed across every translation unit without a pch.
+    std::size_t bytes_parsed;
+};
+
+// Translation units, the vertices nothing includes, that reach each vertex.
+std::vector<std::size_t> translation_unit_counts(cpp_dep::include_graph_t const& g);
+
+// Picks greedily by bytes saved per byte added, taking the single best
+// header instead if that alone saves more. translation_units is indexed by
+// vertex, see translation_unit_counts() or
+// aggregate_header_stats::num_translation_units. Throws task_cancelled if
+// the monitor asks to stop.
+pch_recommendation recommend_pch(
+    cpp_dep::include_graph_t const& g,
+    std::vector<std::size_t> const& translation_units,
+    pch_options const& options = pch_options(),
+    task_monitor* monitor = nullptr);
+
+#endif // CPPSIZE_ANALYSIS_PCHRECOMMENDER_HPP_
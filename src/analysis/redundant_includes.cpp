@@ -0,0 +1,251 @@
+// *****************************************************************************
+//
+// analysis/redundant_includes.cpp
+//
+// Finds direct includes the includer already gets through another one.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "analysis/redundant_includes.hpp"
+#include "util/parallel_for.hpp"
+#include <boost/range/iterator_range.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+typedef cpp_dep::include_vertex_descriptor_t vertex_t;
+typedef std::uint64_t word_t;
+
+std::size_t const kWordBits = 64;
+
+std::uint32_t const kUnfinished = ~std::uint32_t(0);
+
+// Vertices in depth first postorder, so a vertex comes after everything it
+// includes except for includes that close a cycle. finished[v] is v's
+// position in the order.
+std::vector<vertex_t> postorder(
+    cpp_dep::include_graph_t const& g,
+    std::vector<std::uint32_t>& finished)
+{
+    typedef boost::graph_traits<cpp_dep::include_graph_t>::adjacency_iterator child_iterator;
+
+    std::size_t num_vertices = boost::num_vertices(g);
+    std::vector<vertex_t> order;
+    order.reserve(num_vertices);
+    finished.assign(num_vertices, kUnfinished);
+
+    std::vector<char> visited(num_vertices, 0);
+    std::vector<std::pair<vertex_t, child_iterator>> stack;
+    for(auto root : boost::make_iterator_range(boost::vertices(g)))
+    {
+        if(visited[root])
+            continue;
+
+        visited[root] = 1;
+        stack.emplace_back(root, boost::adjacent_vertices(root, g).first);
+        while(!stack.empty())
+        {
+            vertex_t v = stack.back().first;
+            child_iterator& next = stack.back().second;
+            if(next == boost::adjacent_vertices(v, g).second)
+            {
+                finished[v] = static_cast<std::uint32_t>(order.size());
+                order.push_back(v);
+                stack.pop_back();
+                continue;
+            }
+
+            vertex_t child = *next++;
+            if(!visited[child])
+            {
+                visited[child] = 1;
+                stack.emplace_back(child, boost::adjacent_vertices(child, g).first);
+            }
+        }
+    }
+
+    return order;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+//
+std::vector<redundant_include> find_redundant_includes(
+    cpp_dep::include_graph_t const& g,
+    std::vector<std::size_t> const& translation_units,
+    unsigned num_threads,
+    std::size_t chunk_bytes)
+{
+    std::size_t num_vertices = boost::num_vertices(g);
+    std::vector<std::uint32_t> finished;
+    std::vector<vertex_t> order = postorder(g, finished);
+
+    // An include that closes a cycle isn't followed, the header it names
+    // is still being included when it's seen.
+    auto follows = [&finished](vertex_t from, vertex_t to)
+    {
+        return finished[to] < finished[from];
+    };
+
+    // Only the direct includes of a file with more than one can be
+    // redundant, so only they get a bit.
+    std::vector<std::uint32_t> column(num_vertices, kUnfinished);
+    std::vector<vertex_t> targets;
+    std::vector<vertex_t> includers;
+    for(auto v : boost::make_iterator_range(boost::vertices(g)))
+    {
+        if(boost::out_degree(v, g) < 2)
+            continue;
+
+        includers.push_back(v);
+        for(auto child : boost::make_iterator_range(boost::adjacent_vertices(v, g)))
+        {
+            if(column[child] == kUnfinished)
+            {
+                column[child] = static_cast<std::uint32_t>(targets.size());
+                targets.push_back(child);
+            }
+        }
+    }
+
+    std::vector<redundant_include> result;
+    if(targets.empty())
+        return result;
+
+    // As many words per vertex as fit the budget, but no more than the
+    // targets need.
+    std::size_t words = std::max<std::size_t>(1, chunk_bytes / (num_vertices * sizeof(word_t)));
+    words = std::min(words, (targets.size() + kWordBits - 1) / kWordBits);
+    std::size_t chunk_bits = words * kWordBits;
+    std::size_t num_chunks = (targets.size() + chunk_bits - 1) / chunk_bits;
+
+    num_threads = resolve_thread_count(num_threads, num_chunks);
+    std::vector<std::vector<word_t>> reach(num_threads);
+    std::vector<std::vector<redundant_include>> found(num_threads);
+    parallel_for(
+        num_chunks,
+        num_threads,
+        [&](unsigned thread, std::size_t chunk)
+        {
+            // reach[v] holds, for the targets in this chunk, the ones v
+            // includes directly or indirectly.
+            std::vector<word_t>& rows = reach[thread];
+            rows.assign(num_vertices * words, 0);
+            std::size_t first = chunk * chunk_bits;
+            std::size_t last = std::min(targets.size(), first + chunk_bits);
+            auto in_chunk = [&](vertex_t v)
+            {
+                return column[v] != kUnfinished && column[v] >= first && column[v] < last;
+            };
+
+            for(vertex_t v : order)
+            {
+                word_t* row = &rows[v * words];
+                for(auto child : boost::make_iterator_range(boost::adjacent_vertices(v, g)))
+                {
+                    if(!follows(v, child))
+                        continue;
+
+                    word_t const* child_row = &rows[child * words];
+                    for(std::size_t i = 0; i < words; ++i)
+                        row[i] |= child_row[i];
+
+                    if(in_chunk(child))
+                    {
+                        std::size_t bit = column[child] - first;
+                        row[bit / kWordBits] |= word_t(1) << (bit % kWordBits);
+                    }
+                }
+            }
+
+            // A direct include is redundant if it's in what the includer's
+            // direct includes reach. Nothing reaches itself once cycles are
+            // cut, so that's always through another one.
+            std::vector<word_t> below(words);
+            for(vertex_t includer : includers)
+            {
+                std::fill(below.begin(), below.end(), 0);
+                for(auto child : boost::make_iterator_range(boost::adjacent_vertices(includer, g)))
+                {
+                    if(!follows(includer, child))
+                        continue;
+
+                    word_t const* child_row = &rows[child * words];
+                    for(std::size_t i = 0; i < words; ++i)
+                        below[i] |= child_row[i];
+                }
+
+                for(auto included : boost::make_iterator_range(boost::adjacent_vertices(includer, g)))
+                {
+                    if(!in_chunk(included) || !follows(includer, included))
+                        continue;
+
+                    std::size_t bit = column[included] - first;
+                    word_t mask = word_t(1) << (bit % kWordBits);
+                    if(!(below[bit / kWordBits] & mask))
+                        continue;
+
+                    redundant_include r;
+                    r.includer = includer;
+                    r.included = included;
+                    r.via = included;
+                    r.bytes = g[included].size;
+                    r.occurence = translation_units[includer];
+                    for(auto child : boost::make_iterator_range(boost::adjacent_vertices(includer, g)))
+                    {
+                        if(follows(includer, child) && (rows[child * words + bit / kWordBits] & mask))
+                        {
+                            r.via = child;
+                            break;
+                        }
+                    }
+
+                    found[thread].push_back(r);
+                }
+            }
+        }
+    );
+
+    for(auto&& f : found)
+        result.insert(result.end(), f.begin(), f.end());
+
+    std::sort(
+        result.begin(),
+        result.end(),
+        [](redundant_include const& a, redundant_include const& b)
+        {
+            std::size_t a_cost = a.bytes * a.occurence;
+            std::size_t b_cost = b.bytes * b.occurence;
+            if(a_cost != b_cost)
+                return a_cost > b_cost;
+            if(a.includer != b.includer)
+                return a.includer < b.includer;
+            return a.included < b.included;
+        }
+    );
+
+    // The same include written twice is one edge per copy.
+    result.erase(
+        std::unique(
+            result.begin(),
+            result.end(),
+            [](redundant_include const& a, redundant_include const& b)
+            {
+                return a.includer == b.includer && a.included == b.included;
+            }
+        ),
+        result.end()
+    );
+
+    return result;
+}
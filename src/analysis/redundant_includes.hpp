@@ -0,0 +1,54 @@
+// *****************************************************************************
+//
+// analysis/redundant_includes.hpp
+//
+// Finds direct includes of headers the includer already gets through
+// another of its direct includes. They cost a lookup and a lex of the
+// include guard every time and are the easiest includes to clean up.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_ANALYSIS_REDUNDANTINCLUDES_HPP_
+#define CPPSIZE_ANALYSIS_REDUNDANTINCLUDES_HPP_
+
+#include "cpp_dep/cpp_dep.hpp"
+#include <cstddef>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+struct redundant_include
+{
+    cpp_dep::include_vertex_descriptor_t includer;
+    cpp_dep::include_vertex_descriptor_t included;
+
+    // A direct include of includer that already includes included.
+    cpp_dep::include_vertex_descriptor_t via;
+
+    // The included header's own size.
+    std::size_t bytes;
+
+    // Translation units that reach the includer and so see the include.
+    std::size_t occurence;
+};
+
+// Every redundant edge of g, most bytes times occurence first.
+// translation_units is indexed by vertex, see translation_unit_counts().
+//
+// Reachability is a bitset per vertex built in topological order, but only
+// for a chunk of the possible targets at a time so memory stays at about
+// chunk_bytes per thread whatever the size of the graph. Includes that
+// close a cycle are left out of the reachability, so a header is never
+// reported as redundant because it includes its includer.
+std::vector<redundant_include> find_redundant_includes(
+    cpp_dep::include_graph_t const& g,
+    std::vector<std::size_t> const& translation_units,
+    unsigned num_threads = 0,
+    std::size_t chunk_bytes = 32 * 1024 * 1024);
+
+#endif // CPPSIZE_ANALYSIS_REDUNDANTINCLUDES_HPP_
@@ -0,0 +1,152 @@
+// *****************************************************************************
+//
+// analysis/size_changes.cpp
+//
+// Compares a reloaded include graph with the previous version of it.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "analysis/size_changes.hpp"
+#include <boost/range/iterator_range.hpp>
+#include <boost/utility/string_ref.hpp>
+#include <boost/functional/hash.hpp>
+#include <algorithm>
+#include <unordered_map>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+struct string_ref_hash
+{
+    std::size_t operator()(boost::string_ref s) const
+    {
+        return boost::hash_range(s.begin(), s.end());
+    }
+};
+
+std::size_t total_size(cpp_dep::include_vertex_t const& file)
+{
+    return file.size + file.size_dependencies;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+//
+std::size_t size_changes::num_changed() const
+{
+    return removed.size() + std::count_if(
+        vertices.begin(),
+        vertices.end(),
+        [](size_change const& c)
+        {
+            return c.state != size_change::unchanged;
+        }
+    );
+}
+
+// -----------------------------------------------------------------------------
+//
+size_changes compare_sizes(
+    cpp_dep::include_graph_t const& previous,
+    cpp_dep::include_graph_t const& current)
+{
+    // Names are borrowed from the previous graph, which outlives the map.
+    std::unordered_map<
+        boost::string_ref,
+        cpp_dep::include_vertex_descriptor_t,
+        string_ref_hash
+    > previous_by_name;
+
+    previous_by_name.reserve(boost::num_vertices(previous));
+    for(auto v : boost::make_iterator_range(boost::vertices(previous)))
+    {
+        previous_by_name.emplace(previous[v].name, v);
+    }
+
+    size_changes result;
+    result.vertices.resize(boost::num_vertices(current));
+    std::vector<char> matched(boost::num_vertices(previous), 0);
+    for(auto v : boost::make_iterator_range(boost::vertices(current)))
+    {
+        size_change& change = result.vertices[v];
+        std::size_t size = total_size(current[v]);
+
+        auto i = previous_by_name.find(current[v].name);
+        if(i == previous_by_name.end())
+        {
+            change.state = size_change::added;
+            change.delta = static_cast<std::int64_t>(size);
+            continue;
+        }
+
+        matched[i->second] = 1;
+        change.delta =
+            static_cast<std::int64_t>(size) -
+            static_cast<std::int64_t>(total_size(previous[i->second]));
+
+        if(change.delta > 0)
+            change.state = size_change::grown;
+        else if(change.delta < 0)
+            change.state = size_change::shrunk;
+    }
+
+    for(auto v : boost::make_iterator_range(boost::vertices(previous)))
+    {
+        if(!matched[v])
+            result.removed.push_back({ previous[v].name, total_size(previous[v]) });
+    }
+
+    std::sort(
+        result.removed.begin(),
+        result.removed.end(),
+        [](removed_header const& a, removed_header const& b)
+        {
+            return a.size > b.size;
+        }
+    );
+
+    return result;
+}
+
+// -----------------------------------------------------------------------------
+//
+bool same_graph(
+    cpp_dep::include_graph_t const& previous,
+    cpp_dep::include_graph_t const& current)
+{
+    if(boost::num_vertices(previous) != boost::num_vertices(current) ||
+       boost::num_edges(previous) != boost::num_edges(current))
+    {
+        return false;
+    }
+
+    for(auto v : boost::make_iterator_range(boost::vertices(current)))
+    {
+        cpp_dep::include_vertex_t const& a = previous[v];
+        cpp_dep::include_vertex_t const& b = current[v];
+        if(a.size != b.size ||
+           a.size_dependencies != b.size_dependencies ||
+           a.name != b.name ||
+           boost::out_degree(v, previous) != boost::out_degree(v, current))
+        {
+            return false;
+        }
+
+        auto previous_includes = boost::adjacent_vertices(v, previous);
+        if(!std::equal(
+            previous_includes.first, previous_includes.second,
+            boost::adjacent_vertices(v, current).first))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
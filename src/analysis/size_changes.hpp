@@ -0,0 +1,82 @@
+// *****************************************************************************
+//
+// analysis/size_changes.hpp
+//
+// Compares a reloaded include graph with the previous version of the same
+// graph, so the views can show which headers grew, shrank, appeared or
+// disappeared between two runs of a build.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_ANALYSIS_SIZECHANGES_HPP_
+#define CPPSIZE_ANALYSIS_SIZECHANGES_HPP_
+
+#include "cpp_dep/cpp_dep.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+struct size_change
+{
+    enum state_t
+    {
+        unchanged,
+        grown,
+        shrunk,
+        added,
+    };
+
+    size_change()
+        : state(unchanged)
+        , delta(0)
+    {}
+
+    state_t state;
+
+    // Change in size + size_dependencies, in bytes. For an added header
+    // this is its whole size.
+    std::int64_t delta;
+};
+
+// -----------------------------------------------------------------------------
+//
+struct removed_header
+{
+    std::string name;
+
+    // size + size_dependencies in the previous graph.
+    std::size_t size;
+};
+
+struct size_changes
+{
+    // Indexed by vertex of the current graph.
+    std::vector<size_change> vertices;
+
+    // Headers in the previous graph that aren't in the current one,
+    // largest first.
+    std::vector<removed_header> removed;
+
+    std::size_t num_changed() const;
+};
+
+// Matches vertices by name.
+size_changes compare_sizes(
+    cpp_dep::include_graph_t const& previous,
+    cpp_dep::include_graph_t const& current);
+
+// True if current has the same vertices as previous, in the same order
+// with the same names and sizes, and the same includes in the same order.
+// Anything worked out from previous then holds for current too.
+bool same_graph(
+    cpp_dep::include_graph_t const& previous,
+    cpp_dep::include_graph_t const& current);
+
+#endif // CPPSIZE_ANALYSIS_SIZECHANGES_HPP_
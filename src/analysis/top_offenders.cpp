@@ -0,0 +1,107 @@
+// *****************************************************************************
+//
+// analysis/top_offenders.cpp
+//
+// Ranks the headers that cost the most.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "analysis/top_offenders.hpp"
+#include "cpp_dep/inferred_include_visitor.hpp"
+#include <stdexcept>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+class include_counter
+    : private cpp_dep::inferred_include_visitor<include_counter>
+{
+public:
+
+    std::vector<int> operator()(cpp_dep::include_graph_t const& g)
+    {
+        this->visit(g);
+
+        std::vector<int> counts(boost::num_vertices(g));
+        for(auto v : boost::make_iterator_range(boost::vertices(g)))
+            counts[v] = this->get_include_count(v);
+
+        return counts;
+    }
+
+private:
+
+    friend class cpp_dep::inferred_include_visitor<include_counter>;
+
+    void root_file(cpp_dep::include_vertex_descriptor_t const&, cpp_dep::include_graph_t const&)
+    {}
+
+    void include_file(cpp_dep::include_vertex_descriptor_t const&, cpp_dep::include_graph_t const&)
+    {}
+
+    void finish_file(cpp_dep::include_vertex_descriptor_t const&, cpp_dep::include_graph_t const&)
+    {}
+};
+
+template<typename T>
+int compare(T a, T b)
+{
+    return a < b ? -1 : b < a ? 1 : 0;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+//
+offender_rank parse_offender_rank(std::string const& name)
+{
+    if(name == "contribution")
+        return offender_rank::contribution;
+    if(name == "occurence")
+        return offender_rank::occurence;
+    if(name == "exclusive")
+        return offender_rank::exclusive;
+
+    throw std::runtime_error(
+        "Unknown ranking \"" + name + "\", expected contribution, occurence or exclusive");
+}
+
+// -----------------------------------------------------------------------------
+//
+bool ranks_before(offender const& a, offender const& b, offender_rank rank)
+{
+    int order = 0;
+    switch(rank)
+    {
+    case offender_rank::contribution:
+        break;
+    case offender_rank::occurence:
+        order = compare(a.occurence, b.occurence);
+        break;
+    case offender_rank::exclusive:
+        order = compare(a.exclusive, b.exclusive);
+        break;
+    }
+
+    if(order == 0)
+        order = compare(a.contribution, b.contribution);
+
+    if(order != 0)
+        return order > 0;
+
+    return a.vertex < b.vertex;
+}
+
+// -----------------------------------------------------------------------------
+//
+std::vector<int> include_counts(cpp_dep::include_graph_t const& g)
+{
+    include_counter count;
+    return count(g);
+}
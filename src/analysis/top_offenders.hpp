@@ -0,0 +1,89 @@
+// *****************************************************************************
+//
+// analysis/top_offenders.hpp
+//
+// Ranks the headers that cost the most: by the bytes they pull in, by how
+// often they're included or by what removing them would save. The ranking
+// is one parallel pass over the vertices keeping the best n, so it's cheap
+// enough to redo whenever what's being ranked changes.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_ANALYSIS_TOPOFFENDERS_HPP_
+#define CPPSIZE_ANALYSIS_TOPOFFENDERS_HPP_
+
+#include "cpp_dep/cpp_dep.hpp"
+#include "util/parallel_top_n.hpp"
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+struct offender
+{
+    cpp_dep::include_vertex_descriptor_t vertex;
+
+    // Bytes the header pulls in, size + size_dependencies, or its
+    // transitive_size over every translation unit for an aggregate.
+    std::size_t contribution;
+
+    // Times it's included, see inferred_include_visitor::get_include_count.
+    int occurence;
+
+    // Bytes that go away if it's removed, see exclusive_sizes().
+    std::size_t exclusive;
+};
+
+enum class offender_rank
+{
+    contribution,
+    occurence,
+    exclusive,
+};
+
+// Parses contribution, occurence or exclusive. Throws std::runtime_error
+// for anything else.
+offender_rank parse_offender_rank(std::string const& name);
+
+// True if a ranks ahead of b. Ties go to the larger contribution and then
+// the lower vertex, so the order is stable.
+bool ranks_before(offender const& a, offender const& b, offender_rank rank);
+
+// -----------------------------------------------------------------------------
+//
+// The top n of num_vertices vertices. measure(v, o) fills in o's figures
+// for v and returns false to leave v out, and is called from several
+// threads at once.
+template<typename Measure>
+std::vector<offender> top_offenders(
+    std::size_t num_vertices,
+    std::size_t n,
+    offender_rank rank,
+    Measure measure,
+    unsigned num_threads = 0)
+{
+    return parallel_top_n<offender>(
+        num_vertices,
+        n,
+        num_threads,
+        [&measure](std::size_t v, offender& o)
+        {
+            o.vertex = static_cast<cpp_dep::include_vertex_descriptor_t>(v);
+            return measure(o.vertex, o);
+        },
+        [rank](offender const& a, offender const& b)
+        {
+            return ranks_before(a, b, rank);
+        }
+    );
+}
+
+// Times each vertex is included, by vertex.
+std::vector<int> include_counts(cpp_dep::include_graph_t const& g);
+
+#endif // CPPSIZE_ANALYSIS_TOPOFFENDERS_HPP_
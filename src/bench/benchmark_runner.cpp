@@ -0,0 +1,117 @@
+// *****************************************************************************
+//
+// bench/benchmark_runner.cpp
+//
+// Minimal benchmark harness.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "bench/benchmark_runner.hpp"
+#include "report/report_format.hpp"
+#include <algorithm>
+#include <ctime>
+#include <numeric>
+#include <ostream>
+#include <thread>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+struct result_summary
+{
+    double min;
+    double median;
+    double mean;
+    double max;
+};
+
+result_summary summarise(std::vector<double> seconds)
+{
+    result_summary summary = {};
+    if(seconds.empty())
+        return summary;
+
+    std::sort(seconds.begin(), seconds.end());
+    summary.min = seconds.front();
+    summary.max = seconds.back();
+    summary.mean = std::accumulate(seconds.begin(), seconds.end(), 0.0) / seconds.size();
+
+    std::size_t mid = seconds.size() / 2;
+    summary.median = seconds.size() % 2
+        ? seconds[mid]
+        : (seconds[mid - 1] + seconds[mid]) / 2;
+
+    return summary;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+//
+benchmark_runner::benchmark_runner(int repetitions, std::string filter, std::ostream& log)
+    : repetitions_(std::max(1, repetitions))
+    , filter_(std::move(filter))
+    , log_(log)
+{}
+
+// -----------------------------------------------------------------------------
+//
+bool benchmark_runner::enabled(std::string const& name) const
+{
+    return name.find(filter_) != std::string::npos;
+}
+
+// -----------------------------------------------------------------------------
+//
+void benchmark_runner::add_result(benchmark_result result)
+{
+    result_summary summary = summarise(result.seconds);
+    log_ << result.name << "  median " << summary.median * 1000 << "ms"
+         << "  min " << summary.min * 1000 << "ms"
+         << "  items " << result.items << '\n';
+
+    results_.push_back(std::move(result));
+}
+
+// -----------------------------------------------------------------------------
+//
+void benchmark_runner::write_json(std::ostream& out) const
+{
+    std::time_t now = std::time(nullptr);
+    char date[32] = {};
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    out << "{\"context\":{\"date\":";
+    write_json_string(out, date);
+    out << ",\"hardware_concurrency\":" << std::thread::hardware_concurrency()
+        << ",\"repetitions\":" << repetitions_
+        << "},\n\"benchmarks\":[";
+
+    bool first = true;
+    for(auto&& result : results_)
+    {
+        if(!first)
+            out << ',';
+        first = false;
+
+        result_summary summary = summarise(result.seconds);
+        out << "\n{\"name\":";
+        write_json_string(out, result.name);
+        out << ",\"items\":" << result.items
+            << ",\"min_seconds\":" << summary.min
+            << ",\"median_seconds\":" << summary.median
+            << ",\"mean_seconds\":" << summary.mean
+            << ",\"max_seconds\":" << summary.max
+            << ",\"items_per_second\":"
+            << (summary.median > 0 ? result.items / summary.median : 0)
+            << '}';
+    }
+
+    out << "\n]}\n";
+}
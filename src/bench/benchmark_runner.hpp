@@ -0,0 +1,89 @@
+// *****************************************************************************
+//
+// bench/benchmark_runner.hpp
+//
+// Minimal benchmark harness. Each benchmark is timed over a number of
+// repetitions and the results are written as JSON so runs from different
+// releases can be compared.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_BENCH_BENCHMARKRUNNER_HPP_
+#define CPPSIZE_BENCH_BENCHMARKRUNNER_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+struct benchmark_result
+{
+    std::string name;
+
+    // Lines, vertices or nodes processed by one repetition, so results
+    // can be compared as a rate across inputs of different sizes.
+    std::size_t items;
+
+    // Wall time of each repetition.
+    std::vector<double> seconds;
+};
+
+// -----------------------------------------------------------------------------
+//
+class benchmark_runner
+{
+public:
+
+    // Only benchmarks whose name contains filter are run.
+    benchmark_runner(int repetitions, std::string filter, std::ostream& log);
+
+    bool enabled(std::string const& name) const;
+
+    // Times f repetitions times. f returns the number of items it
+    // processed.
+    template<typename Function>
+    void run(std::string const& name, Function f)
+    {
+        if(!enabled(name))
+            return;
+
+        benchmark_result result;
+        result.name = name;
+        result.items = 0;
+        for(int r = 0; r < repetitions_; ++r)
+        {
+            auto start = std::chrono::steady_clock::now();
+            result.items = f();
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            result.seconds.push_back(elapsed.count());
+        }
+
+        add_result(std::move(result));
+    }
+
+    std::vector<benchmark_result> const& results() const
+    {
+        return results_;
+    }
+
+    void write_json(std::ostream& out) const;
+
+private:
+
+    void add_result(benchmark_result result);
+
+    int repetitions_;
+    std::string filter_;
+    std::ostream& log_;
+    std::vector<benchmark_result> results_;
+};
+
+#endif // CPPSIZE_BENCH_BENCHMARKRUNNER_HPP_
@@ -0,0 +1,131 @@
+// *****************************************************************************
+//
+// bench/synthetic_log.cpp
+//
+// Generates include logs of any size for benchmarking.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "bench/synthetic_log.hpp"
+#include <algorithm>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+// Headers are spread over a few libraries and directories so that the
+// path tree and substring filters see realistic shared prefixes.
+std::string header_name(std::size_t i, bool msvc)
+{
+    std::string name = msvc ? "C:\\synthetic\\lib" : "/synthetic/lib";
+    char const separator = msvc ? '\\' : '/';
+
+    name += std::to_string(i % 16);
+    name += separator;
+    name += "detail";
+    name += std::to_string((i / 16) % 32);
+    name += separator;
+    name += "header";
+    name += std::to_string(i);
+    name += ".hpp";
+    return name;
+}
+
+class log_writer
+{
+public:
+
+    log_writer(std::ostream& out, synthetic_log_options const& options)
+        : out_(out)
+        , options_(options)
+        , random_(options.seed)
+        , children_(options.num_headers)
+        , reached_(options.num_headers, 0)
+        , num_lines_(0)
+    {
+        // Children always have a higher index so the headers form a DAG.
+        // Most includes are near neighbours, like a library including
+        // its own details, with the odd jump across the whole project.
+        for(std::size_t h = 0; h + 1 < options_.num_headers; ++h)
+        {
+            std::size_t remaining = options_.num_headers - h - 1;
+            std::uniform_int_distribution<std::size_t> near(1, std::min<std::size_t>(remaining, 64));
+            std::uniform_int_distribution<std::size_t> far(1, remaining);
+            for(int c = 0; c < options_.width; ++c)
+            {
+                std::size_t offset = (random_() % 8) == 0 ? far(random_) : near(random_);
+                children_[h].push_back(h + offset);
+            }
+        }
+    }
+
+    std::size_t write()
+    {
+        std::uniform_int_distribution<std::size_t> any_header(0, options_.num_headers - 1);
+        for(std::size_t s = 0; s < options_.num_sources; ++s)
+        {
+            // Each translation unit starts with a clean include guard set.
+            std::fill(reached_.begin(), reached_.end(), 0);
+
+            out_ << "source" << s << ".cpp\n";
+            ++num_lines_;
+
+            if(options_.num_headers == 0)
+                continue;
+
+            for(int i = 0; i < options_.width; ++i)
+            {
+                include(any_header(random_), 1);
+            }
+        }
+
+        return num_lines_;
+    }
+
+private:
+
+    void include(std::size_t header, int depth)
+    {
+        if(depth > options_.depth || reached_[header])
+            return;
+
+        reached_[header] = 1;
+        if(options_.msvc)
+            out_ << "Note: including file:" << std::string(depth, ' ');
+        else
+            out_ << std::string(depth, '.') << ' ';
+
+        out_ << header_name(header, options_.msvc) << '\n';
+        ++num_lines_;
+
+        for(std::size_t child : children_[header])
+        {
+            include(child, depth + 1);
+        }
+    }
+
+    std::ostream& out_;
+    synthetic_log_options const& options_;
+    std::mt19937 random_;
+    std::vector<std::vector<std::size_t>> children_;
+    std::vector<char> reached_;
+    std::size_t num_lines_;
+};
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+//
+std::size_t write_synthetic_log(std::ostream& out, synthetic_log_options const& options)
+{
+    return log_writer(out, options).write();
+}
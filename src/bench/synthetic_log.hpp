@@ -0,0 +1,57 @@
+// *****************************************************************************
+//
+// bench/synthetic_log.hpp
+//
+// Generates include logs of any size for benchmarking. Headers form a
+// random DAG so every header includes the same children in every
+// translation unit, and each translation unit only lists a header the
+// first time it's reached, the way include guards make a compiler do.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_BENCH_SYNTHETICLOG_HPP_
+#define CPPSIZE_BENCH_SYNTHETICLOG_HPP_
+
+#include <cstddef>
+#include <iosfwd>
+
+// -----------------------------------------------------------------------------
+//
+struct synthetic_log_options
+{
+    synthetic_log_options()
+        : num_sources(200)
+        , num_headers(4000)
+        , depth(12)
+        , width(6)
+        , seed(1)
+        , msvc(false)
+    {}
+
+    // Translation units in the log.
+    std::size_t num_sources;
+
+    // Distinct headers the translation units draw from.
+    std::size_t num_headers;
+
+    // Deepest include nesting written.
+    int depth;
+
+    // Includes per file.
+    int width;
+
+    unsigned seed;
+
+    // Write /showIncludes lines instead of -H lines.
+    bool msvc;
+};
+
+// Writes a log to out and returns the number of lines written.
+std::size_t write_synthetic_log(std::ostream& out, synthetic_log_options const& options);
+
+#endif // CPPSIZE_BENCH_SYNTHETICLOG_HPP_
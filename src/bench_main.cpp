@@ -0,0 +1,338 @@
+// *****************************************************************************
+//
+// bench_main.cpp
+//
+// Benchmarks for each stage of loading a log: parsing, inverting to the
+// path graph, interning names, building the view tree and filtering it.
+// Runs over the sample logs and a synthetic log of configurable size.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+
+#include "bench/benchmark_runner.hpp"
+#include "bench/synthetic_log.hpp"
+#include "analysis/include_aggregate.hpp"
+#include "parse/include_log_parser.hpp"
+#include "ui/tree_view_builder.hpp"
+#include "util/filter_query.hpp"
+#include "util/incremental_tree_filter.hpp"
+#include "util/path_table.hpp"
+#include "util/task_monitor.hpp"
+#include "cpp_dep/cpp_dep.hpp"
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+struct bench_options
+{
+    bench_options()
+        : samples("test")
+        , repetitions(5)
+    {}
+
+    std::string samples;
+    std::string output;
+    std::string filter;
+    int repetitions;
+    synthetic_log_options synthetic;
+};
+
+// -----------------------------------------------------------------------------
+//
+void print_usage(std::ostream& out)
+{
+    out << "usage: cpp-size-bench [options]\n"
+        << "\n"
+        << "options:\n"
+        << "  --samples <dir>       sample logs to benchmark (default test)\n"
+        << "  --sources <n>         synthetic translation units, 0 to skip\n"
+        << "  --headers <n>         synthetic headers\n"
+        << "  --depth <n>           synthetic include depth\n"
+        << "  --width <n>           synthetic includes per file\n"
+        << "  --msvc                write the synthetic log as /showIncludes\n"
+        << "  --repetitions <n>     times to run each benchmark (default 5)\n"
+        << "  --filter <text>       only run benchmarks whose name contains text\n"
+        << "  --output <file>       write JSON results to file instead of stdout\n";
+}
+
+// -----------------------------------------------------------------------------
+//
+bench_options parse_options(int argc, char* argv[])
+{
+    bench_options options;
+
+    auto next_arg = [&](int& i) -> std::string
+    {
+        if(i + 1 >= argc)
+            throw std::runtime_error(std::string("Missing value for ") + argv[i]);
+        return argv[++i];
+    };
+
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if(arg == "--samples")
+            options.samples = next_arg(i);
+        else if(arg == "--sources")
+            options.synthetic.num_sources = std::stoul(next_arg(i));
+        else if(arg == "--headers")
+            options.synthetic.num_headers = std::stoul(next_arg(i));
+        else if(arg == "--depth")
+            options.synthetic.depth = std::stoi(next_arg(i));
+        else if(arg == "--width")
+            options.synthetic.width = std::stoi(next_arg(i));
+        else if(arg == "--msvc")
+            options.synthetic.msvc = true;
+        else if(arg == "--repetitions")
+            options.repetitions = std::stoi(next_arg(i));
+        else if(arg == "--filter")
+            options.filter = next_arg(i);
+        else if(arg == "--output" || arg == "-o")
+            options.output = next_arg(i);
+        else
+            throw std::runtime_error("Unknown option \"" + arg + "\"");
+    }
+
+    return options;
+}
+
+// -----------------------------------------------------------------------------
+//
+// Queries typed into the filter box, one word at a time or a character at
+// a time, as the dialog sees them.
+std::vector<std::string> typical_queries()
+{
+    return {
+        "vector",
+        "detail 1",
+        "/",
+        "zzz_no_match",
+        "-detail *.h* size>1k",
+    };
+}
+
+std::vector<std::string> const& typed_query()
+{
+    static std::vector<std::string> const typed = { "h", "he", "hea", "head", "heade", "header", "header1" };
+    return typed;
+}
+
+// -----------------------------------------------------------------------------
+//
+// Never asks to stop, so the filter benchmarks include the cost of polling
+// for cancellation the way the UI does.
+class uncancelled_monitor : public task_monitor
+{
+public:
+
+    void progress(char const*, int) override
+    {}
+
+    bool cancelled() const override
+    {
+        return false;
+    }
+};
+
+// -----------------------------------------------------------------------------
+//
+// Heap and inline bytes of the names stored on each vertex, assuming the
+// usual small string optimisation.
+std::size_t name_bytes(cpp_dep::include_graph_t const& g)
+{
+    std::size_t bytes = 0;
+    for(auto v : boost::make_iterator_range(boost::vertices(g)))
+    {
+        bytes += sizeof(std::string);
+        if(g[v].name.capacity() >= sizeof(std::string))
+            bytes += g[v].name.capacity() + 1;
+    }
+
+    return bytes;
+}
+
+// -----------------------------------------------------------------------------
+//
+void run_benchmarks(benchmark_runner& runner, std::string const& name, std::string const& log)
+{
+    std::size_t num_lines = 0;
+    {
+        std::ifstream in(log, std::ios::binary);
+        std::string line;
+        while(std::getline(in, line))
+            ++num_lines;
+    }
+
+    auto graph = std::make_shared<cpp_dep::include_graph_t>();
+    runner.run("parse/" + name, [&]
+    {
+        *graph = read_include_log(log.c_str(), 1);
+        return num_lines;
+    });
+
+    runner.run("parse_parallel/" + name, [&]
+    {
+        *graph = read_include_log(log.c_str(), 0);
+        return num_lines;
+    });
+
+    // Later stages need the graph even if parsing was filtered out.
+    if(boost::num_vertices(*graph) == 0)
+        *graph = read_include_log(log.c_str(), 0);
+
+    runner.run("invert/" + name, [&]
+    {
+        return boost::num_vertices(cpp_dep::invert_to_paths(*graph));
+    });
+
+    if(runner.enabled("intern/" + name))
+    {
+        cpp_dep::include_graph_t paths = cpp_dep::invert_to_paths(*graph);
+        path_table table;
+        runner.run("intern/" + name, [&]
+        {
+            table = path_table();
+            intern_vertex_names(table, *graph);
+            intern_vertex_names(table, paths);
+            table.finalise();
+            return boost::num_vertices(*graph) + boost::num_vertices(paths);
+        });
+
+        std::cerr
+            << name << ": names take " << name_bytes(*graph) + name_bytes(paths)
+            << " bytes as strings, " << table.bytes_used() << " bytes interned\n";
+    }
+
+    std::shared_ptr<include_tree const> full_tree;
+    runner.run("tree/" + name, [&]
+    {
+        tree_view_builder build_tree(tree_view_builder::option::checkbox);
+        full_tree = build_tree(graph);
+        return full_tree->size();
+    });
+
+    if(!full_tree)
+        full_tree = tree_view_builder(tree_view_builder::option::checkbox)(graph);
+
+    // Building the filter's index isn't part of any query, so
+    // skip it if no filter benchmark is going to run.
+    std::vector<std::pair<std::string, filter_query>> queries;
+    bool any_filter = runner.enabled("filter_typed/" + name);
+    for(auto&& query : typical_queries())
+    {
+        queries.emplace_back("filter/" + name + "/" + query, filter_query(query));
+        any_filter |= runner.enabled(queries.back().first);
+    }
+
+    if(!any_filter)
+        return;
+
+    incremental_tree_filter filter(full_tree);
+    uncancelled_monitor monitor;
+    for(auto&& query : queries)
+    {
+        runner.run(query.first, [&]
+        {
+            // Clear the cache so each run is a fresh query.
+            filter(filter_query(), &monitor);
+            return filter(query.second, &monitor)->size();
+        });
+    }
+
+    runner.run("filter_typed/" + name, [&]
+    {
+        filter(filter_query(), &monitor);
+        std::size_t nodes = 0;
+        for(auto&& text : typed_query())
+            nodes = filter(filter_query(text), &monitor)->size();
+        return nodes;
+    });
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+//
+int main(int argc, char* argv[])
+{
+    namespace fs = boost::filesystem;
+
+    bench_options options;
+    try
+    {
+        options = parse_options(argc, argv);
+    }
+    catch(std::exception& e)
+    {
+        std::cerr << "cpp-size-bench: " << e.what() << "\n\n";
+        print_usage(std::cerr);
+        return 2;
+    }
+
+    benchmark_runner runner(options.repetitions, options.filter, std::cerr);
+    fs::path synthetic_log;
+    try
+    {
+        if(fs::is_directory(options.samples))
+        {
+            for(auto&& sample : expand_log_paths({ options.samples }))
+            {
+                run_benchmarks(runner, fs::path(sample).filename().string(), sample);
+            }
+        }
+
+        if(options.synthetic.num_sources > 0)
+        {
+            synthetic_log = fs::temp_directory_path() / fs::unique_path("cpp-size-bench-%%%%-%%%%.txt");
+            std::size_t num_lines = 0;
+            {
+                std::ofstream out(synthetic_log.string(), std::ios::binary);
+                num_lines = write_synthetic_log(out, options.synthetic);
+                if(!out)
+                    throw std::runtime_error("Failed to write \"" + synthetic_log.string() + "\"");
+            }
+
+            std::cerr << "synthetic log: " << num_lines << " lines\n";
+            run_benchmarks(
+                runner,
+                "synthetic-" + std::to_string(num_lines),
+                synthetic_log.string());
+        }
+    }
+    catch(std::exception& e)
+    {
+        std::cerr << "cpp-size-bench: " << e.what() << '\n';
+        if(!synthetic_log.empty())
+            fs::remove(synthetic_log);
+        return 1;
+    }
+
+    if(!synthetic_log.empty())
+        fs::remove(synthetic_log);
+
+    std::ofstream output_file;
+    if(!options.output.empty())
+    {
+        output_file.open(options.output, std::ios::binary);
+        if(!output_file)
+        {
+            std::cerr << "cpp-size-bench: Failed to open \"" << options.output << "\"\n";
+            return 1;
+        }
+    }
+
+    runner.write_json(options.output.empty() ? std::cout : output_file);
+    return 0;
+}
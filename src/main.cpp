@@ -13,6 +13,7 @@
 // *****************************************************************************
 
 #include "ui/dialog.hpp"
+#include "report/report_command.hpp"
 #include <QApplication>
 
 #if defined(_WIN32) && defined(QT_STATIC)
@@ -21,6 +22,10 @@
 
 int main(int argc, char *argv[])
 {
+    // Headless mode never constructs the QApplication.
+    if(is_report_command(argc, argv))
+        return run_report_command(argc, argv);
+
     QApplication a(argc, argv);
     Dialog w;
     w.show();
@@ -0,0 +1,224 @@
+// *****************************************************************************
+//
+// parse/compile_commands.cpp
+//
+// Reader for compile_commands.json compilation databases.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "parse/compile_commands.hpp"
+#include "parse/json_reader.hpp"
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <stdexcept>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+compile_command read_entry(json_reader& json)
+{
+    compile_command entry;
+    std::string command;
+    for(json_reader::token t = json.next(); t != json_reader::end_object; t = json.next())
+    {
+        std::string key = json.text();
+        json_reader::token value = json.next();
+        if(key == "directory" && value == json_reader::string)
+            entry.directory = json.text();
+        else if(key == "file" && value == json_reader::string)
+            entry.file = json.text();
+        else if(key == "command" && value == json_reader::string)
+            command = json.text();
+        else if(key == "arguments" && value == json_reader::begin_array)
+        {
+            for(t = json.next(); t != json_reader::end_array; t = json.next())
+            {
+                if(t != json_reader::string)
+                    throw std::runtime_error("Non string in compile command arguments");
+
+                entry.arguments.push_back(json.text());
+            }
+        }
+        else
+            json.skip_value(value);
+    }
+
+    if(entry.arguments.empty())
+        entry.arguments = split_command_line(command);
+
+    if(entry.file.empty() || entry.arguments.empty())
+        throw std::runtime_error("Compile command without a file or command");
+
+    return entry;
+}
+
+// -----------------------------------------------------------------------------
+//
+// Options whose value is a separate argument and names an output.
+bool is_output_option(std::string const& arg, bool msvc)
+{
+    if(msvc)
+        return false;
+
+    return arg == "-o" || arg == "-MF" || arg == "-MT" || arg == "-MQ";
+}
+
+// Options to drop outright.
+bool is_dropped_option(std::string const& arg, bool msvc)
+{
+    if(msvc)
+    {
+        if(arg.size() < 2 || (arg[0] != '/' && arg[0] != '-'))
+            return false;
+
+        std::string option = arg.substr(1);
+        return option == "c"
+            || boost::algorithm::starts_with(option, "Fo")
+            || boost::algorithm::starts_with(option, "Fd")
+            || boost::algorithm::starts_with(option, "Fp")
+            || option == "showIncludes";
+    }
+
+    return arg == "-c"
+        || arg == "-MD"
+        || arg == "-MMD"
+        || arg == "-H"
+        || (boost::algorithm::starts_with(arg, "-o") && arg.size() > 2);
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+//
+std::vector<compile_command> read_compile_commands(std::istream& in)
+{
+    json_reader json(in);
+    if(json.next() != json_reader::begin_array)
+        throw std::runtime_error("Compilation database is not an array");
+
+    std::vector<compile_command> commands;
+    for(json_reader::token t = json.next(); t != json_reader::end_array; t = json.next())
+    {
+        if(t != json_reader::begin_object)
+            throw std::runtime_error("Compilation database entry is not an object");
+
+        commands.push_back(read_entry(json));
+    }
+
+    return commands;
+}
+
+// -----------------------------------------------------------------------------
+//
+std::vector<compile_command> read_compile_commands(std::string const& filename)
+{
+    std::ifstream in(filename, std::ios::binary);
+    if(!in)
+        throw std::runtime_error("Failed to open \"" + filename + "\"");
+
+    return read_compile_commands(in);
+}
+
+// -----------------------------------------------------------------------------
+//
+bool is_compile_commands_filename(std::string const& filename)
+{
+    return boost::filesystem::path(filename).filename() == "compile_commands.json";
+}
+
+// -----------------------------------------------------------------------------
+//
+std::vector<std::string> split_command_line(std::string const& command)
+{
+    // Same rules as the compilation database spec: the host shell's,
+    // except that on Windows only a backslash before a quote escapes,
+    // so paths keep theirs.
+    std::vector<std::string> args;
+    std::string arg;
+    bool in_arg = false;
+    char quote = 0;
+    for(std::size_t i = 0; i < command.size(); ++i)
+    {
+        char c = command[i];
+        if(quote == 0 && (c == ' ' || c == '\t' || c == '\n' || c == '\r'))
+        {
+            if(in_arg)
+                args.push_back(arg);
+            arg.clear();
+            in_arg = false;
+            continue;
+        }
+
+        in_arg = true;
+#if defined(_WIN32)
+        bool escapes = c == '\\' && i + 1 < command.size() && command[i + 1] == '"';
+#else
+        bool escapes = c == '\\' && quote != '\'' && i + 1 < command.size();
+#endif
+        if(escapes)
+            arg += command[++i];
+        else if(quote == 0 && (c == '"' || c == '\''))
+            quote = c;
+        else if(c == quote)
+            quote = 0;
+        else
+            arg += c;
+    }
+
+    if(in_arg)
+        args.push_back(arg);
+
+    return args;
+}
+
+// -----------------------------------------------------------------------------
+//
+bool is_msvc_compiler(std::string const& compiler)
+{
+    std::string name = boost::filesystem::path(compiler).stem().string();
+    return boost::algorithm::iequals(name, "cl")
+        || boost::algorithm::iequals(name, "clang-cl");
+}
+
+// -----------------------------------------------------------------------------
+//
+std::vector<std::string> make_include_listing_command(compile_command const& command)
+{
+    bool msvc = is_msvc_compiler(command.arguments.front());
+
+    std::vector<std::string> args;
+    args.push_back(command.arguments.front());
+    for(std::size_t i = 1; i < command.arguments.size(); ++i)
+    {
+        std::string const& arg = command.arguments[i];
+        if(is_output_option(arg, msvc))
+        {
+            ++i;
+            continue;
+        }
+
+        if(!is_dropped_option(arg, msvc))
+            args.push_back(arg);
+    }
+
+    // /E rather than /P so nothing is written next to the source.
+    if(msvc)
+    {
+        args.push_back("/E");
+        args.push_back("/showIncludes");
+    }
+    else
+    {
+        args.push_back("-E");
+        args.push_back("-H");
+    }
+
+    return args;
+}
@@ -0,0 +1,53 @@
+// *****************************************************************************
+//
+// parse/compile_commands.hpp
+//
+// Reader for compile_commands.json compilation databases, and the rewrite
+// of each entry's command into one that only preprocesses and lists the
+// headers it includes.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_PARSE_COMPILECOMMANDS_HPP_
+#define CPPSIZE_PARSE_COMPILECOMMANDS_HPP_
+
+#include <istream>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+struct compile_command
+{
+    std::string directory;
+    std::string file;
+    std::vector<std::string> arguments;
+};
+
+// Reads every entry. Entries that only have a "command" string are split
+// with the host platform's quoting rules. Throws std::runtime_error if the
+// database is malformed.
+std::vector<compile_command> read_compile_commands(std::istream& in);
+std::vector<compile_command> read_compile_commands(std::string const& filename);
+
+// True if filename is a compilation database.
+bool is_compile_commands_filename(std::string const& filename);
+
+// Splits a command line into arguments.
+std::vector<std::string> split_command_line(std::string const& command);
+
+// True if the compiler takes msvc style options.
+bool is_msvc_compiler(std::string const& compiler);
+
+// Rewrites command to only preprocess, listing includes with -H or
+// /showIncludes, and drops anything that would write output files.
+// Include lines are written to stderr and the preprocessed source to
+// stdout for both styles.
+std::vector<std::string> make_include_listing_command(compile_command const& command);
+
+#endif // CPPSIZE_PARSE_COMPILECOMMANDS_HPP_
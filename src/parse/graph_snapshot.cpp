@@ -0,0 +1,550 @@
+// *****************************************************************************
+//
+// parse/graph_snapshot.cpp
+//
+// Compact binary snapshot of the graphs built from an include log.
+//
+// Layout, with every section padded to 8 bytes:
+//
+//   header
+//   name offsets      uint64[num_names + 1]
+//   name bytes        char[name_offsets[num_names]]
+//   per graph:
+//     graph header
+//     names           uint32[num_vertices]
+//     sizes           uint64[num_vertices]
+//     dependencies    uint64[num_vertices]
+//     edge offsets    uint64[num_vertices + 1]
+//     edge targets    uint32[num_edges]
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "parse/graph_snapshot.hpp"
+#include "parse/include_log_parser.hpp"
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_WIN32)
+  #include <fcntl.h>
+  #include <io.h>
+#endif
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+char const kSnapshotExtension[] = ".cppsize";
+char const kTempExtension[] = ".tmp";
+char const kMagic[8] = {'c', 'p', 'p', 's', 'i', 'z', 'e', '\0'};
+std::uint32_t const kVersion = 2;
+
+// Root of a log read from stdin, which has no file name to use.
+char const kStdinRootName[] = "<stdin>";
+
+// Blocks hashed at each end of the log. Enough to catch a rebuild that
+// happens to produce a log of the same size within the mtime resolution.
+std::size_t const kHashBlockSize = 64 * 1024;
+
+struct snapshot_header
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t num_graphs;
+    std::uint64_t log_size;
+    std::int64_t log_mtime;
+    std::uint64_t log_hash;
+    std::uint64_t normaliser;
+    std::uint64_t num_names;
+};
+
+struct graph_header
+{
+    std::uint64_t num_vertices;
+    std::uint64_t num_edges;
+};
+
+// -----------------------------------------------------------------------------
+//
+std::uint64_t fnv1a(std::uint64_t hash, char const* first, std::size_t size)
+{
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        hash ^= static_cast<unsigned char>(first[i]);
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+// -----------------------------------------------------------------------------
+//
+class snapshot_writer
+{
+public:
+
+    explicit snapshot_writer(std::ostream& out)
+        : out_(out)
+        , offset_(0)
+    {}
+
+    template<typename T>
+    void write(T const* data, std::size_t count)
+    {
+        std::size_t bytes = sizeof(T) * count;
+        out_.write(reinterpret_cast<char const*>(data), bytes);
+        offset_ += bytes;
+
+        // Pad so everything that follows is aligned once mapped.
+        static char const zeros[8] = {};
+        std::size_t pad = (8 - offset_ % 8) % 8;
+        out_.write(zeros, pad);
+        offset_ += pad;
+    }
+
+    template<typename T>
+    void write(std::vector<T> const& data)
+    {
+        write(data.data(), data.size());
+    }
+
+private:
+
+    std::ostream& out_;
+    std::size_t offset_;
+};
+
+// -----------------------------------------------------------------------------
+//
+class snapshot_reader
+{
+public:
+
+    snapshot_reader(char const* first, char const* last)
+        : pos_(first)
+        , last_(last)
+    {}
+
+    // Returns the next count Ts, or null if the snapshot is too short.
+    template<typename T>
+    T const* read(std::uint64_t count)
+    {
+        std::uint64_t available = static_cast<std::uint64_t>(last_ - pos_);
+        if(count > available / sizeof(T))
+            return nullptr;
+
+        T const* data = reinterpret_cast<T const*>(pos_);
+        std::size_t bytes = static_cast<std::size_t>(sizeof(T) * count);
+        bytes += (8 - bytes % 8) % 8;
+        pos_ += std::min<std::size_t>(bytes, last_ - pos_);
+        return data;
+    }
+
+private:
+
+    char const* pos_;
+    char const* last_;
+};
+
+// -----------------------------------------------------------------------------
+//
+class name_table
+{
+public:
+
+    std::uint32_t intern(std::string const& name)
+    {
+        auto result = ids_.insert(std::make_pair(name, static_cast<std::uint32_t>(ids_.size())));
+        if(result.second)
+        {
+            bytes_.insert(bytes_.end(), name.begin(), name.end());
+            offsets_.push_back(bytes_.size());
+        }
+
+        return result.first->second;
+    }
+
+    std::vector<std::uint64_t> const& offsets() const
+    {
+        return offsets_;
+    }
+
+    std::vector<char> const& bytes() const
+    {
+        return bytes_;
+    }
+
+private:
+
+    std::unordered_map<std::string, std::uint32_t> ids_;
+    std::vector<std::uint64_t> offsets_ = std::vector<std::uint64_t>(1, 0);
+    std::vector<char> bytes_;
+};
+
+// -----------------------------------------------------------------------------
+//
+struct flat_graph
+{
+    std::vector<std::uint32_t> names;
+    std::vector<std::uint64_t> sizes;
+    std::vector<std::uint64_t> dependencies;
+    std::vector<std::uint64_t> edge_offsets;
+    std::vector<std::uint32_t> edge_targets;
+};
+
+flat_graph flatten(cpp_dep::include_graph_t const& g, name_table& names)
+{
+    flat_graph flat;
+    std::size_t num_vertices = boost::num_vertices(g);
+    flat.names.reserve(num_vertices);
+    flat.sizes.reserve(num_vertices);
+    flat.dependencies.reserve(num_vertices);
+    flat.edge_offsets.reserve(num_vertices + 1);
+    flat.edge_offsets.push_back(0);
+    flat.edge_targets.reserve(boost::num_edges(g));
+
+    // Out edges are kept in order so the inferred include
+    // tree comes out the same after a reload.
+    for(auto v : boost::make_iterator_range(boost::vertices(g)))
+    {
+        flat.names.push_back(names.intern(g[v].name));
+        flat.sizes.push_back(g[v].size);
+        flat.dependencies.push_back(g[v].size_dependencies);
+        for(auto child : boost::make_iterator_range(boost::adjacent_vertices(v, g)))
+        {
+            flat.edge_targets.push_back(static_cast<std::uint32_t>(child));
+        }
+
+        flat.edge_offsets.push_back(flat.edge_targets.size());
+    }
+
+    return flat;
+}
+
+// -----------------------------------------------------------------------------
+//
+bool read_graph(
+    snapshot_reader& in,
+    std::uint64_t const* name_offsets,
+    char const* name_bytes,
+    std::uint64_t num_names,
+    cpp_dep::include_graph_t& g)
+{
+    graph_header const* header = in.read<graph_header>(1);
+    if(!header)
+        return false;
+
+    std::uint64_t n = header->num_vertices;
+    std::uint32_t const* names = in.read<std::uint32_t>(n);
+    std::uint64_t const* sizes = in.read<std::uint64_t>(n);
+    std::uint64_t const* dependencies = in.read<std::uint64_t>(n);
+    std::uint64_t const* edge_offsets = in.read<std::uint64_t>(n + 1);
+    std::uint32_t const* edge_targets = in.read<std::uint32_t>(header->num_edges);
+    if(!names || !sizes || !dependencies || !edge_offsets || !edge_targets)
+        return false;
+
+    cpp_dep::include_graph_t& result = g;
+    result.clear();
+    for(std::uint64_t v = 0; v < n; ++v)
+    {
+        if(names[v] >= num_names)
+            return false;
+
+        cpp_dep::include_vertex_descriptor_t added = boost::add_vertex(result);
+        cpp_dep::include_vertex_t& file = result[added];
+        file.name.assign(
+            name_bytes + name_offsets[names[v]],
+            name_bytes + name_offsets[names[v] + 1]);
+        file.size = static_cast<std::size_t>(sizes[v]);
+        file.size_dependencies = static_cast<std::size_t>(dependencies[v]);
+    }
+
+    if(edge_offsets[0] != 0 || edge_offsets[n] != header->num_edges)
+        return false;
+
+    for(std::uint64_t v = 0; v < n; ++v)
+    {
+        if(edge_offsets[v + 1] < edge_offsets[v] || edge_offsets[v + 1] > header->num_edges)
+            return false;
+
+        for(std::uint64_t e = edge_offsets[v]; e < edge_offsets[v + 1]; ++e)
+        {
+            if(edge_targets[e] >= n)
+                return false;
+
+            boost::add_edge(
+                static_cast<cpp_dep::include_vertex_descriptor_t>(v),
+                static_cast<cpp_dep::include_vertex_descriptor_t>(edge_targets[e]),
+                result);
+        }
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+//
+void read_stdin_log(
+    graph_snapshot& snapshot,
+    bool with_paths,
+    unsigned num_threads,
+    task_monitor* monitor,
+    path_normaliser const& normaliser)
+{
+#if defined(_WIN32)
+    // Keep msvc's \r\n intact, the same as a mapped log.
+    _setmode(_fileno(stdin), _O_BINARY);
+#endif
+
+    snapshot.includes = read_include_log(std::cin, kStdinRootName, num_threads, monitor, normaliser);
+    snapshot.has_paths = with_paths;
+    if(with_paths)
+    {
+        report_progress(monitor, "Building path tree", 0);
+        snapshot.paths = cpp_dep::invert_to_paths(snapshot.includes);
+    }
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+//
+log_fingerprint fingerprint_log(std::string const& log)
+{
+    namespace fs = boost::filesystem;
+
+    log_fingerprint fingerprint;
+    boost::system::error_code ec;
+    fingerprint.size = fs::file_size(log, ec);
+    if(!ec)
+        fingerprint.mtime = static_cast<std::int64_t>(fs::last_write_time(log, ec));
+
+    if(ec)
+        throw std::runtime_error("Failed to read \"" + log + "\": " + ec.message());
+
+    std::ifstream in(log, std::ios::binary);
+    if(!in)
+        throw std::runtime_error("Failed to open \"" + log + "\"");
+
+    std::vector<char> block(kHashBlockSize);
+    std::uint64_t hash = 14695981039346656037ull;
+    in.read(block.data(), block.size());
+    hash = fnv1a(hash, block.data(), static_cast<std::size_t>(in.gcount()));
+    if(fingerprint.size > 2 * kHashBlockSize)
+    {
+        in.clear();
+        in.seekg(fingerprint.size - kHashBlockSize);
+        in.read(block.data(), block.size());
+        hash = fnv1a(hash, block.data(), static_cast<std::size_t>(in.gcount()));
+    }
+
+    fingerprint.hash = hash;
+    return fingerprint;
+}
+
+// -----------------------------------------------------------------------------
+//
+std::string snapshot_filename(std::string const& log)
+{
+    return log + kSnapshotExtension;
+}
+
+// -----------------------------------------------------------------------------
+//
+bool is_snapshot_filename(std::string const& filename)
+{
+    auto ends_with = [&filename](std::string const& suffix)
+    {
+        return filename.size() >= suffix.size()
+            && filename.compare(filename.size() - suffix.size(), suffix.size(), suffix) == 0;
+    };
+
+    return ends_with(kSnapshotExtension)
+        || ends_with(std::string(kSnapshotExtension) + kTempExtension);
+}
+
+// -----------------------------------------------------------------------------
+//
+bool read_graph_snapshot(
+    std::string const& log,
+    graph_snapshot& snapshot,
+    path_normaliser const& normaliser)
+{
+    std::string filename = snapshot_filename(log);
+    boost::system::error_code ec;
+    if(!boost::filesystem::exists(filename, ec))
+        return false;
+
+    try
+    {
+        log_fingerprint fingerprint = fingerprint_log(log);
+        boost::iostreams::mapped_file_source file(filename);
+        snapshot_reader in(file.data(), file.data() + file.size());
+
+        snapshot_header const* header = in.read<snapshot_header>(1);
+        if(!header
+            || std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0
+            || header->version != kVersion
+            || header->num_graphs < 1 || header->num_graphs > 2
+            || header->log_size != fingerprint.size
+            || header->log_mtime != fingerprint.mtime
+            || header->log_hash != fingerprint.hash
+            || header->normaliser != normaliser.fingerprint())
+        {
+            return false;
+        }
+
+        std::uint64_t const* name_offsets = in.read<std::uint64_t>(header->num_names + 1);
+        if(!name_offsets)
+            return false;
+
+        char const* name_bytes = in.read<char>(name_offsets[header->num_names]);
+        if(!name_bytes)
+            return false;
+
+        for(std::uint64_t i = 0; i < header->num_names; ++i)
+        {
+            if(name_offsets[i + 1] < name_offsets[i])
+                return false;
+        }
+
+        if(!read_graph(in, name_offsets, name_bytes, header->num_names, snapshot.includes))
+            return false;
+
+        snapshot.has_paths = header->num_graphs == 2;
+        if(snapshot.has_paths)
+            return read_graph(in, name_offsets, name_bytes, header->num_names, snapshot.paths);
+
+        snapshot.paths.clear();
+        return true;
+    }
+    catch(std::exception&)
+    {
+        // Anything unreadable is treated as stale.
+        return false;
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+void write_graph_snapshot(
+    std::string const& log,
+    graph_snapshot const& snapshot,
+    path_normaliser const& normaliser)
+{
+    namespace fs = boost::filesystem;
+
+    log_fingerprint fingerprint = fingerprint_log(log);
+
+    name_table names;
+    flat_graph includes = flatten(snapshot.includes, names);
+    flat_graph paths;
+    if(snapshot.has_paths)
+        paths = flatten(snapshot.paths, names);
+
+    snapshot_header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.num_graphs = snapshot.has_paths ? 2 : 1;
+    header.log_size = fingerprint.size;
+    header.log_mtime = fingerprint.mtime;
+    header.log_hash = fingerprint.hash;
+    header.normaliser = normaliser.fingerprint();
+    header.num_names = names.offsets().size() - 1;
+
+    std::string filename = snapshot_filename(log);
+    std::string temp_filename = filename + kTempExtension;
+    {
+        std::ofstream out(temp_filename, std::ios::binary | std::ios::trunc);
+        if(!out)
+            throw std::runtime_error("Failed to create \"" + temp_filename + "\"");
+
+        snapshot_writer writer(out);
+        writer.write(&header, 1);
+        writer.write(names.offsets());
+        writer.write(names.bytes());
+
+        auto write_graph = [&writer](flat_graph const& flat)
+        {
+            graph_header gh;
+            gh.num_vertices = flat.names.size();
+            gh.num_edges = flat.edge_targets.size();
+            writer.write(&gh, 1);
+            writer.write(flat.names);
+            writer.write(flat.sizes);
+            writer.write(flat.dependencies);
+            writer.write(flat.edge_offsets);
+            writer.write(flat.edge_targets);
+        };
+
+        write_graph(includes);
+        if(snapshot.has_paths)
+            write_graph(paths);
+
+        if(!out.flush())
+            throw std::runtime_error("Failed to write \"" + temp_filename + "\"");
+    }
+
+    boost::system::error_code ec;
+    fs::rename(temp_filename, filename, ec);
+    if(ec)
+    {
+        fs::remove(temp_filename, ec);
+        throw std::runtime_error("Failed to write \"" + filename + "\"");
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+std::shared_ptr<graph_snapshot> load_include_log(
+    std::string const& log,
+    bool with_paths,
+    unsigned num_threads,
+    task_monitor* monitor,
+    path_normaliser const& normaliser)
+{
+    auto snapshot = std::make_shared<graph_snapshot>();
+    if(log == "-")
+    {
+        read_stdin_log(*snapshot, with_paths, num_threads, monitor, normaliser);
+        return snapshot;
+    }
+
+    report_progress(monitor, "Reading snapshot", 0);
+    if(read_graph_snapshot(log, *snapshot, normaliser) && (snapshot->has_paths || !with_paths))
+        return snapshot;
+
+    snapshot->includes = read_include_log(log.c_str(), num_threads, monitor, normaliser);
+    snapshot->has_paths = with_paths;
+    snapshot->paths.clear();
+    if(with_paths)
+    {
+        report_progress(monitor, "Building path tree", 0);
+        snapshot->paths = cpp_dep::invert_to_paths(snapshot->includes);
+    }
+
+    try
+    {
+        write_graph_snapshot(log, *snapshot, normaliser);
+    }
+    catch(std::exception&)
+    {
+        // The log may be somewhere we can't write, which just
+        // means it gets parsed again next time.
+    }
+
+    return snapshot;
+}
@@ -0,0 +1,113 @@
+// *****************************************************************************
+//
+// parse/graph_snapshot.hpp
+//
+// Compact binary snapshot of the graphs built from an include log, written
+// next to the log so reopening it skips parsing, statting every header and
+// inverting to paths. Names are interned into one table shared by both
+// graphs and edges are stored as CSR adjacency. The snapshot is memory
+// mapped on load and rejected if the log has changed since it was written.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_PARSE_GRAPHSNAPSHOT_HPP_
+#define CPPSIZE_PARSE_GRAPHSNAPSHOT_HPP_
+
+#include "cpp_dep/cpp_dep.hpp"
+#include "parse/path_normaliser.hpp"
+#include "util/task_monitor.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// -----------------------------------------------------------------------------
+//
+// Identifies one version of a log: its size, modification time and a hash
+// of its first and last blocks.
+struct log_fingerprint
+{
+    log_fingerprint()
+        : size(0)
+        , mtime(0)
+        , hash(0)
+    {}
+
+    std::uint64_t size;
+    std::int64_t mtime;
+    std::uint64_t hash;
+};
+
+inline bool operator==(log_fingerprint const& a, log_fingerprint const& b)
+{
+    return a.size == b.size && a.mtime == b.mtime && a.hash == b.hash;
+}
+
+inline bool operator!=(log_fingerprint const& a, log_fingerprint const& b)
+{
+    return !(a == b);
+}
+
+// Throws std::runtime_error if the log can't be read.
+log_fingerprint fingerprint_log(std::string const& log);
+
+// -----------------------------------------------------------------------------
+//
+struct graph_snapshot
+{
+    graph_snapshot()
+        : has_paths(false)
+    {}
+
+    cpp_dep::include_graph_t includes;
+
+    // The filesystem graph is optional so that callers that never look at
+    // paths don't pay for inverting.
+    bool has_paths;
+    cpp_dep::include_graph_t paths;
+};
+
+// Where the snapshot for a log lives.
+std::string snapshot_filename(std::string const& log);
+
+// True for snapshots and their temporaries, so directory scans can skip
+// them.
+bool is_snapshot_filename(std::string const& filename);
+
+// Loads the snapshot for log into snapshot. Returns false if there is no
+// snapshot, it was written for a different version of the log or with a
+// different normaliser, or it can't be read, in which case the log should
+// be parsed again and the contents of snapshot are unspecified. The graphs
+// are built in place because adjacency_list can only be copied, not moved.
+bool read_graph_snapshot(
+    std::string const& log,
+    graph_snapshot& snapshot,
+    path_normaliser const& normaliser = path_normaliser());
+
+// Writes the snapshot for log, whose names were normalised with
+// normaliser. The file is written under a temporary name and renamed into
+// place so readers never see half a snapshot. Throws std::runtime_error on
+// failure.
+void write_graph_snapshot(
+    std::string const& log,
+    graph_snapshot const& snapshot,
+    path_normaliser const& normaliser = path_normaliser());
+
+// Loads log from its snapshot if that's current and has everything asked
+// for, otherwise parses the log with read_include_log and tries to write a
+// new snapshot. Failing to write the snapshot isn't an error. Header sizes
+// are only as fresh as the snapshot, so a header edited without the log
+// changing keeps its old size. A log named "-" is streamed from stdin and
+// never has a snapshot.
+std::shared_ptr<graph_snapshot> load_include_log(
+    std::string const& log,
+    bool with_paths,
+    unsigned num_threads = 0,
+    task_monitor* monitor = nullptr,
+    path_normaliser const& normaliser = path_normaliser());
+
+#endif // CPPSIZE_PARSE_GRAPHSNAPSHOT_HPP_
@@ -0,0 +1,601 @@
+// *****************************************************************************
+//
+// parse/include_log_parser.cpp
+//
+// Parser for gcc/clang -H and msvc /showIncludes logs.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "parse/include_log_parser.hpp"
+#include "util/parallel_for.hpp"
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <istream>
+#include <stdexcept>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+    char const kMsvcPrefix[] = "Note: including file:";
+    char const kGuardListLine[] = "Multiple include guards may be useful for:";
+
+    // Logs smaller than this aren't worth splitting up.
+    std::size_t const kMinParallelLogSize = 4 * 1024 * 1024;
+
+    // Chunks per thread, so a few slow chunks don't leave threads idle.
+    std::size_t const kChunksPerThread = 4;
+
+    // How much of a log is parsed between progress reports when parsing
+    // on one thread.
+    std::size_t const kProgressSliceSize = 1024 * 1024;
+
+    // Read size for logs that arrive as a stream.
+    std::size_t const kStreamBufferSize = 64 * 1024;
+
+    char const kParseStage[] = "Parsing";
+    char const kSizeStage[] = "Reading sizes";
+
+    bool starts_with(char const* first, char const* last, char const* prefix, std::size_t prefix_len)
+    {
+        return std::size_t(last - first) >= prefix_len &&
+            std::memcmp(first, prefix, prefix_len) == 0;
+    }
+
+    bool is_source_file(char const* first, char const* last)
+    {
+        static char const* const extensions[] = { ".c", ".cc", ".cpp", ".cxx", ".c++", ".C" };
+
+        if(first == last || std::find_if(first, last, [](char c) { return c == ' ' || c == '\t'; }) != last)
+            return false;
+
+        return std::any_of(
+            std::begin(extensions),
+            std::end(extensions),
+            [first, last](char const* ext)
+            {
+                std::size_t len = std::strlen(ext);
+                return std::size_t(last - first) > len &&
+                    std::memcmp(last - len, ext, len) == 0;
+            }
+        );
+    }
+
+    char const* next_line(char const* first, char const* last)
+    {
+        char const* eol = static_cast<char const*>(std::memchr(first, '\n', last - first));
+        return eol ? eol + 1 : last;
+    }
+
+    char const* line_end(char const* first, char const* last)
+    {
+        char const* eol = static_cast<char const*>(std::memchr(first, '\n', last - first));
+        return eol ? eol : last;
+    }
+
+    // Finds the start of the first top level line at or after pos, which is
+    // a point where parsing can start without knowing the include stack.
+    char const* find_chunk_boundary(char const* pos, char const* first, char const* last)
+    {
+        // Step to the start of the next line unless already on one.
+        if(pos != first && pos[-1] != '\n')
+            pos = next_line(pos, last);
+
+        while(pos != last)
+        {
+            include_log_line line = classify_include_log_line(pos, line_end(pos, last));
+            if((line.kind == include_log_line::include && line.depth == 1) ||
+                line.kind == include_log_line::source)
+            {
+                return pos;
+            }
+
+            pos = next_line(pos, last);
+        }
+
+        return last;
+    }
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+//
+include_log_line classify_include_log_line(char const* first, char const* last)
+{
+    include_log_line line;
+    line.kind = include_log_line::other;
+    line.depth = 0;
+    line.name_first = first;
+    line.name_last = first;
+
+    if(first != last && last[-1] == '\r')
+        --last;
+
+    if(first == last)
+        return line;
+
+    std::size_t const msvc_prefix_len = sizeof(kMsvcPrefix) - 1;
+    if(first[0] == '.')
+    {
+        // gcc: one dot per level, then a space.
+        char const* p = first;
+        while(p != last && *p == '.')
+            ++p;
+
+        if(p == last || *p != ' ')
+            return line;
+
+        line.kind = include_log_line::include;
+        line.depth = static_cast<int>(p - first);
+        line.name_first = p + 1;
+        line.name_last = last;
+    }
+    else if(starts_with(first, last, kMsvcPrefix, msvc_prefix_len))
+    {
+        // msvc: one space per level.
+        char const* p = first + msvc_prefix_len;
+        char const* name = p;
+        while(name != last && *name == ' ')
+            ++name;
+
+        if(name == p || name == last)
+            return line;
+
+        line.kind = include_log_line::include;
+        line.depth = static_cast<int>(name - p);
+        line.name_first = name;
+        line.name_last = last;
+    }
+    else if(starts_with(first, last, kGuardListLine, sizeof(kGuardListLine) - 1))
+    {
+        line.kind = include_log_line::guard_list;
+    }
+    else if(is_source_file(first, last))
+    {
+        line.kind = include_log_line::source;
+        line.name_first = first;
+        line.name_last = last;
+    }
+
+    return line;
+}
+
+// -----------------------------------------------------------------------------
+//
+include_log_builder::include_log_builder(
+    std::string const& root_name,
+    path_normaliser const& normaliser)
+    : normaliser_(normaliser)
+    , log_root_(pending_root)
+    , in_guard_list_(false)
+{
+    if(root_name.empty())
+    {
+        stack_.push_back(pending_root);
+    }
+    else
+    {
+        log_root_ = intern(root_name);
+        roots_.push_back(log_root_);
+        stack_.push_back(log_root_);
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+void include_log_builder::add_line(char const* first, char const* last)
+{
+    include_log_line line = classify_include_log_line(first, last);
+    switch(line.kind)
+    {
+    case include_log_line::include:
+    {
+        in_guard_list_ = false;
+
+        // Clamp bad depths to the deepest file we know about.
+        std::size_t depth = std::min<std::size_t>(line.depth, stack_.size());
+        stack_.resize(depth);
+
+        name_index_t child = intern(line.name_first, line.name_last);
+        edges_.emplace_back(stack_.back(), child);
+        stack_.push_back(child);
+        break;
+    }
+    case include_log_line::source:
+    {
+        // The guard list is a list of bare header names.
+        if(in_guard_list_)
+            break;
+
+        name_index_t root = intern(line.name_first, line.name_last);
+        roots_.push_back(root);
+        stack_.assign(1, root);
+        break;
+    }
+    case include_log_line::guard_list:
+        in_guard_list_ = true;
+        break;
+    case include_log_line::other:
+        break;
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+void include_log_builder::add_lines(char const* first, char const* last)
+{
+    while(first != last)
+    {
+        char const* eol = line_end(first, last);
+        add_line(first, eol);
+        first = eol == last ? last : eol + 1;
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+void include_log_builder::append(include_log_builder const& next)
+{
+    // Names are already normalised, so only spellings new to this
+    // builder need to be.
+    std::vector<name_index_t> remap(next.names_.size());
+    for(name_index_t i = 0; i < next.names_.size(); ++i)
+    {
+        remap[i] = add_name(next.names_[i], next.paths_[i]);
+    }
+
+    name_index_t root = stack_.front();
+    auto map_index = [&remap, root](name_index_t i)
+    {
+        return i == pending_root ? root : remap[i];
+    };
+
+    edges_.reserve(edges_.size() + next.edges_.size());
+    for(auto&& e : next.edges_)
+    {
+        edges_.emplace_back(map_index(e.first), map_index(e.second));
+    }
+
+    for(auto r : next.roots_)
+    {
+        roots_.push_back(remap[r]);
+    }
+
+    stack_.clear();
+    for(auto s : next.stack_)
+    {
+        stack_.push_back(map_index(s));
+    }
+
+    in_guard_list_ = next.in_guard_list_;
+}
+
+// -----------------------------------------------------------------------------
+//
+cpp_dep::include_graph_t include_log_builder::finish(
+    unsigned num_threads,
+    task_monitor* monitor) const
+{
+    cpp_dep::include_graph_t g;
+
+    report_progress(monitor, kSizeStage, 0);
+    std::vector<std::size_t> sizes(names_.size(), 0);
+    parallel_for(
+        names_.size(),
+        num_threads,
+        [this, &sizes, monitor](unsigned, std::size_t i)
+        {
+            check_cancelled(monitor);
+
+            // The log itself isn't part of the source.
+            if(i == log_root_)
+                return;
+
+            std::string const& path = paths_[i].empty() ? names_[i] : paths_[i];
+            boost::system::error_code ec;
+            boost::uintmax_t size = boost::filesystem::file_size(path, ec);
+            sizes[i] = ec ? 0 : static_cast<std::size_t>(size);
+        }
+    );
+
+    report_progress(monitor, kSizeStage, 100);
+
+    for(name_index_t i = 0; i < names_.size(); ++i)
+    {
+        cpp_dep::include_vertex_t file;
+        file.name = names_[i];
+        file.size = sizes[i];
+        file.size_dependencies = 0;
+        boost::add_vertex(file, g);
+    }
+
+    // Only happens if nothing ever named a root.
+    cpp_dep::include_vertex_descriptor_t pending = 0;
+    bool has_pending = std::any_of(
+        edges_.begin(),
+        edges_.end(),
+        [](std::pair<name_index_t, name_index_t> const& e)
+        {
+            return e.first == pending_root;
+        }
+    );
+
+    // The same translation unit can show up more than once.
+    std::vector<cpp_dep::include_vertex_descriptor_t> roots;
+    std::vector<bool> is_root(names_.size(), false);
+    for(auto r : roots_)
+    {
+        if(!is_root[r])
+        {
+            is_root[r] = true;
+            roots.push_back(r);
+        }
+    }
+
+    if(has_pending)
+    {
+        cpp_dep::include_vertex_t file;
+        file.name = "<unknown>";
+        file.size = 0;
+        file.size_dependencies = 0;
+        pending = boost::add_vertex(file, g);
+        roots.insert(roots.begin(), pending);
+    }
+
+    for(auto&& e : edges_)
+    {
+        boost::add_edge(e.first == pending_root ? pending : e.first, e.second, g);
+    }
+
+    // size_dependencies is the size of everything a header pulls in the
+    // first time it's included, which is what the inferred include tree
+    // shows under it. Each translation unit is walked separately and a
+    // header keeps the largest value it gets in any of them.
+    typedef boost::graph_traits<cpp_dep::include_graph_t>::adjacency_iterator child_iterator;
+    struct frame
+    {
+        cpp_dep::include_vertex_descriptor_t v;
+        child_iterator next;
+        child_iterator end;
+    };
+
+    std::size_t num_vertices = boost::num_vertices(g);
+    std::vector<std::size_t> walk_size(num_vertices, 0);
+    std::vector<std::size_t> walk_id(num_vertices, 0);
+    std::vector<frame> stack;
+    for(std::size_t r = 0; r < roots.size(); ++r)
+    {
+        auto push = [&](cpp_dep::include_vertex_descriptor_t v)
+        {
+            walk_id[v] = r + 1;
+            walk_size[v] = 0;
+            auto children = boost::adjacent_vertices(v, g);
+            stack.push_back(frame{v, children.first, children.second});
+        };
+
+        push(roots[r]);
+        while(!stack.empty())
+        {
+            frame& top = stack.back();
+            if(top.next != top.end)
+            {
+                cpp_dep::include_vertex_descriptor_t child = *top.next++;
+                if(walk_id[child] != r + 1)
+                    push(child);
+
+                continue;
+            }
+
+            cpp_dep::include_vertex_descriptor_t v = top.v;
+            stack.pop_back();
+
+            cpp_dep::include_vertex_t& file = g[v];
+            file.size_dependencies = std::max(file.size_dependencies, walk_size[v]);
+            if(!stack.empty())
+                walk_size[stack.back().v] += file.size + walk_size[v];
+        }
+    }
+
+    return g;
+}
+
+// -----------------------------------------------------------------------------
+//
+include_log_builder::name_index_t include_log_builder::intern(char const* first, char const* last)
+{
+    return intern(std::string(first, last));
+}
+
+// -----------------------------------------------------------------------------
+//
+include_log_builder::name_index_t include_log_builder::intern(std::string const& spelling)
+{
+    auto i = spelling_ids_.find(spelling);
+    if(i != spelling_ids_.end())
+        return i->second;
+
+    std::string name = normaliser_(spelling);
+    name_index_t id = add_name(name, name == spelling ? std::string() : spelling);
+    spelling_ids_.emplace(spelling, id);
+    return id;
+}
+
+// -----------------------------------------------------------------------------
+//
+include_log_builder::name_index_t include_log_builder::add_name(
+    std::string const& name,
+    std::string const& path)
+{
+    auto i = name_ids_.find(name);
+    if(i != name_ids_.end())
+        return i->second;
+
+    name_index_t id = static_cast<name_index_t>(names_.size());
+    names_.push_back(name);
+    paths_.push_back(path);
+    name_ids_.emplace(name, id);
+    return id;
+}
+
+// -----------------------------------------------------------------------------
+//
+cpp_dep::include_graph_t read_include_log(
+    char const* filename,
+    unsigned num_threads,
+    task_monitor* monitor,
+    path_normaliser const& normaliser)
+{
+    namespace fs = boost::filesystem;
+
+    report_progress(monitor, kParseStage, 0);
+
+    boost::system::error_code ec;
+    boost::uintmax_t log_size = fs::file_size(filename, ec);
+    if(ec)
+        throw std::runtime_error("Failed to open include log: " + ec.message());
+
+    include_log_builder builder(filename, normaliser);
+    if(log_size == 0)
+        return builder.finish(num_threads, monitor);
+
+    boost::iostreams::mapped_file_source log;
+    try
+    {
+        log.open(filename);
+    }
+    catch(std::exception& e)
+    {
+        throw std::runtime_error(std::string("Failed to map include log: ") + e.what());
+    }
+
+    char const* first = log.data();
+    char const* last = first + log.size();
+
+    // Chunks finish out of order, so progress is tracked as a byte count.
+    std::atomic<std::size_t> bytes_parsed(0);
+    std::atomic<int> last_percent(0);
+    auto parsed = [&](std::size_t bytes)
+    {
+        int percent = static_cast<int>(((bytes_parsed += bytes) * 100) / log.size());
+        if(percent != last_percent.exchange(percent))
+            report_progress(monitor, kParseStage, percent);
+        else
+            check_cancelled(monitor);
+    };
+
+    unsigned threads = resolve_thread_count(num_threads, log.size() / kMinParallelLogSize);
+    if(threads == 1)
+    {
+        for(char const* pos = first; pos != last; )
+        {
+            char const* slice_end = pos + std::min<std::size_t>(kProgressSliceSize, last - pos);
+            if(slice_end != last)
+                slice_end = next_line(slice_end, last);
+
+            builder.add_lines(pos, slice_end);
+            parsed(slice_end - pos);
+            pos = slice_end;
+        }
+
+        return builder.finish(num_threads, monitor);
+    }
+
+    // Split at top level lines so each chunk starts with an empty include
+    // stack. Chunks other than the first don't know their root until
+    // they're appended in order.
+    std::size_t num_chunks = threads * kChunksPerThread;
+    std::vector<char const*> bounds;
+    bounds.push_back(first);
+    for(std::size_t c = 1; c < num_chunks; ++c)
+    {
+        char const* pos = find_chunk_boundary(
+            std::max(first + (log.size() * c) / num_chunks, bounds.back()),
+            first, last);
+
+        if(pos != bounds.back())
+            bounds.push_back(pos);
+    }
+
+    if(bounds.back() != last)
+        bounds.push_back(last);
+
+    std::vector<include_log_builder> chunks(
+        bounds.size() - 1, include_log_builder(std::string(), normaliser));
+    parallel_for(
+        chunks.size(),
+        threads,
+        [&bounds, &chunks, &builder, &parsed](unsigned, std::size_t c)
+        {
+            if(c == 0)
+                builder.add_lines(bounds[0], bounds[1]);
+            else
+                chunks[c].add_lines(bounds[c], bounds[c + 1]);
+
+            parsed(bounds[c + 1] - bounds[c]);
+        }
+    );
+
+    for(std::size_t c = 1; c < chunks.size(); ++c)
+    {
+        builder.append(chunks[c]);
+    }
+
+    return builder.finish(num_threads, monitor);
+}
+
+// -----------------------------------------------------------------------------
+//
+cpp_dep::include_graph_t read_include_log(
+    std::istream& in,
+    std::string const& root_name,
+    unsigned num_threads,
+    task_monitor* monitor,
+    path_normaliser const& normaliser)
+{
+    report_progress(monitor, kParseStage, 0);
+
+    include_log_builder builder(root_name, normaliser);
+
+    // Lines are parsed as each block arrives. Only the unfinished line at
+    // the end of a block is carried over to the next, so the buffer only
+    // grows if a single line doesn't fit.
+    std::vector<char> buffer(kStreamBufferSize);
+    std::size_t carried = 0;
+    while(in)
+    {
+        check_cancelled(monitor);
+
+        if(carried == buffer.size())
+            buffer.resize(buffer.size() * 2);
+
+        in.read(buffer.data() + carried, buffer.size() - carried);
+        std::size_t filled = carried + static_cast<std::size_t>(in.gcount());
+
+        char const* first = buffer.data();
+        char const* last = first + filled;
+        char const* complete = last;
+        if(in)
+        {
+            while(complete != first && complete[-1] != '\n')
+                --complete;
+        }
+
+        builder.add_lines(first, complete);
+        carried = last - complete;
+        std::memmove(buffer.data(), complete, carried);
+    }
+
+    if(in.bad())
+        throw std::runtime_error("Failed to read include log from " + root_name);
+
+    return builder.finish(num_threads, monitor);
+}
@@ -0,0 +1,138 @@
+// *****************************************************************************
+//
+// parse/include_log_parser.hpp
+//
+// Parser for gcc/clang -H and msvc /showIncludes logs that builds a
+// cpp_dep::include_graph_t. Large logs are memory mapped, split at top
+// level include lines and parsed on several threads, with the partial
+// results stitched back together in log order. Logs can also be streamed
+// in, in which case they're parsed a block at a time.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_PARSE_INCLUDELOGPARSER_HPP_
+#define CPPSIZE_PARSE_INCLUDELOGPARSER_HPP_
+
+#include "cpp_dep/cpp_dep.hpp"
+#include "parse/path_normaliser.hpp"
+#include "util/task_monitor.hpp"
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+struct include_log_line
+{
+    enum kind_t
+    {
+        // Nothing we understand.
+        other,
+        // An include at depth >= 1.
+        include,
+        // The name of a new translation unit, as echoed by msvc.
+        source,
+        // gcc's "Multiple include guards may be useful for:" trailer.
+        guard_list,
+    };
+
+    kind_t kind;
+    int depth;
+    char const* name_first;
+    char const* name_last;
+};
+
+// Classifies one line, without its line terminator.
+include_log_line classify_include_log_line(char const* first, char const* last);
+
+// -----------------------------------------------------------------------------
+//
+// Accumulates parsed lines into a name table and edge list. One edge is
+// recorded per include line so include counts match the log. Names are
+// normalised as they're interned, once per distinct spelling, and each
+// header is stat'd through the first spelling it was seen with.
+class include_log_builder
+{
+public:
+
+    // Top level includes attach to a root named root_name. If root_name is
+    // empty they attach to whatever root is current when this builder is
+    // appended to another one.
+    explicit include_log_builder(
+        std::string const& root_name = std::string(),
+        path_normaliser const& normaliser = path_normaliser());
+
+    void add_line(char const* first, char const* last);
+
+    // Splits [first, last) into lines and adds each one.
+    void add_lines(char const* first, char const* last);
+
+    // Appends the lines of a builder that continued parsing where this one
+    // stopped, as if they had been added to this builder directly.
+    void append(include_log_builder const& next);
+
+    // Builds the graph. Stats every header for its size using num_threads
+    // threads (0 for hardware concurrency) and fills in size_dependencies
+    // from the inferred include tree.
+    cpp_dep::include_graph_t finish(
+        unsigned num_threads = 0,
+        task_monitor* monitor = nullptr) const;
+
+private:
+
+    typedef std::uint32_t name_index_t;
+    enum : name_index_t { pending_root = ~name_index_t(0) };
+
+    name_index_t intern(char const* first, char const* last);
+    name_index_t intern(std::string const& spelling);
+    name_index_t add_name(std::string const& name, std::string const& path);
+
+    path_normaliser normaliser_;
+
+    // Normalised names, and the spelling to stat each one through if
+    // that's different.
+    std::vector<std::string> names_;
+    std::vector<std::string> paths_;
+    std::unordered_map<std::string, name_index_t> name_ids_;
+    std::unordered_map<std::string, name_index_t> spelling_ids_;
+    std::vector<std::pair<name_index_t, name_index_t>> edges_;
+    std::vector<name_index_t> roots_;
+
+    // The root named after the log, which isn't stat'd.
+    name_index_t log_root_;
+
+    // stack_[0] is the current root, stack_[d] the file at depth d.
+    std::vector<name_index_t> stack_;
+    bool in_guard_list_;
+};
+
+// -----------------------------------------------------------------------------
+//
+// Reads an include log. num_threads of 0 uses the hardware concurrency,
+// small logs are always parsed on the calling thread. Header names are
+// normalised with normaliser. Throws std::runtime_error if the log can't be
+// read, or task_cancelled if the monitor asks to stop.
+cpp_dep::include_graph_t read_include_log(
+    char const* filename,
+    unsigned num_threads = 0,
+    task_monitor* monitor = nullptr,
+    path_normaliser const& normaliser = path_normaliser());
+
+// Reads an include log from a stream, such as a compiler's output piped
+// to stdin, parsing lines as they arrive instead of waiting for the whole
+// log. Top level includes attach to a root named root_name.
+cpp_dep::include_graph_t read_include_log(
+    std::istream& in,
+    std::string const& root_name,
+    unsigned num_threads = 0,
+    task_monitor* monitor = nullptr,
+    path_normaliser const& normaliser = path_normaliser());
+
+#endif // CPPSIZE_PARSE_INCLUDELOGPARSER_HPP_
@@ -0,0 +1,297 @@
+// *****************************************************************************
+//
+// parse/json_reader.cpp
+//
+// Streaming pull parser for JSON.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "parse/json_reader.hpp"
+#include <cstdlib>
+#include <stdexcept>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+    std::size_t const kBufferSize = 64 * 1024;
+}
+
+// -----------------------------------------------------------------------------
+//
+json_reader::json_reader(std::istream& in)
+    : in_(in)
+    , buffer_(kBufferSize)
+    , pos_(0)
+    , end_(0)
+    , offset_(0)
+{}
+
+// -----------------------------------------------------------------------------
+//
+json_reader::token json_reader::next()
+{
+    for(;;)
+    {
+        skip_whitespace();
+        int c = peek();
+        switch(c)
+        {
+        case EOF:
+            if(!stack_.empty())
+                fail("unexpected end of input");
+            return end_of_input;
+
+        // Separators carry no information for a reader that
+        // tracks keys by position, so they're just skipped.
+        case ',':
+        case ':':
+            get();
+            continue;
+
+        case '{':
+        case '[':
+            get();
+            stack_.push_back(frame{c == '{', c == '{'});
+            return c == '{' ? begin_object : begin_array;
+
+        case '}':
+        case ']':
+            get();
+            if(stack_.empty() || stack_.back().is_object != (c == '}'))
+                fail("mismatched bracket");
+            stack_.pop_back();
+            value_done();
+            return c == '}' ? end_object : end_array;
+
+        case '"':
+            get();
+            read_string();
+            if(!stack_.empty() && stack_.back().is_object && stack_.back().expect_key)
+            {
+                stack_.back().expect_key = false;
+                return key;
+            }
+
+            value_done();
+            return string;
+
+        default:
+            read_literal();
+            value_done();
+            if(text_ == "true" || text_ == "false")
+                return boolean;
+            if(text_ == "null")
+                return null;
+            return number;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+double json_reader::number_value() const
+{
+    char* end = nullptr;
+    double value = std::strtod(text_.c_str(), &end);
+    if(text_.empty() || *end != 0)
+        fail("expected a number");
+
+    return value;
+}
+
+// -----------------------------------------------------------------------------
+//
+void json_reader::skip_value(token first)
+{
+    if(first != begin_object && first != begin_array)
+        return;
+
+    std::size_t depth = stack_.size();
+    while(stack_.size() >= depth)
+    {
+        if(next() == end_of_input)
+            fail("unexpected end of input");
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+int json_reader::peek()
+{
+    if(pos_ == end_)
+    {
+        offset_ += end_;
+        in_.read(buffer_.data(), buffer_.size());
+        end_ = static_cast<std::size_t>(in_.gcount());
+        pos_ = 0;
+        if(end_ == 0)
+            return EOF;
+    }
+
+    return static_cast<unsigned char>(buffer_[pos_]);
+}
+
+// -----------------------------------------------------------------------------
+//
+int json_reader::get()
+{
+    int c = peek();
+    if(c != EOF)
+        ++pos_;
+    return c;
+}
+
+// -----------------------------------------------------------------------------
+//
+void json_reader::skip_whitespace()
+{
+    for(int c = peek(); c == ' ' || c == '\t' || c == '\n' || c == '\r'; c = peek())
+    {
+        ++pos_;
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+void json_reader::read_string()
+{
+    text_.clear();
+    for(;;)
+    {
+        int c = get();
+        if(c == EOF)
+            fail("unterminated string");
+
+        if(c == '"')
+            return;
+
+        if(c != '\\')
+        {
+            text_ += static_cast<char>(c);
+            continue;
+        }
+
+        c = get();
+        switch(c)
+        {
+        case '"':  text_ += '"'; break;
+        case '\\': text_ += '\\'; break;
+        case '/':  text_ += '/'; break;
+        case 'b':  text_ += '\b'; break;
+        case 'f':  text_ += '\f'; break;
+        case 'n':  text_ += '\n'; break;
+        case 'r':  text_ += '\r'; break;
+        case 't':  text_ += '\t'; break;
+        case 'u':
+        {
+            unsigned code_point = read_hex4();
+            if(code_point >= 0xD800 && code_point < 0xDC00)
+            {
+                if(get() != '\\' || get() != 'u')
+                    fail("unpaired surrogate");
+
+                unsigned low = read_hex4();
+                code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+            }
+
+            append_utf8(code_point);
+            break;
+        }
+        default:
+            fail("bad escape");
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+void json_reader::read_literal()
+{
+    text_.clear();
+    for(int c = peek(); c != EOF; c = peek())
+    {
+        bool literal_char =
+            (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
+            c == '-' || c == '+' || c == '.' || c == 'E';
+
+        if(!literal_char)
+            break;
+
+        text_ += static_cast<char>(c);
+        ++pos_;
+    }
+
+    if(text_.empty())
+        fail("unexpected character");
+}
+
+// -----------------------------------------------------------------------------
+//
+void json_reader::value_done()
+{
+    if(!stack_.empty() && stack_.back().is_object)
+        stack_.back().expect_key = true;
+}
+
+// -----------------------------------------------------------------------------
+//
+void json_reader::append_utf8(unsigned code_point)
+{
+    if(code_point < 0x80)
+    {
+        text_ += static_cast<char>(code_point);
+    }
+    else if(code_point < 0x800)
+    {
+        text_ += static_cast<char>(0xC0 | (code_point >> 6));
+        text_ += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+    else if(code_point < 0x10000)
+    {
+        text_ += static_cast<char>(0xE0 | (code_point >> 12));
+        text_ += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        text_ += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+    else
+    {
+        text_ += static_cast<char>(0xF0 | (code_point >> 18));
+        text_ += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+        text_ += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        text_ += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+unsigned json_reader::read_hex4()
+{
+    unsigned value = 0;
+    for(int i = 0; i < 4; ++i)
+    {
+        int c = get();
+        value <<= 4;
+        if(c >= '0' && c <= '9')
+            value |= c - '0';
+        else if(c >= 'a' && c <= 'f')
+            value |= c - 'a' + 10;
+        else if(c >= 'A' && c <= 'F')
+            value |= c - 'A' + 10;
+        else
+            fail("bad \\u escape");
+    }
+
+    return value;
+}
+
+// -----------------------------------------------------------------------------
+//
+void json_reader::fail(char const* what) const
+{
+    throw std::runtime_error(
+        std::string("Invalid JSON at byte ") + std::to_string(offset_ + pos_) + ": " + what);
+}
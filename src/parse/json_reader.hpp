@@ -0,0 +1,92 @@
+// *****************************************************************************
+//
+// parse/json_reader.hpp
+//
+// Streaming pull parser for JSON. Tokens are read one at a time from a
+// buffered std::istream so arbitrarily large documents, like clang's time
+// traces, can be walked without building a DOM.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_PARSE_JSONREADER_HPP_
+#define CPPSIZE_PARSE_JSONREADER_HPP_
+
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+class json_reader
+{
+public:
+
+    enum token
+    {
+        begin_object,
+        end_object,
+        begin_array,
+        end_array,
+        // An object key, its text is in text().
+        key,
+        string,
+        number,
+        boolean,
+        null,
+        end_of_input,
+    };
+
+    explicit json_reader(std::istream& in);
+
+    // Reads the next token. Throws std::runtime_error on malformed input.
+    token next();
+
+    // Unescaped text of the last key or string, or the raw text of the
+    // last number or boolean.
+    std::string const& text() const
+    {
+        return text_;
+    }
+
+    double number_value() const;
+
+    // Skips the rest of the value whose first token was just returned, so
+    // after begin_object or begin_array everything up to and including
+    // the matching end is consumed.
+    void skip_value(token first);
+
+private:
+
+    int peek();
+    int get();
+    void skip_whitespace();
+    void read_string();
+    void read_literal();
+    void value_done();
+    void append_utf8(unsigned code_point);
+    unsigned read_hex4();
+
+    [[noreturn]] void fail(char const* what) const;
+
+    struct frame
+    {
+        bool is_object;
+        bool expect_key;
+    };
+
+    std::istream& in_;
+    std::vector<char> buffer_;
+    std::size_t pos_;
+    std::size_t end_;
+    std::size_t offset_;
+    std::vector<frame> stack_;
+    std::string text_;
+};
+
+#endif // CPPSIZE_PARSE_JSONREADER_HPP_
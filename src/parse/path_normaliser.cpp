@@ -0,0 +1,238 @@
+// *****************************************************************************
+//
+// parse/path_normaliser.cpp
+//
+// Canonical names for the headers in a log.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "parse/path_normaliser.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+bool is_drive_letter(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+std::uint64_t fnv1a(std::uint64_t hash, std::string const& bytes)
+{
+    for(char c : bytes)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+
+    // Keeps "ab" + "c" apart from "a" + "bc".
+    hash ^= 0xff;
+    hash *= 1099511628211ull;
+    return hash;
+}
+
+// Drops "." and empty segments and collapses "..". path only has '/'
+// separators. A drive and leading slashes are kept as they are, and ".."
+// can't climb above them.
+std::string collapse_dots(std::string const& path)
+{
+    std::size_t root_end = 0;
+    if(path.size() >= 2 && path[1] == ':' && is_drive_letter(path[0]))
+        root_end = 2;
+
+    // Two leading slashes are a UNC share, more than that is one too many.
+    std::size_t slashes = 0;
+    while(root_end + slashes < path.size() && path[root_end + slashes] == '/')
+        ++slashes;
+
+    root_end += std::min<std::size_t>(slashes, root_end == 0 ? 2 : 1);
+    bool absolute = root_end > 0 && path[root_end - 1] == '/';
+
+    std::string result = path.substr(0, root_end);
+    result.reserve(path.size());
+
+    // Where each segment that ".." can remove starts in result, including
+    // the separator before it.
+    std::vector<std::size_t> segments;
+    std::size_t pos = root_end;
+    while(pos <= path.size())
+    {
+        std::size_t end = path.find('/', pos);
+        if(end == std::string::npos)
+            end = path.size();
+
+        std::size_t length = end - pos;
+        if(length == 0 || (length == 1 && path[pos] == '.'))
+        {
+            // Nothing to add.
+        }
+        else if(length == 2 && path[pos] == '.' && path[pos + 1] == '.')
+        {
+            if(!segments.empty())
+            {
+                result.resize(segments.back());
+                segments.pop_back();
+            }
+            else if(!absolute)
+            {
+                if(result.size() > root_end)
+                    result += '/';
+                result += "..";
+            }
+        }
+        else
+        {
+            segments.push_back(result.size());
+            if(result.size() > root_end)
+                result += '/';
+            result.append(path, pos, length);
+        }
+
+        pos = end + 1;
+    }
+
+    if(result.empty())
+        result = ".";
+
+    return result;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+//
+path_normaliser::path_normaliser()
+    : case_folding_(case_folding::windows_paths)
+{}
+
+// -----------------------------------------------------------------------------
+//
+void path_normaliser::set_case_folding(case_folding folding)
+{
+    case_folding_ = folding;
+}
+
+// -----------------------------------------------------------------------------
+//
+void path_normaliser::add_root(std::string const& from, std::string const& to)
+{
+    std::string root = canonical(from.data(), from.data() + from.size());
+    std::string renamed = to;
+    while(renamed.size() > 1 && (renamed.back() == '/' || renamed.back() == '\\'))
+        renamed.pop_back();
+
+    roots_.emplace_back(std::move(root), std::move(renamed));
+    std::stable_sort(
+        roots_.begin(),
+        roots_.end(),
+        [](std::pair<std::string, std::string> const& a, std::pair<std::string, std::string> const& b)
+        {
+            return a.first.size() > b.first.size();
+        }
+    );
+}
+
+// -----------------------------------------------------------------------------
+//
+void path_normaliser::add_root(std::string const& mapping)
+{
+    std::size_t equals = mapping.find('=');
+    if(equals == std::string::npos || equals == 0)
+        throw std::runtime_error("Root mapping \"" + mapping + "\" isn't of the form from=to");
+
+    add_root(mapping.substr(0, equals), mapping.substr(equals + 1));
+}
+
+// -----------------------------------------------------------------------------
+//
+std::string path_normaliser::operator()(char const* first, char const* last) const
+{
+    std::string name = canonical(first, last);
+    for(auto&& root : roots_)
+    {
+        std::string const& from = root.first;
+        if(name.compare(0, from.size(), from) != 0)
+            continue;
+
+        // Only whole segments match, so /usr/include doesn't take
+        // /usr/include2 with it.
+        if(name.size() != from.size() && from.back() != '/' && name[from.size()] != '/')
+            continue;
+
+        std::size_t rest = from.back() == '/' ? from.size() - 1 : from.size();
+        return root.second + name.substr(rest);
+    }
+
+    return name;
+}
+
+// -----------------------------------------------------------------------------
+//
+std::string path_normaliser::operator()(std::string const& name) const
+{
+    return (*this)(name.data(), name.data() + name.size());
+}
+
+// -----------------------------------------------------------------------------
+//
+std::uint64_t path_normaliser::fingerprint() const
+{
+    std::uint64_t hash = 14695981039346656037ull;
+    hash = fnv1a(hash, std::to_string(static_cast<int>(case_folding_)));
+    for(auto&& root : roots_)
+    {
+        hash = fnv1a(hash, root.first);
+        hash = fnv1a(hash, root.second);
+    }
+
+    return hash;
+}
+
+// -----------------------------------------------------------------------------
+//
+std::string path_normaliser::canonical(char const* first, char const* last) const
+{
+    std::string path(first, last);
+    bool windows = path.size() >= 2 && path[1] == ':' && is_drive_letter(path[0]);
+    for(char& c : path)
+    {
+        if(c == '\\')
+        {
+            c = '/';
+            windows = true;
+        }
+    }
+
+    if(case_folding_ == case_folding::always ||
+       (case_folding_ == case_folding::windows_paths && windows))
+    {
+        for(char& c : path)
+        {
+            if(c >= 'A' && c <= 'Z')
+                c = static_cast<char>(c - 'A' + 'a');
+        }
+    }
+
+    return collapse_dots(path);
+}
+
+// -----------------------------------------------------------------------------
+//
+path_normaliser::case_folding parse_case_folding(std::string const& name)
+{
+    if(name == "auto")
+        return path_normaliser::case_folding::windows_paths;
+    if(name == "always")
+        return path_normaliser::case_folding::always;
+    if(name == "never")
+        return path_normaliser::case_folding::never;
+
+    throw std::runtime_error("Unknown case folding \"" + name + "\", expected auto, always or never");
+}
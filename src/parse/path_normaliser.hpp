@@ -0,0 +1,75 @@
+// *****************************************************************************
+//
+// parse/path_normaliser.hpp
+//
+// Canonical names for the headers in a log, so the same header spelled
+// with different separators, case or ".." segments is one vertex. msvc
+// and gcc logs of the same build can then be merged, and install roots
+// can be renamed so logs from different machines line up.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_PARSE_PATHNORMALISER_HPP_
+#define CPPSIZE_PARSE_PATHNORMALISER_HPP_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+// Separators become '/', "." and empty segments are dropped and ".." is
+// collapsed against the segment before it. Case is folded to lower case
+// for paths that look like windows paths, ones with a drive letter or a
+// backslash, since those name the same file whatever the case. Names
+// under a mapped root then have that root replaced.
+class path_normaliser
+{
+public:
+
+    enum class case_folding
+    {
+        windows_paths,
+        always,
+        never,
+    };
+
+    path_normaliser();
+
+    void set_case_folding(case_folding folding);
+
+    // Names under from are renamed to start with to instead, such as
+    // C:/msys64/mingw64 to <toolchain>. from is normalised the same way
+    // as names and the longest matching root wins.
+    void add_root(std::string const& from, std::string const& to);
+
+    // Takes a root mapping written as from=to. Throws std::runtime_error
+    // if there's no '='.
+    void add_root(std::string const& mapping);
+
+    std::string operator()(char const* first, char const* last) const;
+    std::string operator()(std::string const& name) const;
+
+    // Differs for normalisers that can name a header differently, so
+    // anything cached under one isn't used with another.
+    std::uint64_t fingerprint() const;
+
+private:
+
+    std::string canonical(char const* first, char const* last) const;
+
+    case_folding case_folding_;
+    std::vector<std::pair<std::string, std::string>> roots_;
+};
+
+// Parses auto, always or never. Throws std::runtime_error for anything
+// else.
+path_normaliser::case_folding parse_case_folding(std::string const& name);
+
+#endif // CPPSIZE_PARSE_PATHNORMALISER_HPP_
@@ -0,0 +1,332 @@
+// *****************************************************************************
+//
+// parse/time_trace.cpp
+//
+// Reads per header frontend time from compiler timing output.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "parse/time_trace.hpp"
+#include "parse/compile_commands.hpp"
+#include "parse/json_reader.hpp"
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+struct trace_event
+{
+    trace_event()
+        : ts(0)
+        , dur(0)
+    {}
+
+    std::string name;
+    std::string ph;
+    std::string detail;
+    double ts;
+    double dur;
+};
+
+// -----------------------------------------------------------------------------
+//
+// Reads one event object, having already consumed its begin_object.
+trace_event read_event(json_reader& json)
+{
+    trace_event event;
+    for(json_reader::token t = json.next(); t != json_reader::end_object; t = json.next())
+    {
+        if(t != json_reader::key)
+            throw std::runtime_error("Malformed trace event");
+
+        std::string key = json.text();
+        json_reader::token value = json.next();
+        if(key == "name" && value == json_reader::string)
+            event.name = json.text();
+        else if(key == "ph" && value == json_reader::string)
+            event.ph = json.text();
+        else if(key == "ts" && value == json_reader::number)
+            event.ts = json.number_value();
+        else if(key == "dur" && value == json_reader::number)
+            event.dur = json.number_value();
+        else if(key == "args" && value == json_reader::begin_object)
+        {
+            for(t = json.next(); t != json_reader::end_object; t = json.next())
+            {
+                std::string arg = json.text();
+                json_reader::token arg_value = json.next();
+                if(arg == "detail" && arg_value == json_reader::string)
+                    event.detail = json.text();
+                else
+                    json.skip_value(arg_value);
+            }
+        }
+        else
+            json.skip_value(value);
+    }
+
+    return event;
+}
+
+// -----------------------------------------------------------------------------
+//
+void read_events(json_reader& json, time_report& report)
+{
+    double compile_seconds = 0;
+    double first_ts = std::numeric_limits<double>::max();
+    double last_ts = 0;
+    for(json_reader::token t = json.next(); t != json_reader::end_array; t = json.next())
+    {
+        if(t != json_reader::begin_object)
+        {
+            json.skip_value(t);
+            continue;
+        }
+
+        trace_event event = read_event(json);
+        if(event.ph != "X")
+            continue;
+
+        // Times are in microseconds. Source events nest, so each
+        // one already includes whatever the header included.
+        double seconds = event.dur / 1e6;
+        if(event.name == "Source" && !event.detail.empty())
+            report.header_seconds[event.detail] += seconds;
+        else if(event.name == "ExecuteCompiler")
+            compile_seconds = std::max(compile_seconds, seconds);
+
+        first_ts = std::min(first_ts, event.ts);
+        last_ts = std::max(last_ts, event.ts + event.dur);
+    }
+
+    if(compile_seconds == 0 && last_ts > first_ts)
+        compile_seconds = (last_ts - first_ts) / 1e6;
+
+    report.total_seconds += compile_seconds;
+}
+
+// -----------------------------------------------------------------------------
+//
+char const* find_line_end(char const* first, char const* last)
+{
+    char const* nl = static_cast<char const*>(std::memchr(first, '\n', last - first));
+    return nl ? nl : last;
+}
+
+// -----------------------------------------------------------------------------
+//
+// Parses "<name>: <seconds>s". Returns false if the line isn't one.
+bool parse_timed_line(char const* first, char const* last, std::string& name, double& seconds)
+{
+    while(last != first && (last[-1] == '\r' || last[-1] == ' '))
+        --last;
+
+    if(last == first || last[-1] != 's')
+        return false;
+
+    // Search from the end, drive letters have colons too.
+    char const* sep = last - 1;
+    while(sep != first && !(sep[0] == ':' && sep + 1 != last && sep[1] == ' '))
+        --sep;
+
+    if(sep == first)
+        return false;
+
+    std::string number(sep + 2, last - 1);
+    char* end = nullptr;
+    seconds = std::strtod(number.c_str(), &end);
+    if(number.empty() || *end != 0)
+        return false;
+
+    name.assign(first, sep);
+    return true;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+//
+void time_report::merge(time_report const& other)
+{
+    total_seconds += other.total_seconds;
+    for(auto&& h : other.header_seconds)
+    {
+        header_seconds[h.first] += h.second;
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+time_report read_clang_time_trace(std::istream& in)
+{
+    time_report report;
+    json_reader json(in);
+
+    // Traces are either {"traceEvents": [...], ...} or a bare event array.
+    json_reader::token t = json.next();
+    if(t == json_reader::begin_array)
+    {
+        read_events(json, report);
+        return report;
+    }
+
+    if(t != json_reader::begin_object)
+        throw std::runtime_error("Not a time trace");
+
+    for(t = json.next(); t != json_reader::end_object; t = json.next())
+    {
+        bool events = json.text() == "traceEvents";
+        json_reader::token value = json.next();
+        if(events && value == json_reader::begin_array)
+            read_events(json, report);
+        else
+            json.skip_value(value);
+    }
+
+    return report;
+}
+
+// -----------------------------------------------------------------------------
+//
+time_report read_msvc_time_report(char const* first, char const* last)
+{
+    static char const kSection[] = "Include Headers:";
+    std::size_t const section_size = sizeof(kSection) - 1;
+
+    time_report report;
+    char const* pos = first;
+    for(;;)
+    {
+        pos = std::search(pos, last, kSection, kSection + section_size);
+        if(pos == last)
+            break;
+
+        pos = find_line_end(pos, last);
+
+        // Headers follow, indented one tab per level below the
+        // "Count:" line. The section ends at the first line that
+        // isn't indented.
+        int top_depth = -1;
+        while(pos != last)
+        {
+            char const* line = pos + 1;
+            char const* line_end = find_line_end(line, last);
+            if(line == last || *line != '\t')
+            {
+                pos = line;
+                break;
+            }
+
+            pos = line_end;
+
+            int depth = 0;
+            while(line != line_end && *line == '\t')
+            {
+                ++line;
+                ++depth;
+            }
+
+            std::string name;
+            double seconds = 0;
+            if(!parse_timed_line(line, line_end, name, seconds))
+                continue;
+
+            report.header_seconds[name] += seconds;
+            if(top_depth < 0)
+                top_depth = depth;
+            if(depth == top_depth)
+                report.total_seconds += seconds;
+        }
+    }
+
+    return report;
+}
+
+// -----------------------------------------------------------------------------
+//
+bool is_time_trace_filename(std::string const& filename)
+{
+    // A compilation database is json too, but it's a list of
+    // commands to run rather than timings.
+    return boost::filesystem::path(filename).extension() == ".json"
+        && !is_compile_commands_filename(filename);
+}
+
+// -----------------------------------------------------------------------------
+//
+time_report read_time_report(std::string const& filename)
+{
+    if(is_time_trace_filename(filename))
+    {
+        std::ifstream in(filename, std::ios::binary);
+        if(!in)
+            throw std::runtime_error("Failed to open \"" + filename + "\"");
+
+        return read_clang_time_trace(in);
+    }
+
+    boost::system::error_code ec;
+    if(boost::filesystem::file_size(filename, ec) == 0 || ec)
+        return time_report();
+
+    boost::iostreams::mapped_file_source file;
+    try
+    {
+        file.open(filename);
+    }
+    catch(std::exception& e)
+    {
+        throw std::runtime_error("Failed to map \"" + filename + "\": " + e.what());
+    }
+
+    return read_msvc_time_report(file.data(), file.data() + file.size());
+}
+
+// -----------------------------------------------------------------------------
+//
+std::vector<double> attach_header_times(
+    time_report const& report,
+    cpp_dep::include_graph_t const& g,
+    path_normaliser const& normaliser)
+{
+    // Two spellings of one header can both have been timed.
+    std::unordered_map<std::string, double> header_seconds;
+    for(auto&& header : report.header_seconds)
+        header_seconds[normaliser(header.first)] += header.second;
+
+    std::vector<double> seconds(boost::num_vertices(g), 0);
+    std::vector<bool> included(boost::num_vertices(g), false);
+    for(auto v : boost::make_iterator_range(boost::vertices(g)))
+    {
+        for(auto child : boost::make_iterator_range(boost::adjacent_vertices(v, g)))
+        {
+            included[child] = true;
+        }
+
+        auto i = header_seconds.find(g[v].name);
+        if(i != header_seconds.end())
+            seconds[v] = i->second;
+    }
+
+    for(auto v : boost::make_iterator_range(boost::vertices(g)))
+    {
+        if(!included[v])
+            seconds[v] = std::max(seconds[v], report.total_seconds);
+    }
+
+    return seconds;
+}
@@ -0,0 +1,69 @@
+// *****************************************************************************
+//
+// parse/time_trace.hpp
+//
+// Reads per header frontend time from clang's -ftime-trace JSON and from
+// the "Include Headers:" section of msvc's /d1reportTime output, and
+// attaches it to the vertices of an include graph.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_PARSE_TIMETRACE_HPP_
+#define CPPSIZE_PARSE_TIMETRACE_HPP_
+
+#include "cpp_dep/cpp_dep.hpp"
+#include "parse/path_normaliser.hpp"
+#include <istream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+struct time_report
+{
+    time_report()
+        : total_seconds(0)
+    {}
+
+    // Wall time of every translation unit in the report.
+    double total_seconds;
+
+    // Time spent in each header including everything it includes, summed
+    // over every time it was entered. Keyed by the name the compiler used.
+    std::unordered_map<std::string, double> header_seconds;
+
+    void merge(time_report const& other);
+};
+
+// Streams a clang -ftime-trace file. Throws std::runtime_error if it isn't
+// valid JSON.
+time_report read_clang_time_trace(std::istream& in);
+
+// Collects every "Include Headers:" section in msvc /d1reportTime output.
+// Anything else in the text is ignored, so this can be run over a whole
+// build log. Returns an empty report if there are no such sections.
+time_report read_msvc_time_report(char const* first, char const* last);
+
+// True if filename looks like a clang time trace rather than a log.
+bool is_time_trace_filename(std::string const& filename);
+
+// Reads filename as a clang trace if it's JSON, otherwise scans it for
+// msvc timings. Throws std::runtime_error if it can't be read.
+time_report read_time_report(std::string const& filename);
+
+// Time for every vertex of g, in seconds, matched by name once the
+// report's names are normalised the same way as g's. Vertices nothing
+// includes get the report's total so percentages can be taken against
+// them. Vertices with no timing are 0.
+std::vector<double> attach_header_times(
+    time_report const& report,
+    cpp_dep::include_graph_t const& g,
+    path_normaliser const& normaliser = path_normaliser());
+
+#endif // CPPSIZE_PARSE_TIMETRACE_HPP_
@@ -0,0 +1,101 @@
+// *****************************************************************************
+//
+// report/aggregate_report.cpp
+//
+// Writes the headers of an include_aggregate ranked by project wide cost.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "report/aggregate_report.hpp"
+#include "analysis/include_aggregate.hpp"
+#include <boost/range/iterator_range.hpp>
+#include <algorithm>
+#include <ostream>
+
+// -----------------------------------------------------------------------------
+//
+void write_aggregate_report(
+    std::ostream& out,
+    include_aggregate const& aggregate,
+    report_format format,
+    std::size_t limit)
+{
+    cpp_dep::include_graph_t const& g = aggregate.graph();
+    std::vector<aggregate_header_stats> const& stats = aggregate.stats();
+
+    // Logs and translation units aren't headers anything could stop
+    // including.
+    std::vector<cpp_dep::include_vertex_descriptor_t> order;
+    for(auto v : boost::make_iterator_range(boost::vertices(g)))
+    {
+        if(boost::in_degree(v, g) != 0)
+            order.push_back(v);
+    }
+
+    std::stable_sort(
+        order.begin(),
+        order.end(),
+        [&stats](cpp_dep::include_vertex_descriptor_t a, cpp_dep::include_vertex_descriptor_t b)
+        {
+            return stats[a].transitive_size > stats[b].transitive_size;
+        }
+    );
+
+    if(limit != 0 && limit < order.size())
+        order.resize(limit);
+
+    switch(format)
+    {
+    case report_format::text:
+        out << aggregate.num_translation_units() << " translation units\n";
+        for(auto v : order)
+        {
+            aggregate_header_stats const& s = stats[v];
+            out << g[v].name
+                << "  " << (s.transitive_size + 1023) / 1024 << "kb"
+                << "  parsed=" << (s.bytes_parsed + 1023) / 1024 << "kb"
+                << "  tus=" << s.num_translation_units
+                << '\n';
+        }
+        break;
+
+    case report_format::json:
+        out << "{\"translation_units\":" << aggregate.num_translation_units()
+            << ",\"headers\":[";
+        for(std::size_t i = 0; i < order.size(); ++i)
+        {
+            auto v = order[i];
+            aggregate_header_stats const& s = stats[v];
+            out << (i ? "," : "") << "\n{\"file\":";
+            write_json_string(out, g[v].name);
+            out << ",\"size\":" << g[v].size
+                << ",\"translation_units\":" << s.num_translation_units
+                << ",\"bytes_parsed\":" << s.bytes_parsed
+                << ",\"transitive_size\":" << s.transitive_size
+                << '}';
+        }
+        out << "\n]}\n";
+        break;
+
+    case report_format::csv:
+        out << "file,size,translation_units,bytes_parsed,transitive_size\n";
+        for(auto v : order)
+        {
+            aggregate_header_stats const& s = stats[v];
+            write_csv_string(out, g[v].name);
+            out << ',' << g[v].size
+                << ',' << s.num_translation_units
+                << ',' << s.bytes_parsed
+                << ',' << s.transitive_size
+                << '\n';
+        }
+        break;
+    }
+
+    out.flush();
+}
@@ -0,0 +1,30 @@
+// *****************************************************************************
+//
+// report/aggregate_report.hpp
+//
+// Writes the headers of an include_aggregate ranked by project wide cost.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_REPORT_AGGREGATEREPORT_HPP_
+#define CPPSIZE_REPORT_AGGREGATEREPORT_HPP_
+
+#include "report/report_format.hpp"
+#include <iosfwd>
+
+class include_aggregate;
+
+// Writes every header sorted by summed transitive size, most expensive
+// first. A limit of 0 writes them all.
+void write_aggregate_report(
+    std::ostream& out,
+    include_aggregate const& aggregate,
+    report_format format,
+    std::size_t limit = 0);
+
+#endif // CPPSIZE_REPORT_AGGREGATEREPORT_HPP_
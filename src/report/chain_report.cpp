@@ -0,0 +1,118 @@
+// *****************************************************************************
+//
+// report/chain_report.cpp
+//
+// Writes the include chains found by include_chain_index.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "report/chain_report.hpp"
+#include <boost/range/iterator_range.hpp>
+#include <ostream>
+
+// -----------------------------------------------------------------------------
+//
+std::vector<cpp_dep::include_vertex_descriptor_t> find_headers(
+    cpp_dep::include_graph_t const& g,
+    std::string const& name)
+{
+    std::vector<cpp_dep::include_vertex_descriptor_t> found;
+    for(auto v : boost::make_iterator_range(boost::vertices(g)))
+    {
+        std::string const& file = g[v].name;
+        if(file == name)
+        {
+            found.push_back(v);
+        }
+        else if(file.size() > name.size() &&
+                file[file.size() - name.size() - 1] == '/' &&
+                file.compare(file.size() - name.size(), name.size(), name) == 0)
+        {
+            found.push_back(v);
+        }
+    }
+
+    return found;
+}
+
+// -----------------------------------------------------------------------------
+//
+void write_chain_report(
+    std::ostream& out,
+    cpp_dep::include_graph_t const& g,
+    std::vector<chain_query_result> const& results,
+    report_format format)
+{
+    switch(format)
+    {
+    case report_format::text:
+        for(auto&& result : results)
+        {
+            out << g[result.header].name << '\n';
+            if(result.chains.empty())
+                out << "  not included from any translation unit\n";
+
+            for(std::size_t i = 0; i < result.chains.size(); ++i)
+            {
+                include_chain const& chain = result.chains[i];
+                out << "  " << i + 1 << ". " << chain.files.size() - 1 << " includes, "
+                    << (chain.bytes + 1023) / 1024 << "kb\n";
+
+                for(std::size_t j = 0; j < chain.files.size(); ++j)
+                    out << "    " << std::string(j, '.') << (j ? " " : "") << g[chain.files[j]].name << '\n';
+            }
+        }
+        break;
+
+    case report_format::json:
+        out << '[';
+        for(std::size_t r = 0; r < results.size(); ++r)
+        {
+            out << (r ? "," : "") << "\n{\"file\":";
+            write_json_string(out, g[results[r].header].name);
+            out << ",\"chains\":[";
+            for(std::size_t i = 0; i < results[r].chains.size(); ++i)
+            {
+                include_chain const& chain = results[r].chains[i];
+                out << (i ? "," : "") << "\n{\"bytes\":" << chain.bytes << ",\"files\":[";
+                for(std::size_t j = 0; j < chain.files.size(); ++j)
+                {
+                    out << (j ? "," : "");
+                    write_json_string(out, g[chain.files[j]].name);
+                }
+                out << "]}";
+            }
+            out << "]}";
+        }
+        out << "\n]\n";
+        break;
+
+    case report_format::csv:
+        out << "file,chain,depth,bytes,step\n";
+        for(auto&& result : results)
+        {
+            for(std::size_t i = 0; i < result.chains.size(); ++i)
+            {
+                include_chain const& chain = result.chains[i];
+                for(std::size_t j = 0; j < chain.files.size(); ++j)
+                {
+                    write_csv_string(out, g[result.header].name);
+                    out << ',' << i + 1
+                        << ',' << j
+                        << ',' << chain.bytes
+                        << ',';
+                    write_csv_string(out, g[chain.files[j]].name);
+                    out << '\n';
+                }
+            }
+        }
+        break;
+    }
+
+    out.flush();
+}
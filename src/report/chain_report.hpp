@@ -0,0 +1,44 @@
+// *****************************************************************************
+//
+// report/chain_report.hpp
+//
+// Writes the include chains found by include_chain_index.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_REPORT_CHAINREPORT_HPP_
+#define CPPSIZE_REPORT_CHAINREPORT_HPP_
+
+#include "analysis/include_chains.hpp"
+#include "report/report_format.hpp"
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+struct chain_query_result
+{
+    cpp_dep::include_vertex_descriptor_t header;
+    std::vector<include_chain> chains;
+};
+
+// Vertices named name, or with a name ending in '/' followed by name, so
+// a header can be asked about without its full path.
+std::vector<cpp_dep::include_vertex_descriptor_t> find_headers(
+    cpp_dep::include_graph_t const& g,
+    std::string const& name);
+
+// Writes the chains for each header, with the names from g.
+void write_chain_report(
+    std::ostream& out,
+    cpp_dep::include_graph_t const& g,
+    std::vector<chain_query_result> const& results,
+    report_format format);
+
+#endif // CPPSIZE_REPORT_CHAINREPORT_HPP_
@@ -0,0 +1,161 @@
+// *****************************************************************************
+//
+// report/diff_report.cpp
+//
+// Writes a graph_diff as text, JSON or CSV.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "report/diff_report.hpp"
+#include "analysis/graph_diff.hpp"
+#include <algorithm>
+#include <ostream>
+#include <string>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+char const* state_name(header_diff::state_t state)
+{
+    switch(state)
+    {
+    case header_diff::added:   return "added";
+    case header_diff::removed: return "removed";
+    case header_diff::changed: break;
+    }
+
+    return "changed";
+}
+
+std::string format_delta(std::int64_t delta)
+{
+    std::int64_t magnitude = delta < 0 ? -delta : delta;
+    return (delta < 0 ? "-" : "+") + std::to_string((magnitude + 1023) / 1024) + "kb";
+}
+
+std::size_t limited(std::size_t count, std::size_t limit)
+{
+    return limit == 0 ? count : std::min(count, limit);
+}
+
+void write_json_edges(
+    std::ostream& out,
+    std::vector<include_edge_diff> const& edges,
+    std::size_t limit)
+{
+    out << '[';
+    for(std::size_t i = 0; i < limited(edges.size(), limit); ++i)
+    {
+        out << (i ? "," : "") << "\n{\"includer\":";
+        write_json_string(out, edges[i].includer);
+        out << ",\"included\":";
+        write_json_string(out, edges[i].included);
+        out << ",\"cost\":" << edges[i].cost << '}';
+    }
+    out << "\n]";
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+//
+void write_diff_report(
+    std::ostream& out,
+    graph_diff const& diff,
+    report_format format,
+    std::size_t limit)
+{
+    std::size_t num_headers = limited(diff.headers.size(), limit);
+
+    switch(format)
+    {
+    case report_format::text:
+        out << diff.headers.size() << " headers changed, "
+            << format_delta(diff.total_delta) << " in total\n";
+        for(std::size_t i = 0; i < num_headers; ++i)
+        {
+            header_diff const& h = diff.headers[i];
+            out << format_delta(h.delta()) << "  " << h.name
+                << "  " << (h.cost_before + 1023) / 1024 << "kb -> "
+                << (h.cost_after + 1023) / 1024 << "kb";
+            if(h.state != header_diff::changed)
+                out << "  (" << state_name(h.state) << ')';
+            out << '\n';
+
+            for(auto e : h.new_includers)
+                out << "    new include from " << diff.added_edges[e].includer << '\n';
+        }
+
+        if(!diff.added_edges.empty())
+        {
+            out << "\nnew includes\n";
+            for(std::size_t i = 0; i < limited(diff.added_edges.size(), limit); ++i)
+            {
+                include_edge_diff const& e = diff.added_edges[i];
+                out << "  " << e.includer << " -> " << e.included
+                    << "  " << (e.cost + 1023) / 1024 << "kb\n";
+            }
+        }
+
+        if(!diff.removed_edges.empty())
+        {
+            out << "\nremoved includes\n";
+            for(std::size_t i = 0; i < limited(diff.removed_edges.size(), limit); ++i)
+            {
+                include_edge_diff const& e = diff.removed_edges[i];
+                out << "  " << e.includer << " -> " << e.included
+                    << "  " << (e.cost + 1023) / 1024 << "kb\n";
+            }
+        }
+        break;
+
+    case report_format::json:
+        out << "{\"total_delta\":" << diff.total_delta
+            << ",\"headers\":[";
+        for(std::size_t i = 0; i < num_headers; ++i)
+        {
+            header_diff const& h = diff.headers[i];
+            out << (i ? "," : "") << "\n{\"file\":";
+            write_json_string(out, h.name);
+            out << ",\"state\":\"" << state_name(h.state) << '"'
+                << ",\"before\":" << h.cost_before
+                << ",\"after\":" << h.cost_after
+                << ",\"delta\":" << h.delta()
+                << ",\"new_includers\":[";
+            for(std::size_t j = 0; j < h.new_includers.size(); ++j)
+            {
+                out << (j ? "," : "");
+                write_json_string(out, diff.added_edges[h.new_includers[j]].includer);
+            }
+            out << "]}";
+        }
+        out << "\n],\"added_includes\":";
+        write_json_edges(out, diff.added_edges, limit);
+        out << ",\"removed_includes\":";
+        write_json_edges(out, diff.removed_edges, limit);
+        out << "}\n";
+        break;
+
+    case report_format::csv:
+        out << "file,state,before,after,delta\n";
+        for(std::size_t i = 0; i < num_headers; ++i)
+        {
+            header_diff const& h = diff.headers[i];
+            write_csv_string(out, h.name);
+            out << ',' << state_name(h.state)
+                << ',' << h.cost_before
+                << ',' << h.cost_after
+                << ',' << h.delta()
+                << '\n';
+        }
+        break;
+    }
+
+    out.flush();
+}
@@ -0,0 +1,30 @@
+// *****************************************************************************
+//
+// report/diff_report.hpp
+//
+// Writes a graph_diff as text, JSON or CSV.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_REPORT_DIFFREPORT_HPP_
+#define CPPSIZE_REPORT_DIFFREPORT_HPP_
+
+#include "report/report_format.hpp"
+#include <iosfwd>
+
+struct graph_diff;
+
+// Writes the changed headers, largest change first, each with the new
+// includes of it. A limit of 0 writes every changed header and include.
+void write_diff_report(
+    std::ostream& out,
+    graph_diff const& diff,
+    report_format format,
+    std::size_t limit = 0);
+
+#endif // CPPSIZE_REPORT_DIFFREPORT_HPP_
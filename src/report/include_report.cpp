@@ -0,0 +1,218 @@
+// *****************************************************************************
+//
+// report/include_report.cpp
+//
+// Qt free equivalent of tree_view_builder.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "report/include_report.hpp"
+#include "cpp_dep/inferred_include_visitor.hpp"
+#include <ostream>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+class include_report_builder
+    : private cpp_dep::inferred_include_visitor<include_report_builder>
+{
+public:
+
+    include_report_builder(std::vector<include_report_row>& rows)
+        : rows_(rows)
+        , current_depth_(0)
+        , current_order_(0)
+        , total_size_(0)
+    {}
+
+    void operator()(cpp_dep::include_graph_t const& g)
+    {
+        current_depth_ = 0;
+        current_order_ = 0;
+        total_size_ = 0;
+
+        this->visit(g);
+    }
+
+private:
+
+    friend class cpp_dep::inferred_include_visitor<include_report_builder>;
+
+    void root_file(cpp_dep::include_vertex_descriptor_t const& v, cpp_dep::include_graph_t const& g)
+    {
+        cpp_dep::include_vertex_t const& file = g[v];
+
+        total_size_ = file.size + file.size_dependencies;
+        current_depth_ = 0;
+        add_row(v, g);
+        ++current_depth_;
+    }
+
+    void include_file(cpp_dep::include_vertex_descriptor_t const& v, cpp_dep::include_graph_t const& g)
+    {
+        add_row(v, g);
+        ++current_depth_;
+    }
+
+    void finish_file(cpp_dep::include_vertex_descriptor_t const&, cpp_dep::include_graph_t const&)
+    {
+        if(current_depth_ > 0)
+            --current_depth_;
+    }
+
+    void add_row(cpp_dep::include_vertex_descriptor_t const& v, cpp_dep::include_graph_t const& g)
+    {
+        cpp_dep::include_vertex_t const& file = g[v];
+
+        include_report_row row;
+        row.vertex = v;
+        row.name = &file.name;
+        row.depth = current_depth_;
+        row.order = current_order_++;
+        row.occurence = this->get_include_count(v);
+        row.size = file.size + file.size_dependencies;
+        row.total_size = total_size_;
+        rows_.push_back(row);
+    }
+
+    std::vector<include_report_row>& rows_;
+    int current_depth_;
+    int current_order_;
+    std::size_t total_size_;
+};
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+//
+include_report build_include_report(
+    cpp_dep::include_graph_t const& g, std::string source)
+{
+    include_report report;
+    report.source = std::move(source);
+    report.rows.reserve(boost::num_vertices(g));
+
+    include_report_builder build(report.rows);
+    build(g);
+
+    return report;
+}
+
+// -----------------------------------------------------------------------------
+//
+include_report_writer::include_report_writer(std::ostream& out, report_format format)
+    : out_(out)
+    , format_(format)
+    , num_written_(0)
+{
+    switch(format_)
+    {
+    case report_format::json:
+        out_ << "[\n";
+        break;
+    case report_format::csv:
+        out_ << "source,order,depth,file,size,percent,occurence\n";
+        break;
+    case report_format::text:
+        break;
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+void include_report_writer::write(include_report const& report)
+{
+    switch(format_)
+    {
+    case report_format::text: write_text(report); break;
+    case report_format::json: write_json(report); break;
+    case report_format::csv:  write_csv(report);  break;
+    }
+
+    ++num_written_;
+}
+
+// -----------------------------------------------------------------------------
+//
+void include_report_writer::finish()
+{
+    if(format_ == report_format::json)
+        out_ << "\n]\n";
+
+    out_.flush();
+}
+
+// -----------------------------------------------------------------------------
+//
+void include_report_writer::write_text(include_report const& report)
+{
+    if(num_written_ > 0)
+        out_ << '\n';
+
+    out_ << report.source << '\n';
+    for(auto&& row : report.rows)
+    {
+        out_ << std::string(row.depth * 2, ' ')
+             << *row.name
+             << "  " << (row.size + 1023) / 1024 << "kb"
+             << "  " << row.percent() << '%'
+             << "  order=" << row.order
+             << "  occurence=" << row.occurence
+             << '\n';
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+void include_report_writer::write_json(include_report const& report)
+{
+    if(num_written_ > 0)
+        out_ << ",\n";
+
+    out_ << "{\"source\":";
+    write_json_string(out_, report.source);
+    out_ << ",\"includes\":[";
+
+    bool first = true;
+    for(auto&& row : report.rows)
+    {
+        if(!first)
+            out_ << ',';
+        first = false;
+
+        out_ << "\n{\"file\":";
+        write_json_string(out_, *row.name);
+        out_ << ",\"depth\":" << row.depth
+             << ",\"order\":" << row.order
+             << ",\"size\":" << row.size
+             << ",\"percent\":" << row.percent()
+             << ",\"occurence\":" << row.occurence
+             << '}';
+    }
+
+    out_ << "\n]}";
+}
+
+// -----------------------------------------------------------------------------
+//
+void include_report_writer::write_csv(include_report const& report)
+{
+    for(auto&& row : report.rows)
+    {
+        write_csv_string(out_, report.source);
+        out_ << ',' << row.order
+             << ',' << row.depth
+             << ',';
+        write_csv_string(out_, *row.name);
+        out_ << ',' << row.size
+             << ',' << row.percent()
+             << ',' << row.occurence
+             << '\n';
+    }
+}
@@ -0,0 +1,79 @@
+// *****************************************************************************
+//
+// report/include_report.hpp
+//
+// Qt free equivalent of tree_view_builder. Walks the inferred include tree
+// and records the same size/percent/order/occurence data as flat rows so
+// it can be written out as text, JSON or CSV.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_REPORT_INCLUDEREPORT_HPP_
+#define CPPSIZE_REPORT_INCLUDEREPORT_HPP_
+
+#include "report/report_format.hpp"
+#include "cpp_dep/cpp_dep.hpp"
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+struct include_report_row
+{
+    cpp_dep::include_vertex_descriptor_t vertex;
+    std::string const* name;
+    int depth;
+    int order;
+    int occurence;
+    std::size_t size;
+    std::size_t total_size;
+
+    // Same integer percentage that IncludeTreeModel displays.
+    std::size_t percent() const
+    {
+        return total_size ? (size * 100) / total_size : 0;
+    }
+};
+
+// -----------------------------------------------------------------------------
+//
+struct include_report
+{
+    std::string source;
+    std::vector<include_report_row> rows;
+};
+
+// Rows reference names owned by g, so the graph must outlive the report.
+include_report build_include_report(
+    cpp_dep::include_graph_t const& g, std::string source);
+
+// -----------------------------------------------------------------------------
+//
+class include_report_writer
+{
+public:
+
+    include_report_writer(std::ostream& out, report_format format);
+
+    void write(include_report const& report);
+    void finish();
+
+private:
+
+    void write_text(include_report const& report);
+    void write_json(include_report const& report);
+    void write_csv(include_report const& report);
+
+    std::ostream& out_;
+    report_format format_;
+    int num_written_;
+};
+
+#endif // CPPSIZE_REPORT_INCLUDEREPORT_HPP_
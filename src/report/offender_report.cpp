@@ -0,0 +1,68 @@
+// *****************************************************************************
+//
+// report/offender_report.cpp
+//
+// Writes the headers ranked by top_offenders().
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "report/offender_report.hpp"
+#include <ostream>
+
+// -----------------------------------------------------------------------------
+//
+void write_offender_report(
+    std::ostream& out,
+    cpp_dep::include_graph_t const& g,
+    std::vector<offender> const& offenders,
+    report_format format)
+{
+    switch(format)
+    {
+    case report_format::text:
+        for(std::size_t i = 0; i < offenders.size(); ++i)
+        {
+            offender const& o = offenders[i];
+            out << i + 1 << ". " << g[o.vertex].name
+                << "  " << (o.contribution + 1023) / 1024 << "kb"
+                << "  occurence=" << o.occurence
+                << "  exclusive=" << (o.exclusive + 1023) / 1024 << "kb"
+                << '\n';
+        }
+        break;
+
+    case report_format::json:
+        out << '[';
+        for(std::size_t i = 0; i < offenders.size(); ++i)
+        {
+            offender const& o = offenders[i];
+            out << (i ? "," : "") << "\n{\"file\":";
+            write_json_string(out, g[o.vertex].name);
+            out << ",\"contribution\":" << o.contribution
+                << ",\"occurence\":" << o.occurence
+                << ",\"exclusive\":" << o.exclusive
+                << '}';
+        }
+        out << "\n]\n";
+        break;
+
+    case report_format::csv:
+        out << "file,contribution,occurence,exclusive\n";
+        for(auto&& o : offenders)
+        {
+            write_csv_string(out, g[o.vertex].name);
+            out << ',' << o.contribution
+                << ',' << o.occurence
+                << ',' << o.exclusive
+                << '\n';
+        }
+        break;
+    }
+
+    out.flush();
+}
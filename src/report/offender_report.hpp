@@ -0,0 +1,29 @@
+// *****************************************************************************
+//
+// report/offender_report.hpp
+//
+// Writes the headers ranked by top_offenders().
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_REPORT_OFFENDERREPORT_HPP_
+#define CPPSIZE_REPORT_OFFENDERREPORT_HPP_
+
+#include "analysis/top_offenders.hpp"
+#include "report/report_format.hpp"
+#include <iosfwd>
+#include <vector>
+
+// Writes offenders in the order given, with the names from g.
+void write_offender_report(
+    std::ostream& out,
+    cpp_dep::include_graph_t const& g,
+    std::vector<offender> const& offenders,
+    report_format format);
+
+#endif // CPPSIZE_REPORT_OFFENDERREPORT_HPP_
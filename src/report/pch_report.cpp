@@ -0,0 +1,75 @@
+// *****************************************************************************
+//
+// report/pch_report.cpp
+//
+// Writes the precompiled header picked by recommend_pch().
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "report/pch_report.hpp"
+#include <ostream>
+
+// -----------------------------------------------------------------------------
+//
+void write_pch_report(
+    std::ostream& out,
+    cpp_dep::include_graph_t const& g,
+    pch_recommendation const& pch,
+    report_format format)
+{
+    switch(format)
+    {
+    case report_format::text:
+        for(std::size_t i = 0; i < pch.headers.size(); ++i)
+        {
+            pch_header const& h = pch.headers[i];
+            out << i + 1 << ". " << g[h.vertex].name
+                << "  added=" << (h.added_bytes + 1023) / 1024 << "kb"
+                << "  saved=" << (h.saved_bytes + 1023) / 1024 << "kb"
+                << "  tus=" << h.num_translation_units
+                << '\n';
+        }
+
+        out << "pch: " << (pch.pch_bytes + 1023) / 1024 << "kb"
+            << "  saved: " << (pch.bytes_saved + 1023) / 1024 << "kb"
+            << " of " << (pch.bytes_parsed + 1023) / 1024 << "kb parsed\n";
+        break;
+
+    case report_format::json:
+        out << "{\"pch_bytes\":" << pch.pch_bytes
+            << ",\"bytes_saved\":" << pch.bytes_saved
+            << ",\"bytes_parsed\":" << pch.bytes_parsed
+            << ",\"headers\":[";
+        for(std::size_t i = 0; i < pch.headers.size(); ++i)
+        {
+            pch_header const& h = pch.headers[i];
+            out << (i ? "," : "") << "\n{\"file\":";
+            write_json_string(out, g[h.vertex].name);
+            out << ",\"added\":" << h.added_bytes
+                << ",\"saved\":" << h.saved_bytes
+                << ",\"translation_units\":" << h.num_translation_units
+                << '}';
+        }
+        out << "\n]}\n";
+        break;
+
+    case report_format::csv:
+        out << "file,added,saved,translation_units\n";
+        for(auto&& h : pch.headers)
+        {
+            write_csv_string(out, g[h.vertex].name);
+            out << ',' << h.added_bytes
+                << ',' << h.saved_bytes
+                << ',' << h.num_translation_units
+                << '\n';
+        }
+        break;
+    }
+
+    out.flush();
+}
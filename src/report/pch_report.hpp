@@ -0,0 +1,29 @@
+// *****************************************************************************
+//
+// report/pch_report.hpp
+//
+// Writes the precompiled header picked by recommend_pch().
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_REPORT_PCHREPORT_HPP_
+#define CPPSIZE_REPORT_PCHREPORT_HPP_
+
+#include "analysis/pch_recommender.hpp"
+#include "report/report_format.hpp"
+#include <iosfwd>
+
+// Writes the picked headers in the order they were picked, with the names
+// from g, and the totals.
+void write_pch_report(
+    std::ostream& out,
+    cpp_dep::include_graph_t const& g,
+    pch_recommendation const& pch,
+    report_format format);
+
+#endif // CPPSIZE_REPORT_PCHREPORT_HPP_
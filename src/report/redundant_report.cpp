@@ -0,0 +1,80 @@
+// *****************************************************************************
+//
+// report/redundant_report.cpp
+//
+// Writes the includes found by find_redundant_includes().
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "report/redundant_report.hpp"
+#include <algorithm>
+#include <ostream>
+
+// -----------------------------------------------------------------------------
+//
+void write_redundant_report(
+    std::ostream& out,
+    cpp_dep::include_graph_t const& g,
+    std::vector<redundant_include> const& includes,
+    report_format format,
+    std::size_t limit)
+{
+    std::size_t count = limit ? std::min(limit, includes.size()) : includes.size();
+    switch(format)
+    {
+    case report_format::text:
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            redundant_include const& r = includes[i];
+            out << g[r.includer].name << " -> " << g[r.included].name
+                << "  via " << g[r.via].name
+                << "  " << (r.bytes + 1023) / 1024 << "kb"
+                << "  occurence=" << r.occurence
+                << '\n';
+        }
+
+        out << includes.size() << " redundant includes\n";
+        break;
+
+    case report_format::json:
+        out << '[';
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            redundant_include const& r = includes[i];
+            out << (i ? "," : "") << "\n{\"includer\":";
+            write_json_string(out, g[r.includer].name);
+            out << ",\"included\":";
+            write_json_string(out, g[r.included].name);
+            out << ",\"via\":";
+            write_json_string(out, g[r.via].name);
+            out << ",\"bytes\":" << r.bytes
+                << ",\"occurence\":" << r.occurence
+                << '}';
+        }
+        out << "\n]\n";
+        break;
+
+    case report_format::csv:
+        out << "includer,included,via,bytes,occurence\n";
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            redundant_include const& r = includes[i];
+            write_csv_string(out, g[r.includer].name);
+            out << ',';
+            write_csv_string(out, g[r.included].name);
+            out << ',';
+            write_csv_string(out, g[r.via].name);
+            out << ',' << r.bytes
+                << ',' << r.occurence
+                << '\n';
+        }
+        break;
+    }
+
+    out.flush();
+}
@@ -0,0 +1,31 @@
+// *****************************************************************************
+//
+// report/redundant_report.hpp
+//
+// Writes the includes found by find_redundant_includes().
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_REPORT_REDUNDANTREPORT_HPP_
+#define CPPSIZE_REPORT_REDUNDANTREPORT_HPP_
+
+#include "analysis/redundant_includes.hpp"
+#include "report/report_format.hpp"
+#include <iosfwd>
+#include <vector>
+
+// Writes at most limit includes, all of them if limit is 0, in the order
+// given and with the names from g.
+void write_redundant_report(
+    std::ostream& out,
+    cpp_dep::include_graph_t const& g,
+    std::vector<redundant_include> const& includes,
+    report_format format,
+    std::size_t limit = 0);
+
+#endif // CPPSIZE_REPORT_REDUNDANTREPORT_HPP_
@@ -0,0 +1,645 @@
+// *****************************************************************************
+//
+// report/report_command.cpp
+//
+// Headless command line driver.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "report/report_command.hpp"
+#include "report/aggregate_report.hpp"
+#include "report/chain_report.hpp"
+#include "report/diff_report.hpp"
+#include "report/include_report.hpp"
+#include "report/offender_report.hpp"
+#include "report/pch_report.hpp"
+#include "report/redundant_report.hpp"
+#include "analysis/compile_driver.hpp"
+#include "analysis/graph_diff.hpp"
+#include "analysis/include_chains.hpp"
+#include "analysis/include_aggregate.hpp"
+#include "analysis/dominator_tree.hpp"
+#include "analysis/pch_recommender.hpp"
+#include "analysis/redundant_includes.hpp"
+#include "analysis/top_offenders.hpp"
+#include "parse/compile_commands.hpp"
+#include "parse/graph_snapshot.hpp"
+#include "parse/path_normaliser.hpp"
+#include "cpp_dep/cpp_dep.hpp"
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+// Offenders written if there's no --limit.
+std::size_t const kDefaultOffenders = 25;
+
+// Include chains written per header if there's no --limit.
+std::size_t const kDefaultChains = 10;
+
+struct report_options
+{
+    report_options()
+        : format(report_format::text)
+        , paths(false)
+        , aggregate(false)
+        , offenders(false)
+        , pch(false)
+        , redundant(false)
+        , shortest(false)
+        , rank(offender_rank::contribution)
+        , num_threads(0)
+        , limit(0)
+    {}
+
+    report_format format;
+    bool paths;
+    bool aggregate;
+    bool offenders;
+    bool pch;
+    bool redundant;
+    bool shortest;
+    offender_rank rank;
+    unsigned num_threads;
+    std::size_t limit;
+    std::string output;
+    std::vector<std::string> logs;
+    std::vector<std::string> compile_commands;
+    std::vector<std::string> baselines;
+    std::vector<std::string> why;
+    path_normaliser normaliser;
+    pch_options pch_limits;
+};
+
+// -----------------------------------------------------------------------------
+//
+// Parses the whole number given for option. std::stoul on its own would
+// take a sign, wrapping negative values, and its errors don't say which
+// option was wrong.
+std::size_t parse_count(
+    std::string const& option,
+    std::string const& text,
+    std::size_t max = std::numeric_limits<std::size_t>::max())
+{
+    std::size_t end = 0;
+    unsigned long long count = 0;
+    if(!text.empty() && std::isdigit(static_cast<unsigned char>(text[0])))
+    {
+        try
+        {
+            count = std::stoull(text, &end);
+        }
+        catch(std::exception&)
+        {
+            end = 0;
+        }
+    }
+
+    if(end == 0 || end != text.size() || count > max)
+        throw std::runtime_error("Bad value \"" + text + "\" for " + option + ", expected a whole number");
+
+    return static_cast<std::size_t>(count);
+}
+
+// -----------------------------------------------------------------------------
+//
+// Parses a byte count with an optional k or m suffix, such as 512k.
+std::size_t parse_byte_size(std::string const& option, std::string const& text)
+{
+    std::size_t scale = 1;
+    std::string digits = text;
+    if(!digits.empty())
+    {
+        char suffix = digits.back();
+        if(suffix == 'k' || suffix == 'K')
+            scale = 1024;
+        else if(suffix == 'm' || suffix == 'M')
+            scale = 1024 * 1024;
+
+        if(scale != 1)
+            digits.pop_back();
+    }
+
+    try
+    {
+        return parse_count(option, digits, std::numeric_limits<std::size_t>::max() / scale) * scale;
+    }
+    catch(std::exception&)
+    {
+        throw std::runtime_error(
+            "Bad size \"" + text + "\" for " + option + ", expected bytes with an optional k or m suffix");
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+void print_usage(std::ostream& out)
+{
+    out << "usage: cpp-size --report [options] <log|dir>...\n"
+        << "\n"
+        << "A log of - is read from stdin as it arrives, so a compiler's\n"
+        << "output can be piped straight in:\n"
+        << "  g++ -H -E foo.cpp 2>&1 >/dev/null | cpp-size --report -\n"
+        << "\n"
+        << "options:\n"
+        << "  --format <text|json|csv>  output format (default text)\n"
+        << "  --output <file>           write to file instead of stdout\n"
+        << "  --paths                   report the filesystem tree instead of\n"
+        << "                            the include tree of each log\n"
+        << "  --aggregate               merge every log into one graph and rank\n"
+        << "                            headers by project wide cost\n"
+        << "  --compile-commands <file> run every command in a compilation\n"
+        << "                            database to list its includes, implies\n"
+        << "                            --aggregate\n"
+        << "  --offenders               rank the headers that cost the most,\n"
+        << "                            merging the logs if there are several\n"
+        << "  --rank-by <figure>        contribution, occurence or exclusive\n"
+        << "                            (default contribution)\n"
+        << "  --pch                     pick the headers to precompile,\n"
+        << "                            merging the logs if there are several\n"
+        << "  --pch-budget <size>       most header bytes the pch may hold,\n"
+        << "                            such as 512k or 16m (default 16m)\n"
+        << "  --pch-min-tus <n>         only pick headers included by at\n"
+        << "                            least n translation units (default 2)\n"
+        << "  --redundant               list includes of headers the includer\n"
+        << "                            already gets through another include,\n"
+        << "                            merging the logs if there are several\n"
+        << "  --why <header>            list the biggest chains of includes\n"
+        << "                            that reach header, named in full or\n"
+        << "                            by its trailing path components\n"
+        << "  --shortest                list only the shortest chain with\n"
+        << "                            --why\n"
+        << "  --baseline <log|dir>      compare the logs with these and rank\n"
+        << "                            headers by the change in their cost\n"
+        << "  --map-root <from>=<to>    rename headers under from to start\n"
+        << "                            with to, such as\n"
+        << "                            C:/msys64/mingw64=<toolchain>\n"
+        << "  --fold-case <mode>        auto, always or never. auto folds\n"
+        << "                            windows paths to lower case\n"
+        << "                            (default auto)\n"
+        << "  --threads <n>             parser and compiler threads\n"
+        << "                            (default hardware concurrency)\n"
+        << "  --limit <n>               only write the top n headers\n"
+        << "                            (default 25 with --offenders, 10\n"
+        << "                            chains per header with --why)\n";
+}
+
+// -----------------------------------------------------------------------------
+//
+report_options parse_options(int argc, char* argv[])
+{
+    report_options options;
+
+    auto next_arg = [&](int& i) -> std::string
+    {
+        if(i + 1 >= argc)
+            throw std::runtime_error(std::string("Missing value for ") + argv[i]);
+        return argv[++i];
+    };
+
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if(arg == "--report")
+            continue;
+        else if(arg == "--format")
+            options.format = parse_report_format(next_arg(i));
+        else if(arg == "--output" || arg == "-o")
+            options.output = next_arg(i);
+        else if(arg == "--paths")
+            options.paths = true;
+        else if(arg == "--aggregate")
+            options.aggregate = true;
+        else if(arg == "--compile-commands")
+        {
+            options.compile_commands.push_back(next_arg(i));
+            options.aggregate = true;
+        }
+        else if(arg == "--offenders")
+            options.offenders = true;
+        else if(arg == "--pch")
+            options.pch = true;
+        else if(arg == "--pch-budget")
+            options.pch_limits.budget = parse_byte_size(arg, next_arg(i));
+        else if(arg == "--pch-min-tus")
+            options.pch_limits.min_translation_units = parse_count(arg, next_arg(i));
+        else if(arg == "--redundant")
+            options.redundant = true;
+        else if(arg == "--why")
+            options.why.push_back(next_arg(i));
+        else if(arg == "--shortest")
+            options.shortest = true;
+        else if(arg == "--rank-by")
+            options.rank = parse_offender_rank(next_arg(i));
+        else if(arg == "--baseline")
+            options.baselines.push_back(next_arg(i));
+        else if(arg == "--map-root")
+            options.normaliser.add_root(next_arg(i));
+        else if(arg == "--fold-case")
+            options.normaliser.set_case_folding(parse_case_folding(next_arg(i)));
+        else if(arg == "--threads")
+            options.num_threads = static_cast<unsigned>(
+                parse_count(arg, next_arg(i), std::numeric_limits<unsigned>::max()));
+        else if(arg == "--limit")
+            options.limit = parse_count(arg, next_arg(i));
+        else if(arg.size() > 1 && arg[0] == '-' && arg[1] == '-')
+            throw std::runtime_error("Unknown option \"" + arg + "\"");
+        else
+            options.logs.push_back(arg);
+    }
+
+    if(options.logs.empty() && options.compile_commands.empty())
+        throw std::runtime_error("No include logs specified");
+
+    if(!options.baselines.empty() && !options.compile_commands.empty())
+        throw std::runtime_error("--baseline can't be used with --compile-commands");
+
+    if(!options.baselines.empty() && options.offenders)
+        throw std::runtime_error("--baseline can't be used with --offenders");
+
+    if(!options.baselines.empty() && options.pch)
+        throw std::runtime_error("--baseline can't be used with --pch");
+
+    if(!options.baselines.empty() && options.redundant)
+        throw std::runtime_error("--baseline can't be used with --redundant");
+
+    if(!options.baselines.empty() && !options.why.empty())
+        throw std::runtime_error("--baseline can't be used with --why");
+
+    if(options.shortest && options.why.empty())
+        throw std::runtime_error("--shortest can only be used with --why");
+
+    int analyses =
+        int(options.offenders) + int(options.pch) + int(options.redundant) + int(!options.why.empty());
+    if(analyses > 1)
+        throw std::runtime_error("Only one of --offenders, --pch, --redundant and --why can be used");
+
+    // Only the report of each log on its own has a filesystem tree.
+    if(options.paths && (options.aggregate || !options.baselines.empty() || analyses > 0))
+    {
+        throw std::runtime_error(
+            "--paths can't be used with --aggregate, --compile-commands, --baseline, "
+            "--offenders, --pch, --redundant or --why");
+    }
+
+    options.pch_limits.num_threads = options.num_threads;
+
+    return options;
+}
+
+// -----------------------------------------------------------------------------
+//
+int run_include_report(report_options const& options, std::ostream& out)
+{
+    int result = 0;
+    include_report_writer writer(out, options.format);
+    for(auto&& log : options.logs)
+    {
+        try
+        {
+            std::shared_ptr<graph_snapshot> graphs =
+                load_include_log(log, options.paths, options.num_threads, nullptr, options.normaliser);
+
+            if(options.paths)
+                writer.write(build_include_report(graphs->paths, log));
+            else
+                writer.write(build_include_report(graphs->includes, log));
+        }
+        catch(std::exception& e)
+        {
+            std::cerr << "cpp-size: Failed to load \"" << log << "\"\n"
+                      << "Error: " << e.what() << '\n';
+            result = 1;
+        }
+    }
+
+    writer.finish();
+    return result;
+}
+
+// -----------------------------------------------------------------------------
+//
+// A graph to report on. It lives in either the snapshot or the aggregate.
+struct report_graph
+{
+    std::shared_ptr<graph_snapshot> snapshot;
+    std::shared_ptr<include_aggregate> aggregate;
+
+    cpp_dep::include_graph_t const& graph() const
+    {
+        return aggregate ? aggregate->graph() : snapshot->includes;
+    }
+
+    aggregate_stats_t const* stats() const
+    {
+        return aggregate ? &aggregate->stats() : nullptr;
+    }
+
+    bool failed() const
+    {
+        return aggregate && !aggregate->errors().empty();
+    }
+};
+
+// Loads the first log on its own unless aggregate is set, otherwise merges
+// every log and every compilation database. Logs that fail to merge are
+// reported on stderr.
+report_graph load_report_graph(
+    std::vector<std::string> const& files,
+    std::vector<std::string> const& databases,
+    bool aggregate,
+    report_options const& options)
+{
+    report_graph loaded;
+    if(!aggregate)
+    {
+        loaded.snapshot = load_include_log(
+            files.front(), false, options.num_threads, nullptr, options.normaliser);
+        return loaded;
+    }
+
+    loaded.aggregate = std::make_shared<include_aggregate>(
+        aggregate_deps_files(files, options.num_threads, nullptr, options.normaliser));
+
+    for(auto&& database : databases)
+    {
+        loaded.aggregate->merge(aggregate_compile_commands(
+            read_compile_commands(database),
+            options.num_threads,
+            nullptr,
+            options.normaliser));
+    }
+
+    for(auto&& error : loaded.aggregate->errors())
+    {
+        std::cerr << "cpp-size: Failed to load " << error << '\n';
+    }
+
+    return loaded;
+}
+
+// -----------------------------------------------------------------------------
+//
+// Translation units that include each vertex of the graph, from the
+// aggregate's stats if there are some.
+std::vector<std::size_t> translation_units(report_graph const& loaded)
+{
+    aggregate_stats_t const* stats = loaded.stats();
+    if(!stats)
+        return translation_unit_counts(loaded.graph());
+
+    std::vector<std::size_t> counts;
+    counts.reserve(stats->size());
+    for(auto&& s : *stats)
+        counts.push_back(s.num_translation_units);
+
+    return counts;
+}
+
+// -----------------------------------------------------------------------------
+//
+int run_aggregate_report(report_options const& options, std::ostream& out)
+{
+    report_graph loaded = load_report_graph(
+        expand_log_paths(options.logs), options.compile_commands, true, options);
+
+    write_aggregate_report(out, *loaded.aggregate, options.format, options.limit);
+    return loaded.failed() ? 1 : 0;
+}
+
+// -----------------------------------------------------------------------------
+//
+int run_offender_report(report_options const& options, std::ostream& out)
+{
+    std::vector<std::string> files = expand_log_paths(options.logs);
+    if(files.empty() && options.compile_commands.empty())
+        throw std::runtime_error("No include logs found");
+
+    bool aggregate = options.aggregate || files.size() > 1;
+    report_graph loaded = load_report_graph(files, options.compile_commands, aggregate, options);
+
+    cpp_dep::include_graph_t const& g = loaded.graph();
+    aggregate_stats_t const* stats = loaded.stats();
+    std::vector<int> counts = include_counts(g);
+    std::vector<std::size_t> exclusive = exclusive_sizes(g);
+
+    std::vector<std::size_t> contribution = project_costs(g, stats);
+    std::vector<offender> offenders = top_offenders(
+        boost::num_vertices(g),
+        options.limit ? options.limit : kDefaultOffenders,
+        options.rank,
+        [&](cpp_dep::include_vertex_descriptor_t v, offender& o)
+        {
+            o.contribution = contribution[v];
+            o.occurence = counts[v];
+            o.exclusive = exclusive[v];
+
+            // Translation units aren't included by anything, so can't
+            // be removed and aren't offenders.
+            return counts[v] > 0;
+        },
+        options.num_threads);
+
+    write_offender_report(out, g, offenders, options.format);
+    return loaded.failed() ? 1 : 0;
+}
+
+// -----------------------------------------------------------------------------
+//
+int run_pch_report(report_options const& options, std::ostream& out)
+{
+    std::vector<std::string> files = expand_log_paths(options.logs);
+    if(files.empty() && options.compile_commands.empty())
+        throw std::runtime_error("No include logs found");
+
+    bool aggregate = options.aggregate || files.size() > 1;
+    report_graph loaded = load_report_graph(files, options.compile_commands, aggregate, options);
+
+    cpp_dep::include_graph_t const& g = loaded.graph();
+    write_pch_report(out, g, recommend_pch(g, translation_units(loaded), options.pch_limits), options.format);
+    return loaded.failed() ? 1 : 0;
+}
+
+// -----------------------------------------------------------------------------
+//
+int run_redundant_report(report_options const& options, std::ostream& out)
+{
+    std::vector<std::string> files = expand_log_paths(options.logs);
+    if(files.empty() && options.compile_commands.empty())
+        throw std::runtime_error("No include logs found");
+
+    bool aggregate = options.aggregate || files.size() > 1;
+    report_graph loaded = load_report_graph(files, options.compile_commands, aggregate, options);
+
+    cpp_dep::include_graph_t const& g = loaded.graph();
+    write_redundant_report(
+        out,
+        g,
+        find_redundant_includes(g, translation_units(loaded), options.num_threads),
+        options.format,
+        options.limit);
+
+    return loaded.failed() ? 1 : 0;
+}
+
+// -----------------------------------------------------------------------------
+//
+int run_chain_report(report_options const& options, std::ostream& out)
+{
+    std::vector<std::string> files = expand_log_paths(options.logs);
+    if(files.empty() && options.compile_commands.empty())
+        throw std::runtime_error("No include logs found");
+
+    bool aggregate = options.aggregate || files.size() > 1;
+    report_graph loaded = load_report_graph(files, options.compile_commands, aggregate, options);
+
+    cpp_dep::include_graph_t const& g = loaded.graph();
+    include_chain_index index(g);
+    std::vector<chain_query_result> results;
+    for(auto&& name : options.why)
+    {
+        std::vector<cpp_dep::include_vertex_descriptor_t> headers = find_headers(g, name);
+        if(headers.empty())
+            throw std::runtime_error("No header named \"" + name + "\"");
+
+        for(auto header : headers)
+        {
+            chain_query_result result;
+            result.header = header;
+            if(options.shortest)
+            {
+                include_chain chain = index.shortest_chain(header);
+                if(!chain.files.empty())
+                    result.chains.push_back(std::move(chain));
+            }
+            else
+            {
+                result.chains = index.chains(header, options.limit ? options.limit : kDefaultChains);
+            }
+            results.push_back(std::move(result));
+        }
+    }
+
+    write_chain_report(out, g, results, options.format);
+    return loaded.failed() ? 1 : 0;
+}
+
+// -----------------------------------------------------------------------------
+//
+int run_diff_report(report_options const& options, std::ostream& out)
+{
+    std::vector<std::string> before_files = expand_log_paths(options.baselines);
+    std::vector<std::string> after_files = expand_log_paths(options.logs);
+    if(before_files.empty() || after_files.empty())
+        throw std::runtime_error("No include logs found");
+
+    // Both sides are costed the same way, so a single log compared with
+    // a directory of them is aggregated too.
+    bool aggregate = options.aggregate || before_files.size() > 1 || after_files.size() > 1;
+    report_graph before = load_report_graph(before_files, {}, aggregate, options);
+    report_graph after = load_report_graph(after_files, {}, aggregate, options);
+
+    diff_input before_input;
+    before_input.graph = &before.graph();
+    before_input.costs = project_costs(before.graph(), before.stats());
+    before_input.logs = before_files;
+
+    diff_input after_input;
+    after_input.graph = &after.graph();
+    after_input.costs = project_costs(after.graph(), after.stats());
+    after_input.logs = after_files;
+
+    write_diff_report(
+        out,
+        diff_graphs(before_input, after_input),
+        options.format,
+        options.limit);
+
+    return before.failed() || after.failed() ? 1 : 0;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+//
+bool is_report_command(int argc, char* argv[])
+{
+    for(int i = 1; i < argc; ++i)
+    {
+        if(std::strcmp(argv[i], "--report") == 0)
+            return true;
+    }
+
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+//
+int run_report_command(int argc, char* argv[])
+{
+    report_options options;
+    try
+    {
+        options = parse_options(argc, argv);
+    }
+    catch(std::exception& e)
+    {
+        std::cerr << "cpp-size: " << e.what() << "\n\n";
+        print_usage(std::cerr);
+        return 2;
+    }
+
+    std::ofstream output_file;
+    if(!options.output.empty())
+    {
+        output_file.open(options.output, std::ios::binary);
+        if(!output_file)
+        {
+            std::cerr << "cpp-size: Failed to open \"" << options.output << "\"\n";
+            return 1;
+        }
+    }
+
+    std::ostream& out = options.output.empty() ? std::cout : output_file;
+
+    try
+    {
+        if(!options.baselines.empty())
+            return run_diff_report(options, out);
+
+        if(options.offenders)
+            return run_offender_report(options, out);
+
+        if(options.pch)
+            return run_pch_report(options, out);
+
+        if(options.redundant)
+            return run_redundant_report(options, out);
+
+        if(!options.why.empty())
+            return run_chain_report(options, out);
+
+        if(options.aggregate)
+            return run_aggregate_report(options, out);
+
+        return run_include_report(options, out);
+    }
+    catch(std::exception& e)
+    {
+        std::cerr << "cpp-size: " << e.what() << '\n';
+        return 1;
+    }
+}
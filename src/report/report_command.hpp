@@ -0,0 +1,24 @@
+// *****************************************************************************
+//
+// report/report_command.hpp
+//
+// Headless command line driver. Loads one or more include logs and writes
+// an include report without touching Qt.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_REPORT_REPORTCOMMAND_HPP_
+#define CPPSIZE_REPORT_REPORTCOMMAND_HPP_
+
+// True if the command line asks for a headless report instead of the UI.
+bool is_report_command(int argc, char* argv[]);
+
+// Runs the headless report, returns the process exit code.
+int run_report_command(int argc, char* argv[]);
+
+#endif // CPPSIZE_REPORT_REPORTCOMMAND_HPP_
@@ -0,0 +1,76 @@
+// *****************************************************************************
+//
+// report/report_format.cpp
+//
+// Output formats shared by the headless reports.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "report/report_format.hpp"
+#include <ostream>
+#include <stdexcept>
+
+// -----------------------------------------------------------------------------
+//
+report_format parse_report_format(std::string const& name)
+{
+    if(name == "text")
+        return report_format::text;
+    if(name == "json")
+        return report_format::json;
+    if(name == "csv")
+        return report_format::csv;
+
+    throw std::runtime_error("Unknown format \"" + name + "\"");
+}
+
+// -----------------------------------------------------------------------------
+//
+void write_json_string(std::ostream& out, std::string const& s)
+{
+    static char const hex[] = "0123456789abcdef";
+
+    out << '"';
+    for(char c : s)
+    {
+        switch(c)
+        {
+        case '"':  out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n";  break;
+        case '\r': out << "\\r";  break;
+        case '\t': out << "\\t";  break;
+        default:
+            if(static_cast<unsigned char>(c) < 0x20)
+                out << "\\u00" << hex[(c >> 4) & 0xf] << hex[c & 0xf];
+            else
+                out << c;
+        }
+    }
+    out << '"';
+}
+
+// -----------------------------------------------------------------------------
+//
+void write_csv_string(std::ostream& out, std::string const& s)
+{
+    if(s.find_first_of(",\"\n") == std::string::npos)
+    {
+        out << s;
+        return;
+    }
+
+    out << '"';
+    for(char c : s)
+    {
+        if(c == '"')
+            out << '"';
+        out << c;
+    }
+    out << '"';
+}
@@ -0,0 +1,35 @@
+// *****************************************************************************
+//
+// report/report_format.hpp
+//
+// Output formats shared by the headless reports.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_REPORT_REPORTFORMAT_HPP_
+#define CPPSIZE_REPORT_REPORTFORMAT_HPP_
+
+#include <iosfwd>
+#include <string>
+
+// -----------------------------------------------------------------------------
+//
+enum class report_format
+{
+    text,
+    json,
+    csv,
+};
+
+// Throws std::runtime_error for unknown names.
+report_format parse_report_format(std::string const& name);
+
+void write_json_string(std::ostream& out, std::string const& s);
+void write_csv_string(std::ostream& out, std::string const& s);
+
+#endif // CPPSIZE_REPORT_REPORTFORMAT_HPP_
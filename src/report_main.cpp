@@ -0,0 +1,21 @@
+// *****************************************************************************
+// 
+// report_main.cpp
+//
+// Console driver for cpp-size-report, the headless build of cpp-size that
+// does not link against Qt.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+
+#include "report/report_command.hpp"
+
+int main(int argc, char *argv[])
+{
+    return run_report_command(argc, argv);
+}
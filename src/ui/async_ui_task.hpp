@@ -3,7 +3,9 @@
 // ui/async_ui_task.hpp
 //
 // Async task system to allow running an async task with a user supplied
-// callback.
+// callback. Every task runs on one shared, bounded thread pool so loads,
+// filters and analyses can't oversubscribe the machine between them, and
+// the kind of task decides which runs first when the pool is busy.
 //
 // Copyright Chris Glover 2015
 //
@@ -15,8 +17,136 @@
 #ifndef _UI_ASYNCUITASK_HPP_
 #define _UI_ASYNCUITASK_HPP_
 
-#include <QtConcurrent/QtConcurrent>
+#include "util/task_monitor.hpp"
+#include <QObject>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+// -----------------------------------------------------------------------------
+//
+// When the pool is full the highest priority waiting task starts next. The
+// filter is what the user is typing into, so it goes first.
+enum class task_priority
+{
+    analysis,
+    load,
+    filter,
+};
+
+// -----------------------------------------------------------------------------
+//
+// Loads and analyses spread over parallel_for themselves, so the pool only
+// needs enough threads for each kind of task to run alongside the others.
+inline QThreadPool& shared_task_pool()
+{
+    static QThreadPool pool;
+    static bool const initialised = []()
+    {
+        pool.setMaxThreadCount(std::max(3, QThread::idealThreadCount() / 2));
+        return true;
+    }();
+
+    (void)initialised;
+    return pool;
+}
+
+// -----------------------------------------------------------------------------
+//
+// Where pool threads post results and progress for the UI thread. The
+// owning task closes it before it goes away, so work still running on
+// the pool afterwards posts nowhere.
+class task_mailbox
+{
+public:
+
+    explicit task_mailbox(QObject* receiver)
+        : receiver_(receiver)
+    {}
+
+    template<typename Function>
+    void post(Function fun)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(receiver_)
+            QMetaObject::invokeMethod(receiver_, std::move(fun), Qt::QueuedConnection);
+    }
+
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        receiver_ = nullptr;
+    }
+
+private:
+
+    std::mutex mutex_;
+    QObject* receiver_;
+};
+
+// -----------------------------------------------------------------------------
+//
+// Handed to cancellable tasks. Progress is forwarded to the UI thread and
+// dropped once the task has been cancelled. The progress handler is shared
+// with the owning task, which never changes it, so the pool never touches
+// the task itself.
+class async_task_context : public task_monitor
+{
+public:
+
+    typedef std::function<void(QString const&, int)> progress_handler_t;
+
+    async_task_context(
+        std::shared_ptr<task_mailbox> mailbox,
+        std::shared_ptr<progress_handler_t const> on_progress)
+        : mailbox_(std::move(mailbox))
+        , on_progress_(std::move(on_progress))
+        , cancelled_(false)
+    {}
+
+    void cancel()
+    {
+        cancelled_ = true;
+    }
+
+    bool cancelled() const override
+    {
+        return cancelled_;
+    }
+
+    void progress(char const* stage, int percent) override
+    {
+        if(!on_progress_ || !*on_progress_)
+            return;
+
+        std::shared_ptr<async_task_context> self = self_.lock();
+        QString stage_name = stage;
+        mailbox_->post(
+            [self, stage_name, percent]()
+            {
+                if(self && !self->cancelled())
+                    (*self->on_progress_)(stage_name, percent);
+            });
+    }
+
+private:
+
+    template <typename Result>
+    friend class async_ui_task;
+
+    std::shared_ptr<task_mailbox> mailbox_;
+    std::shared_ptr<progress_handler_t const> on_progress_;
+    std::weak_ptr<async_task_context> self_;
+    std::atomic<bool> cancelled_;
+};
 
 // -----------------------------------------------------------------------------
 //
@@ -26,41 +156,149 @@ class async_ui_task
 public:
 
     template <typename CompletionHandler>
-    async_ui_task(CompletionHandler on_complete)
-        : on_complete_(std::move(on_complete))
+    async_ui_task(task_priority priority, CompletionHandler on_complete)
+        : priority_(priority)
+        , mailbox_(std::make_shared<task_mailbox>(&receiver_))
+        , generation_(0)
+        , on_complete_(std::move(on_complete))
+    {}
+
+    template <typename CompletionHandler, typename ProgressHandler>
+    async_ui_task(task_priority priority, CompletionHandler on_complete, ProgressHandler on_progress)
+        : async_ui_task(priority, std::move(on_complete))
     {
-        result_watcher_.connect(
-            &result_watcher_,
-            &QFutureWatcher<Result>::finished,
-            [this](){ task_complete(); });
+        on_progress_ = std::make_shared<async_task_context::progress_handler_t const>(
+            std::move(on_progress));
     }
 
-    template<typename Function, typename... Params>
-    void run_or_enqueue(Function fun, Params... params)
+    ~async_ui_task()
     {
-        if(work_queue_.size() > 1)
-        {
-            work_queue_.pop_back();
-        }
+        cancel();
+        mailbox_->close();
+    }
+
+    async_ui_task(async_ui_task const&) = delete;
+    async_ui_task& operator=(async_ui_task const&) = delete;
+
+    // Cancels whatever is running, drops anything queued and runs fun as
+    // soon as possible. fun is called with an async_task_context and may
+    // throw task_cancelled; only the result of the latest call that
+    // wasn't cancelled is ever passed to the completion handler. Any
+    // other exception fun throws completes it with an empty Result.
+    template<typename Function>
+    void run_cancelling(Function fun)
+    {
+        cancel();
+
+        auto context = std::make_shared<async_task_context>(mailbox_, on_progress_);
+        context->self_ = context;
 
         work_queue_.push_back(
-            [=]()
             {
-                return fun(params...);
+                [fun, context]() -> Result
+                {
+                    try
+                    {
+                        return fun(*context);
+                    }
+                    catch(task_cancelled&)
+                    {
+                        return Result();
+                    }
+                },
+                context,
+                ++generation_
             }
         );
 
         if(work_queue_.size() == 1)
         {
-            result_watcher_.setFuture(QtConcurrent::run(work_queue_.front()));
+            run_front();
         }
     }
 
+    // Cancels the running task and drops everything that hasn't started.
+    void cancel()
+    {
+        if(work_queue_.empty())
+            return;
+
+        work_queue_.front().context->cancel();
+        work_queue_.erase(work_queue_.begin() + 1, work_queue_.end());
+    }
+
 private:
 
-    void task_complete()
+    struct work_item
+    {
+        std::function<Result()> run;
+        std::shared_ptr<async_task_context> context;
+        std::uint64_t generation;
+    };
+
+    class task_runnable : public QRunnable
+    {
+    public:
+
+        explicit task_runnable(std::function<void()> fun)
+            : fun_(std::move(fun))
+        {}
+
+        void run() override
+        {
+            fun_();
+        }
+
+    private:
+
+        std::function<void()> fun_;
+    };
+
+    void run_front()
+    {
+        // The posted completion only runs while the mailbox is open, which
+        // is only while this task is alive.
+        std::function<Result()> run = work_queue_.front().run;
+        std::uint64_t generation = work_queue_.front().generation;
+        std::shared_ptr<task_mailbox> mailbox = mailbox_;
+        shared_task_pool().start(
+            new task_runnable(
+                [this, run, generation, mailbox]()
+                {
+                    // Errors the task can explain are part of its result,
+                    // so this only stops anything else, like running out
+                    // of memory, from leaving the queue stuck behind it.
+                    Result result;
+                    try
+                    {
+                        result = run();
+                    }
+                    catch(std::exception&)
+                    {
+                        result = Result();
+                    }
+
+                    mailbox->post(
+                        [this, result, generation]()
+                        {
+                            task_complete(generation, result);
+                        });
+                }
+            ),
+            static_cast<int>(priority_)
+        );
+    }
+
+    void task_complete(std::uint64_t generation, Result result)
     {
-        on_complete_(result_watcher_.future().result());
+        // Anything submitted since makes this result stale even if the
+        // task finished before it noticed it was cancelled.
+        std::shared_ptr<async_task_context> context = work_queue_.front().context;
+        if(generation == generation_ && !context->cancelled())
+        {
+            on_complete_(std::move(result));
+        }
+
         dequeue_and_run();
     }
 
@@ -69,13 +307,17 @@ private:
         work_queue_.pop_front();
         if(!work_queue_.empty())
         {
-            result_watcher_.setFuture(QtConcurrent::run(work_queue_.front()));
+            run_front();
         }
     }
 
-    QFutureWatcher<Result> result_watcher_;
-    std::deque<std::function<Result()>> work_queue_;
+    QObject receiver_;
+    task_priority priority_;
+    std::shared_ptr<task_mailbox> mailbox_;
+    std::deque<work_item> work_queue_;
+    std::uint64_t generation_;
     std::function<void(Result)> on_complete_;
+    std::shared_ptr<async_task_context::progress_handler_t const> on_progress_;
 };
 
 #endif // _UI_ASYNCUITASK_HPP_
@@ -12,37 +12,172 @@
 //
 // *****************************************************************************
 #include "ui/dialog.hpp"
-#include "ui/include_tree_widget_item.hpp"
+#include "analysis/top_offenders.hpp"
+#include "ui/graph_loader.hpp"
+#include "ui/include_tree_model.hpp"
+#include "ui/removal_simulator.hpp"
 #include "ui/tree_view_builder.hpp"
-#include "util/filtered_subgraph_builder.hpp"
+#include "util/filter_query.hpp"
+#include "util/incremental_tree_filter.hpp"
 #include "ui_dialog.h"
 #include "cpp_dep/cpp_dep.hpp"
 #include <boost/graph/depth_first_search.hpp>
-#include <boost/algorithm/string/split.hpp>
-#include <boost/algorithm/string/classification.hpp>
+#include <QFileDialog>
 #include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QHeaderView>
 #include <QDropEvent>
 #include <QDragEnterEvent>
 #include <QDragLeaveEvent>
 #include <QDragMoveEvent>
+#include <QMenu>
 #include <QMimeData>
 #include <QMessageBox>
+#include <QSortFilterProxyModel>
+#include <QTimer>
+#include <QTreeWidget>
 #include <algorithm>
 
+// -----------------------------------------------------------------------------
+//
+namespace {
+    // Builds write their logs a piece at a time, so wait for the writes
+    // to settle before reloading.
+    int const kReloadDelayMs = 500;
+
+    // Disappeared headers listed in the change summary's tooltip.
+    std::size_t const kMaxRemovedListed = 20;
+
+    // Headers listed in the compare tab, the rest are only counted in the
+    // summary.
+    std::size_t const kMaxDiffHeaders = 1000;
+
+    // New includes listed under each header in the compare tab.
+    std::size_t const kMaxDiffIncluders = 20;
+
+    // Headers listed in the offenders tab.
+    std::size_t const kMaxOffenders = 100;
+
+    // Include chains listed in the why tab.
+    std::size_t const kMaxChains = 20;
+
+    enum OffenderColumn
+    {
+        OffenderColFile,
+        OffenderColContribution,
+        OffenderColOccurence,
+        OffenderColExclusive,
+    };
+
+    enum PchColumn
+    {
+        PchColFile,
+        PchColAdded,
+        PchColSaved,
+        PchColTranslationUnits,
+    };
+
+    enum ChainColumn
+    {
+        ChainColFile,
+        ChainColSize,
+    };
+
+    enum DiffColumn
+    {
+        DiffColFile,
+        DiffColBefore,
+        DiffColAfter,
+        DiffColChange,
+    };
+
+    QString formatKb(qint64 bytes)
+    {
+        qint64 kb = (qAbs(bytes) + 1023) / 1024;
+        return QString::number(bytes < 0 ? -kb : kb) + "kb";
+    }
+}
+
 // -----------------------------------------------------------------------------
 //
 Dialog::Dialog(QWidget *parent)
     : QDialog(parent)
     , ui(new Ui::Dialog)
-    , update_tree_widget_(std::bind(&Dialog::filterTreeBuilt, this, std::placeholders::_1))
+    , include_model_(nullptr)
+    , filesystem_model_(nullptr)
+    , update_include_tree_(
+        task_priority::filter,
+        std::bind(&Dialog::filterTreeBuilt, this, std::placeholders::_1))
+    , load_graphs_(
+        task_priority::load,
+        std::bind(&Dialog::graphsLoaded, this, std::placeholders::_1),
+        std::bind(&Dialog::loadProgress, this, std::placeholders::_1, std::placeholders::_2))
+    , load_diff_(
+        task_priority::load,
+        std::bind(&Dialog::diffLoaded, this, std::placeholders::_1),
+        std::bind(&Dialog::loadProgress, this, std::placeholders::_1, std::placeholders::_2))
+    , recommend_pch_(
+        task_priority::analysis,
+        std::bind(&Dialog::pchRecommended, this, std::placeholders::_1))
+    , log_watcher_(new QFileSystemWatcher(this))
+    , reload_timer_(new QTimer(this))
+    , reloading_(false)
 {
     ui->setupUi(this);
-    ui->filesystem_tree->header()->resizeSection(0, 400);
-    ui->include_tree->header()->resizeSection(0, 400);
+    ui->load_progress->setVisible(false);
+
+    include_model_ = new IncludeTreeModel(
+        QStringList() << "File" << "Size" << "Percent" << "Order" << "Occurence"
+                      << "Exclusive" << "TUs" << "Project" << "Time" << "Time %"
+                      << "Change",
+        this);
+
+    filesystem_model_ = new IncludeTreeModel(
+        QStringList() << "Path" << "Size" << "Percent" << "Order" << "Includes"
+                      << "Exclusive" << "TUs" << "Project" << "Time" << "Time %"
+                      << "Change" << "Headers",
+        this);
+
+    setupTreeView(ui->include_tree, include_model_);
+    setupTreeView(ui->filesystem_tree, filesystem_model_);
+    ui->include_tree->setColumnHidden(IncludeTreeModel::ColTranslationUnits, true);
+    ui->include_tree->setColumnHidden(IncludeTreeModel::ColProjectSize, true);
+    ui->include_tree->setColumnHidden(IncludeTreeModel::ColTime, true);
+    ui->include_tree->setColumnHidden(IncludeTreeModel::ColTimePercent, true);
+    ui->include_tree->setColumnHidden(IncludeTreeModel::ColChange, true);
+
+    // Directories show totals for everything under them, the per header
+    // columns don't apply.
+    for(int column = IncludeTreeModel::ColExclusive; column <= IncludeTreeModel::ColChange; ++column)
+        ui->filesystem_tree->setColumnHidden(column, true);
+
+    // Show timings and changes next to the sizes they're compared with.
+    QHeaderView* header = ui->include_tree->header();
+    header->moveSection(header->visualIndex(IncludeTreeModel::ColTime), IncludeTreeModel::ColPercent + 1);
+    header->moveSection(header->visualIndex(IncludeTreeModel::ColTimePercent), IncludeTreeModel::ColPercent + 2);
+    header->moveSection(header->visualIndex(IncludeTreeModel::ColChange), IncludeTreeModel::ColSize + 1);
+
+    ui->diff_tree->header()->resizeSection(DiffColFile, 400);
+    ui->offender_tree->header()->resizeSection(OffenderColFile, 400);
+    ui->pch_tree->header()->resizeSection(PchColFile, 400);
+    ui->why_tree->header()->resizeSection(ChainColFile, 500);
+    ui->include_tree->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(ui->include_tree, &QTreeView::customContextMenuRequested, this, &Dialog::includeContextMenu);
+    connect(include_model_, &IncludeTreeModel::removalsChanged, this, &Dialog::updateOffenders);
+    ui->compare_button->setEnabled(false);
+
+    reload_timer_->setSingleShot(true);
+    reload_timer_->setInterval(kReloadDelayMs);
+    connect(reload_timer_, &QTimer::timeout, [this]() { loadFiles(true); });
+    connect(log_watcher_, &QFileSystemWatcher::fileChanged, [this]() { logChanged(); });
+    connect(log_watcher_, &QFileSystemWatcher::directoryChanged, [this]() { logChanged(); });
 }
 
 Dialog::~Dialog()
 {
+    load_graphs_.cancel();
+    load_diff_.cancel();
+    recommend_pch_.cancel();
     delete ui;
 }
 
@@ -50,59 +185,66 @@ Dialog::~Dialog()
 //
 void Dialog::filterTextChanged(QString const& filter_text)
 {
-    auto do_filter = [filter_text, this](QTreeWidget* tree)
-    {
-        tree->clear();
-        std::vector<std::string> match_list;
-        std::string filter_text_std = filter_text.toStdString();
-        boost::algorithm::split(
-            match_list, filter_text_std,
-            boost::algorithm::is_any_of(" \0\t\r"),
-            boost::algorithm::token_compress_on);
-
-        match_list.erase(
-            std::remove_if(
-                match_list.begin(),
-                match_list.end(),
-                [](std::string const& s)
-                {
-                    return s.empty();
-                }
-            ),
-            match_list.end()
-        );
-
-        if(match_list.empty())
-        {
-            tree_view_builder build_tree(tree_view_builder::option::checkbox);
-            build_tree(*include_graph_, tree);
-        }
-        else
+    if(!include_filter_)
+        return;
+
+    // Compiled once here, every vertex tested is then a single pass
+    // over its name.
+    filter_query query(filter_text.toStdString());
+
+    // Capture the filter by value so a file dropped while this
+    // is running can't pull it out from under us. Tasks run one
+    // at a time so the filter's cache is never shared, and each
+    // keystroke cancels the query it replaces.
+    std::shared_ptr<incremental_tree_filter> filter = include_filter_;
+    update_include_tree_.run_cancelling(
+        [filter, query](async_task_context& context)
         {
-            auto match_all_substrings = [&match_list](
-                cpp_dep::include_vertex_descriptor_t const& v,
-                cpp_dep::include_graph_t const& g)
-            {
-                cpp_dep::include_vertex_t const& file = g[v];
-                return std::all_of(
-                    match_list.begin(),
-                    match_list.end(),
-                    [&file](std::string const& sub_str)
-                    {
-                        return file.name.find(sub_str) != std::string::npos;
-                    }
-                );
-            };
-
-            filtered_tree_view_builder graph_filter;
-            graph_filter(*include_graph_, tree, match_all_substrings);
+            return (*filter)(query, &context);
         }
+    );
+}
 
-        return tree;
-    };
+// -----------------------------------------------------------------------------
+//
+void Dialog::watchToggled(bool watch)
+{
+    watchLoadedFiles();
+    if(!watch)
+    {
+        reload_timer_->stop();
+        return;
+    }
+
+    // Catch up with anything that changed while we weren't watching.
+    if(!loaded_files_.empty())
+        loadFiles(true);
+}
+
+// -----------------------------------------------------------------------------
+//
+void Dialog::compareClicked()
+{
+    if(!loaded_graphs_ || !loaded_graphs_->include_graph)
+        return;
+
+    QStringList names = QFileDialog::getOpenFileNames(
+        this, tr("Baseline logs to compare with"));
 
-    if(include_graph_)
-        update_tree_widget_.run_or_enqueue(do_filter, new QTreeWidget);
+    if(names.isEmpty())
+        return;
+
+    std::vector<std::string> files;
+    for(auto&& name : names)
+        files.push_back(name.toStdString());
+
+    std::shared_ptr<loaded_graphs const> current = loaded_graphs_;
+    load_diff_.run_cancelling(
+        [files, current](async_task_context& context)
+        {
+            return load_diff(files, current, context);
+        }
+    );
 }
 
 // -----------------------------------------------------------------------------
@@ -116,43 +258,20 @@ void Dialog::dropEvent(QDropEvent* event)
         QList<QUrl> urls = mime_data->urls();
         if(urls.size() > 0)
         {
-            // Just take the first one in case the user dragged multiple.
-            QString file = urls.at(0).toLocalFile();
-            try
+            std::vector<std::string> files;
+            for(auto&& url : urls)
             {
-                cpp_dep::include_graph_t includes =
-                    cpp_dep::read_deps_file(file.toStdString().c_str());
-
-                cpp_dep::include_graph_t paths =
-                    cpp_dep::invert_to_paths(includes);
-
-                // Save the two graphs.
-                include_graph_ = std::make_unique<
-                    cpp_dep::include_graph_t
-                >(std::move(includes));
-
-                filesystem_graph_ = std::make_unique<
-                    cpp_dep::include_graph_t
-                >(std::move(paths));
-
-                populateTrees();
-            }
-            catch(std::exception& e)
-            {
-                QString msg;
-                msg += "Failed to load \"" + file + "\"\n"
-                    +  "Error: " + e.what();
-
-                QMessageBox msg_box;
-                msg_box.setText(msg);
-                msg_box.setIcon(QMessageBox::Critical);
-                msg_box.exec();
+                files.push_back(url.toLocalFile().toStdString());
             }
+
+            // A new drop isn't compared with whatever was there before.
+            loading_name_ = urls.at(0).toLocalFile();
+            loaded_files_ = std::move(files);
+            loaded_graphs_.reset();
+            loadProgress(tr("Loading"), 0);
+            loadFiles(false);
         }
     }
-
-    // Reapply the filter text.
-    filterTextChanged(ui->filter_text->text());
 }
 
 // -----------------------------------------------------------------------------
@@ -180,34 +299,532 @@ void Dialog::dragLeaveEvent(QDragLeaveEvent* event)
 
 // -----------------------------------------------------------------------------
 //
-void Dialog::populateTrees()
+void Dialog::loadFiles(bool reload)
+{
+    // Loading happens off the UI thread. Anything still loading is
+    // cancelled, so a build that rewrites its log faster than it can be
+    // loaded only ever costs one load of the latest version.
+    std::vector<std::string> files = loaded_files_;
+    std::shared_ptr<loaded_graphs const> previous = reload ? loaded_graphs_ : nullptr;
+    reloading_ = reload;
+    load_graphs_.run_cancelling(
+        [files, previous](async_task_context& context)
+        {
+            return load_graphs(files, context, previous);
+        }
+    );
+}
+
+// -----------------------------------------------------------------------------
+//
+void Dialog::logChanged()
+{
+    if(ui->watch_check->isChecked())
+        reload_timer_->start();
+}
+
+// -----------------------------------------------------------------------------
+//
+void Dialog::watchLoadedFiles()
+{
+    // Logs replaced by renaming a new file over them drop out of the
+    // watcher, so the watched set is rebuilt after every load.
+    QStringList watched = log_watcher_->files() + log_watcher_->directories();
+    if(!watched.isEmpty())
+        log_watcher_->removePaths(watched);
+
+    if(!ui->watch_check->isChecked())
+        return;
+
+    std::vector<std::string> paths = loaded_files_;
+    if(loaded_graphs_)
+        paths.insert(paths.end(), loaded_graphs_->inputs.begin(), loaded_graphs_->inputs.end());
+
+    QStringList to_watch;
+    for(auto&& path : paths)
+    {
+        QString name = QString::fromStdString(path);
+        if(QFileInfo::exists(name) && !to_watch.contains(name))
+            to_watch << name;
+    }
+
+    if(!to_watch.isEmpty())
+        log_watcher_->addPaths(to_watch);
+}
+
+// -----------------------------------------------------------------------------
+//
+void Dialog::showChanges(loaded_graphs const& graphs)
+{
+    if(!graphs.changes)
+    {
+        ui->change_summary->clear();
+        ui->change_summary->setToolTip(QString());
+        return;
+    }
+
+    int grown = 0;
+    int shrunk = 0;
+    int added = 0;
+    for(auto&& change : graphs.changes->vertices)
+    {
+        switch(change.state)
+        {
+        case size_change::grown: ++grown; break;
+        case size_change::shrunk: ++shrunk; break;
+        case size_change::added: ++added; break;
+        case size_change::unchanged: break;
+        }
+    }
+
+    std::vector<removed_header> const& removed = graphs.changes->removed;
+    ui->change_summary->setText(
+        tr("%1 grew, %2 shrank, %3 new, %4 gone")
+            .arg(grown).arg(shrunk).arg(added).arg(removed.size()));
+
+    QString tooltip;
+    for(std::size_t i = 0; i < removed.size() && i < kMaxRemovedListed; ++i)
+    {
+        tooltip += QString::fromStdString(removed[i].name)
+                +  "  -" + QString::number((qint64(removed[i].size) + 1023) / 1024) + "kb\n";
+    }
+
+    if(removed.size() > kMaxRemovedListed)
+        tooltip += tr("and %1 more").arg(removed.size() - kMaxRemovedListed);
+
+    ui->change_summary->setToolTip(tooltip.trimmed());
+}
+
+// -----------------------------------------------------------------------------
+//
+void Dialog::graphsLoaded(std::shared_ptr<loaded_graphs> graphs)
+{
+    ui->load_progress->setVisible(false);
+
+    // A reload that found none of the logs had changed.
+    if(!graphs)
+        return;
+
+    if(!graphs->error.empty() && reloading_)
+    {
+        // The build may have been part way through writing the log.
+        // Keep showing the last good load, but remember this version
+        // so it's only retried once the log changes again.
+        if(loaded_graphs_)
+        {
+            auto kept = std::make_shared<loaded_graphs>(*loaded_graphs_);
+            kept->inputs = graphs->inputs;
+            kept->input_fingerprints = graphs->input_fingerprints;
+            loaded_graphs_ = kept;
+        }
+
+        ui->change_summary->setText(tr("Reload failed"));
+        ui->change_summary->setToolTip(QString::fromStdString(graphs->error));
+        watchLoadedFiles();
+        return;
+    }
+
+    if(!graphs->error.empty())
+    {
+        QString msg;
+        msg += "Failed to load \"" + loading_name_ + "\"\n"
+            +  "Error: " + QString::fromStdString(graphs->error);
+
+        QMessageBox msg_box;
+        msg_box.setText(msg);
+        msg_box.setIcon(QMessageBox::Critical);
+        msg_box.exec();
+
+        // Still watched, so fixing the log loads it.
+        watchLoadedFiles();
+        return;
+    }
+
+    // Everything is swapped in at once, so the views never see
+    // a mix of the old and new graphs.
+    include_graph_ = graphs->include_graph;
+    filesystem_graph_ = graphs->filesystem_graph;
+    include_filter_ = graphs->include_filter;
+    loaded_graphs_ = graphs;
+    ui->compare_button->setEnabled(true);
+    populateTrees(*graphs);
+    showChanges(*graphs);
+    updatePch();
+    watchLoadedFiles();
+
+    // Reloads don't interrupt with the same errors every time the
+    // build rewrites a log.
+    if(!graphs->errors.empty() && !reloading_)
+    {
+        showErrors(graphs->errors);
+    }
+
+    // Reapply the filter text.
+    filterTextChanged(ui->filter_text->text());
+}
+
+// -----------------------------------------------------------------------------
+//
+void Dialog::loadProgress(QString const& stage, int percent)
+{
+    ui->load_progress->setVisible(true);
+    ui->load_progress->setFormat(stage + " %p%");
+    ui->load_progress->setValue(percent);
+}
+
+// -----------------------------------------------------------------------------
+//
+void Dialog::populateTrees(loaded_graphs const& graphs)
 {
     // Clear both trees first so that if parsing fails
     // both are empty instead of just one.
-    ui->include_tree->clear();
-    ui->filesystem_tree->clear();
+    include_model_->clear();
+    filesystem_model_->clear();
+
+    // A comparison was against the graphs being replaced.
+    load_diff_.cancel();
+    clearDiff();
+
+    // So is the pch.
+    recommend_pch_.cancel();
+    ui->pch_tree->clear();
+    ui->pch_summary->clear();
+    ui->why_tree->clear();
+    ui->why_summary->clear();
+
+    include_model_->setAggregateStats(graphs.aggregate_stats);
+    include_model_->setRemovalSimulator(graphs.removals);
+    include_model_->setExclusiveSizes(graphs.exclusive_sizes);
+    include_model_->setVertexPaths(graphs.include_paths);
+    include_model_->setHeaderTimes(graphs.header_times);
+    include_model_->setSizeChanges(graphs.changes);
+    filesystem_model_->setVertexPaths(graphs.filesystem_paths);
+    filesystem_model_->setPathRollups(graphs.path_rollups);
+    ui->include_tree->setColumnHidden(IncludeTreeModel::ColTranslationUnits, !graphs.aggregate_stats);
+    ui->include_tree->setColumnHidden(IncludeTreeModel::ColProjectSize, !graphs.aggregate_stats);
+    ui->include_tree->setColumnHidden(IncludeTreeModel::ColTime, !graphs.header_times);
+    ui->include_tree->setColumnHidden(IncludeTreeModel::ColTimePercent, !graphs.header_times);
+    ui->include_tree->setColumnHidden(IncludeTreeModel::ColChange, !graphs.changes);
 
     // Populate the filesystem tree
+    filesystem_model_->setTree(graphs.filesystem_tree);
+}
+
+// -----------------------------------------------------------------------------
+//
+void Dialog::filterTreeBuilt(std::shared_ptr<include_tree const> new_tree)
+{
+    // The build failed, so keep showing the last tree.
+    if(!new_tree)
+        return;
+
+    // Offenders are ranked from the headers the filtered tree shows,
+    // other than the translation units at the top.
+    shown_headers_.assign(boost::num_vertices(new_tree->graph()), 0);
+    for(include_tree::node_index_t i = 0; i < new_tree->size(); ++i)
     {
-        tree_view_builder build_tree(tree_view_builder::option::none);
-        build_tree(*filesystem_graph_, ui->filesystem_tree);
+        if((*new_tree)[i].parent != include_tree::npos)
+            shown_headers_[(*new_tree)[i].vertex] = 1;
     }
+
+    shown_tree_ = new_tree;
+    include_model_->setTree(std::move(new_tree));
+    updateOffenders();
 }
 
 // -----------------------------------------------------------------------------
 //
-void Dialog::filterTreeBuilt(QTreeWidget* new_widget)
+void Dialog::updateOffenders()
 {
-    assert(new_widget != ui->include_tree);
+    ui->offender_tree->clear();
+    ui->offender_summary->clear();
 
-     ui->include_tree->clear();
+    // A filter still running when new graphs were loaded can hand back a
+    // tree of the old graph.
+    if(!loaded_graphs_ || !shown_tree_ || shown_tree_->graph_ptr() != loaded_graphs_->include_graph)
+        return;
 
-     for(int i = 0; i < new_widget->topLevelItemCount(); ++i)
-     {
-         ui->include_tree->insertTopLevelItem(
-             i, new_widget->takeTopLevelItem(i)
-         );
-     }
+    loaded_graphs const& graphs = *loaded_graphs_;
+    cpp_dep::include_graph_t const& g = *graphs.include_graph;
+    include_tree const& tree = *shown_tree_;
+    std::vector<char> const& shown = shown_headers_;
+    removal_simulator const* removals = graphs.removals.get();
+    aggregate_stats_t const* stats = graphs.aggregate_stats.get();
+    std::vector<std::size_t> const* exclusive = graphs.exclusive_sizes.get();
+
+    // The combo box lists the rankings in offender_rank's order.
+    offender_rank rank = static_cast<offender_rank>(ui->offender_rank->currentIndex());
+    std::vector<offender> offenders = top_offenders(
+        boost::num_vertices(g),
+        kMaxOffenders,
+        rank,
+        [&](cpp_dep::include_vertex_descriptor_t v, offender& o)
+        {
+            if(!shown[v] || (removals && !removals->is_included(v)))
+                return false;
+
+            o.contribution = stats    ? (*stats)[v].transitive_size
+                           : removals ? removals->file_size(v)
+                           : g[v].size + g[v].size_dependencies;
+            o.occurence = tree.vertex_occurence(v) - (removals ? removals->removed_includes(v) : 0);
+            o.exclusive = exclusive ? (*exclusive)[v] : 0;
+            return true;
+        }
+    );
+
+    QList<QTreeWidgetItem*> items;
+    for(auto&& o : offenders)
+    {
+        QTreeWidgetItem* item = new QTreeWidgetItem();
+        item->setText(OffenderColFile, QString::fromStdString(g[o.vertex].name));
+        item->setText(OffenderColContribution, formatKb(qint64(o.contribution)));
+        item->setText(OffenderColOccurence, QString::number(o.occurence));
+        item->setText(OffenderColExclusive, formatKb(qint64(o.exclusive)));
+        items.append(item);
+    }
+
+    ui->offender_tree->addTopLevelItems(items);
+    ui->offender_summary->setText(tr("Top %1 of the headers shown").arg(offenders.size()));
+}
 
-     delete new_widget;
+// -----------------------------------------------------------------------------
+//
+void Dialog::updatePch()
+{
+    if(!loaded_graphs_ || !loaded_graphs_->include_graph)
+        return;
+
+    pch_options options;
+    options.budget = std::size_t(ui->pch_budget->value()) * 1024 * 1024;
+
+    // Changing the budget again before this finishes drops this result.
+    std::shared_ptr<loaded_graphs const> graphs = loaded_graphs_;
+    recommend_pch_.run_cancelling(
+        [graphs, options](async_task_context& context)
+        {
+            return recommend_loaded_pch(graphs, options, context);
+        }
+    );
+}
+
+// -----------------------------------------------------------------------------
+//
+void Dialog::pchRecommended(std::shared_ptr<recommended_pch> recommended)
+{
+    ui->pch_tree->clear();
+    ui->pch_summary->clear();
+
+    if(!recommended || recommended->graphs != loaded_graphs_)
+        return;
+
+    if(!recommended->error.empty())
+    {
+        ui->pch_summary->setText(
+            tr("Failed to pick precompiled headers: %1")
+                .arg(QString::fromStdString(recommended->error)));
+        return;
+    }
+
+    cpp_dep::include_graph_t const& g = *recommended->graphs->include_graph;
+    pch_recommendation const& pch = recommended->pch;
+
+    QList<QTreeWidgetItem*> items;
+    for(auto&& h : pch.headers)
+    {
+        QTreeWidgetItem* item = new QTreeWidgetItem();
+        item->setText(PchColFile, QString::fromStdString(g[h.vertex].name));
+        item->setText(PchColAdded, formatKb(qint64(h.added_bytes)));
+        item->setText(PchColSaved, formatKb(qint64(h.saved_bytes)));
+        item->setText(PchColTranslationUnits, QString::number(qulonglong(h.num_translation_units)));
+        items.append(item);
+    }
+
+    ui->pch_tree->addTopLevelItems(items);
+
+    qint64 percent = pch.bytes_parsed ? qint64((pch.bytes_saved * 100) / pch.bytes_parsed) : 0;
+    ui->pch_summary->setText(
+        tr("%1 headers, %2 in the pch, saves reparsing %3 of %4 (%5%)")
+            .arg(pch.headers.size())
+            .arg(formatKb(qint64(pch.pch_bytes)))
+            .arg(formatKb(qint64(pch.bytes_saved)))
+            .arg(formatKb(qint64(pch.bytes_parsed)))
+            .arg(percent));
+}
+
+// -----------------------------------------------------------------------------
+//
+void Dialog::includeContextMenu(QPoint const& pos)
+{
+    QModelIndex index = ui->include_tree->indexAt(pos);
+    if(!index.isValid())
+        return;
+
+    QMenu menu(this);
+    QAction* why = menu.addAction(tr("Why is this included?"));
+    if(menu.exec(ui->include_tree->viewport()->mapToGlobal(pos)) != why)
+        return;
+
+    QSortFilterProxyModel* sorter = static_cast<QSortFilterProxyModel*>(ui->include_tree->model());
+    showIncludeChains(sorter->mapToSource(index));
+}
+
+// -----------------------------------------------------------------------------
+//
+void Dialog::showIncludeChains(QModelIndex const& index)
+{
+    ui->why_tree->clear();
+    ui->why_summary->clear();
+
+    // As with the offenders, the tree shown may still be of the old graph.
+    if(!loaded_graphs_ || !shown_tree_ || shown_tree_->graph_ptr() != loaded_graphs_->include_graph)
+        return;
+
+    cpp_dep::include_graph_t const& g = *loaded_graphs_->include_graph;
+    cpp_dep::include_vertex_descriptor_t header = include_model_->vertex(index);
+    cpp_dep::include_vertex_descriptor_t root = include_model_->rootVertex(index);
+    include_chain_index const& chain_index = *loaded_graphs_->include_chains;
+
+    // The shortest chain first, then the ones costing the most bytes.
+    include_chain shortest = chain_index.shortest_chain(header, root);
+    std::vector<include_chain> chains = chain_index.chains(header, kMaxChains, root);
+
+    auto make_item = [&g](include_chain const& chain, QString const& label)
+    {
+        QTreeWidgetItem* item = new QTreeWidgetItem();
+        item->setText(ChainColFile, label);
+        item->setText(ChainColSize, formatKb(qint64(chain.bytes)));
+        for(auto v : chain.files)
+        {
+            QTreeWidgetItem* file = new QTreeWidgetItem(item);
+            file->setText(ChainColFile, QString::fromStdString(g[v].name));
+            file->setText(ChainColSize, formatKb(qint64(g[v].size)));
+        }
+
+        return item;
+    };
+
+    QList<QTreeWidgetItem*> items;
+    if(!shortest.files.empty())
+    {
+        items.append(make_item(shortest, tr("Shortest, %1 includes").arg(shortest.files.size() - 1)));
+    }
+
+    for(auto&& chain : chains)
+    {
+        items.append(make_item(chain, tr("%1 includes").arg(chain.files.size() - 1)));
+    }
+
+    ui->why_tree->addTopLevelItems(items);
+    if(!items.isEmpty())
+        items.front()->setExpanded(true);
+
+    QString name = QString::fromStdString(g[header].name);
+    QString root_name = QString::fromStdString(g[root].name);
+    ui->why_summary->setText(chains.empty()
+        ? tr("%1 isn't included from %2").arg(name).arg(root_name)
+        : tr("Biggest %1 chains from %2 to %3").arg(chains.size()).arg(root_name).arg(name));
+
+    ui->tab_view->setCurrentWidget(ui->why_tab);
+}
+
+// -----------------------------------------------------------------------------
+//
+void Dialog::showErrors(std::vector<std::string> const& errors)
+{
+    QString msg = "Failed to load some logs:\n";
+    for(auto&& error : errors)
+    {
+        msg += QString::fromStdString(error) + "\n";
+    }
+
+    QMessageBox msg_box;
+    msg_box.setText(msg);
+    msg_box.setIcon(QMessageBox::Warning);
+    msg_box.exec();
+}
+
+// -----------------------------------------------------------------------------
+//
+void Dialog::diffLoaded(std::shared_ptr<loaded_diff> loaded)
+{
+    ui->load_progress->setVisible(false);
+    clearDiff();
+
+    if(!loaded)
+        return;
+
+    if(!loaded->error.empty())
+    {
+        QMessageBox msg_box;
+        msg_box.setText("Failed to compare\nError: " + QString::fromStdString(loaded->error));
+        msg_box.setIcon(QMessageBox::Critical);
+        msg_box.exec();
+        return;
+    }
+
+    if(!loaded->errors.empty())
+        showErrors(loaded->errors);
+
+    graph_diff const& diff = *loaded->diff;
+    ui->diff_summary->setText(
+        tr("%1 headers changed, %2 in total, %3 new includes, %4 removed")
+            .arg(diff.headers.size())
+            .arg((diff.total_delta > 0 ? "+" : "") + formatKb(diff.total_delta))
+            .arg(diff.added_edges.size())
+            .arg(diff.removed_edges.size()));
+
+    // Created without a parent and added at once, a tree widget
+    // inserting items one at a time re-lays itself out for each.
+    QList<QTreeWidgetItem*> items;
+    std::size_t num_headers = std::min(diff.headers.size(), kMaxDiffHeaders);
+    for(std::size_t i = 0; i < num_headers; ++i)
+    {
+        header_diff const& h = diff.headers[i];
+        QTreeWidgetItem* item = new QTreeWidgetItem();
+        item->setText(DiffColFile, QString::fromStdString(h.name));
+        item->setText(DiffColBefore, h.state == header_diff::added ? QString() : formatKb(h.cost_before));
+        item->setText(DiffColAfter, h.state == header_diff::removed ? QString() : formatKb(h.cost_after));
+        item->setText(DiffColChange, (h.delta() > 0 ? "+" : "") + formatKb(h.delta()));
+
+        QColor colour = h.state == header_diff::added   ? QColor(Qt::darkBlue)
+                      : h.state == header_diff::removed ? QColor(Qt::gray)
+                      : h.delta() > 0                   ? QColor(Qt::darkRed)
+                      : QColor(Qt::darkGreen);
+        item->setForeground(DiffColChange, colour);
+
+        std::size_t num_includers = std::min(h.new_includers.size(), kMaxDiffIncluders);
+        for(std::size_t j = 0; j < num_includers; ++j)
+        {
+            include_edge_diff const& edge = diff.added_edges[h.new_includers[j]];
+            QTreeWidgetItem* includer = new QTreeWidgetItem(item);
+            includer->setText(DiffColFile, tr("new include from %1").arg(QString::fromStdString(edge.includer)));
+        }
+
+        items.append(item);
+    }
+
+    ui->diff_tree->addTopLevelItems(items);
+    ui->tab_view->setCurrentWidget(ui->compare_tab);
+}
+
+// -----------------------------------------------------------------------------
+//
+void Dialog::clearDiff()
+{
+    ui->diff_tree->clear();
+    ui->diff_summary->clear();
+}
+
+// -----------------------------------------------------------------------------
+//
+void Dialog::setupTreeView(QTreeView* view, IncludeTreeModel* model)
+{
+    // Sorting goes through a proxy so the model itself never has to
+    // materialise rows that haven't been expanded.
+    QSortFilterProxyModel* sorter = new QSortFilterProxyModel(this);
+    sorter->setSourceModel(model);
+    sorter->setSortRole(IncludeTreeModel::SortRole);
+    view->setModel(sorter);
+    view->sortByColumn(IncludeTreeModel::ColOrder, Qt::AscendingOrder);
+    view->header()->resizeSection(0, 400);
 }
@@ -17,6 +17,8 @@
 #include <QDialog>
 #include <QFutureWatcher>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "async_ui_task.hpp"
 
@@ -26,7 +28,16 @@ namespace Ui {
 class Dialog;
 }
 
-class QTreeWidget;
+class IncludeTreeModel;
+class QFileSystemWatcher;
+class QSortFilterProxyModel;
+class QTimer;
+class QTreeView;
+class include_tree;
+class incremental_tree_filter;
+struct loaded_diff;
+struct loaded_graphs;
+struct recommended_pch;
 
 // -----------------------------------------------------------------------------
 //
@@ -47,6 +58,10 @@ public:
 private slots:
 
     void filterTextChanged(QString const& filter_text);
+    void watchToggled(bool watch);
+    void compareClicked();
+    void updateOffenders();
+    void updatePch();
 
 private:
 
@@ -59,13 +74,44 @@ private:
 
     // -------------------------------------------------------------------------
     // private helpers.
-    void populateTrees();
-    void filterTreeBuilt(QTreeWidget* new_widget);
+    void loadFiles(bool reload);
+    void logChanged();
+    void watchLoadedFiles();
+    void showChanges(loaded_graphs const& graphs);
+    void graphsLoaded(std::shared_ptr<loaded_graphs> graphs);
+    void loadProgress(QString const& stage, int percent);
+    void populateTrees(loaded_graphs const& graphs);
+    void filterTreeBuilt(std::shared_ptr<include_tree const> new_tree);
+    void setupTreeView(QTreeView* view, IncludeTreeModel* model);
+    void showErrors(std::vector<std::string> const& errors);
+    void diffLoaded(std::shared_ptr<loaded_diff> diff);
+    void clearDiff();
+    void pchRecommended(std::shared_ptr<recommended_pch> recommended);
+    void includeContextMenu(QPoint const& pos);
+    void showIncludeChains(QModelIndex const& index);
 
     Ui::Dialog *ui;
-    std::unique_ptr<cpp_dep::include_graph_t> include_graph_;
-    std::unique_ptr<cpp_dep::include_graph_t> filesystem_graph_;
-    async_ui_task<QTreeWidget*> update_tree_widget_;
+    IncludeTreeModel* include_model_;
+    IncludeTreeModel* filesystem_model_;
+    std::shared_ptr<cpp_dep::include_graph_t const> include_graph_;
+    std::shared_ptr<cpp_dep::include_graph_t const> filesystem_graph_;
+    std::shared_ptr<incremental_tree_filter> include_filter_;
+
+    // The include tree as filtered, and which headers it shows.
+    std::shared_ptr<include_tree const> shown_tree_;
+    std::vector<char> shown_headers_;
+    async_ui_task<std::shared_ptr<include_tree const>> update_include_tree_;
+    async_ui_task<std::shared_ptr<loaded_graphs>> load_graphs_;
+    async_ui_task<std::shared_ptr<loaded_diff>> load_diff_;
+    async_ui_task<std::shared_ptr<recommended_pch>> recommend_pch_;
+    QString loading_name_;
+
+    // What was dropped last, reloaded when watching.
+    std::vector<std::string> loaded_files_;
+    std::shared_ptr<loaded_graphs const> loaded_graphs_;
+    QFileSystemWatcher* log_watcher_;
+    QTimer* reload_timer_;
+    bool reloading_;
 };
 
 #endif // _UI_DIALOG_H_
@@ -0,0 +1,397 @@
+// *****************************************************************************
+//
+// ui/graph_loader.cpp
+//
+// Loads include logs into everything the dialog shows.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "ui/graph_loader.hpp"
+#include "analysis/compile_driver.hpp"
+#include "analysis/dominator_tree.hpp"
+#include "analysis/size_changes.hpp"
+#include "ui/removal_simulator.hpp"
+#include "ui/tree_view_builder.hpp"
+#include "util/incremental_tree_filter.hpp"
+#include "parse/compile_commands.hpp"
+#include "parse/graph_snapshot.hpp"
+#include "parse/time_trace.hpp"
+#include <algorithm>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+struct input_files
+{
+    std::vector<std::string> logs;
+    std::vector<std::string> databases;
+    std::vector<std::string> traces;
+
+    bool single_log() const
+    {
+        return logs.size() == 1 && databases.empty();
+    }
+};
+
+input_files classify_inputs(std::vector<std::string> files)
+{
+    input_files inputs;
+    auto first_database = std::stable_partition(
+        files.begin(), files.end(),
+        [](std::string const& file)
+        {
+            return !is_compile_commands_filename(file);
+        }
+    );
+
+    inputs.databases.assign(first_database, files.end());
+    files.erase(first_database, files.end());
+
+    auto first_trace = std::stable_partition(
+        files.begin(), files.end(),
+        [](std::string const& file)
+        {
+            return !is_time_trace_filename(file);
+        }
+    );
+
+    inputs.traces.assign(first_trace, files.end());
+    files.erase(first_trace, files.end());
+    if(files.empty() && inputs.databases.empty())
+        throw std::runtime_error("No include logs found");
+
+    inputs.logs = std::move(files);
+    return inputs;
+}
+
+// Reads the logs and compile databases into one graph, merging them if
+// there's more than one log. Fills in result's errors and aggregate_stats.
+// The path graph is only built if with_paths is set.
+std::shared_ptr<graph_snapshot> read_include_graphs(
+    input_files const& inputs,
+    bool with_paths,
+    task_monitor& monitor,
+    loaded_graphs& result)
+{
+    if(inputs.single_log())
+    {
+        // Reopening a log comes straight from its snapshot.
+        return load_include_log(inputs.logs.front(), with_paths, 0, &monitor);
+    }
+
+    include_aggregate aggregate = aggregate_deps_files(inputs.logs, 0, &monitor);
+    for(auto&& database : inputs.databases)
+    {
+        aggregate.merge(aggregate_compile_commands(
+            read_compile_commands(database), 0, &monitor));
+    }
+
+    result.errors = aggregate.errors();
+    result.aggregate_stats = std::make_shared<
+        aggregate_stats_t
+    >(aggregate.stats());
+
+    auto graphs = std::make_shared<graph_snapshot>();
+    graphs->includes = aggregate.graph();
+    if(!with_paths)
+        return graphs;
+
+    report_progress(&monitor, "Building path tree", 0);
+    graphs->paths = cpp_dep::invert_to_paths(graphs->includes);
+    graphs->has_paths = true;
+    return graphs;
+}
+
+// -----------------------------------------------------------------------------
+//
+// Everything result needs that's worked out from the graphs alone.
+void build_views(
+    std::shared_ptr<graph_snapshot> const& graphs,
+    task_monitor& monitor,
+    loaded_graphs& result)
+{
+    report_progress(&monitor, "Computing dominators", 0);
+    result.exclusive_sizes = std::make_shared<
+        std::vector<std::size_t>
+    >(exclusive_sizes(graphs->includes));
+
+    report_progress(&monitor, "Indexing includers", 0);
+    result.include_chains = std::make_shared<
+        include_chain_index
+    >(graphs->includes);
+
+    report_progress(&monitor, "Rolling up directories", 0);
+    result.path_rollups = std::make_shared<
+        path_rollups_t
+    >(rollup_paths(graphs->paths, graphs->includes));
+
+    // Both graphs share the snapshot's lifetime, adjacency_list
+    // can't be moved out without a copy.
+    result.include_graph = std::shared_ptr<
+        cpp_dep::include_graph_t const
+    >(graphs, &graphs->includes);
+
+    result.filesystem_graph = std::shared_ptr<
+        cpp_dep::include_graph_t const
+    >(graphs, &graphs->paths);
+
+    report_progress(&monitor, "Interning names", 0);
+    {
+        auto table = std::make_shared<path_table>();
+        auto include_paths = std::make_shared<vertex_paths>();
+        auto filesystem_paths = std::make_shared<vertex_paths>();
+        include_paths->ids = intern_vertex_names(*table, graphs->includes);
+        filesystem_paths->ids = intern_vertex_names(*table, graphs->paths);
+        table->finalise();
+
+        include_paths->table = table;
+        filesystem_paths->table = table;
+        result.include_paths = include_paths;
+        result.filesystem_paths = filesystem_paths;
+    }
+
+    report_progress(&monitor, "Building views", 0);
+    {
+        tree_view_builder build_tree(tree_view_builder::option::none, &monitor);
+        result.filesystem_tree = build_tree(result.filesystem_graph);
+    }
+
+    report_progress(&monitor, "Building views", 50);
+
+    // The full include tree is built once per load and
+    // filtering works from that.
+    {
+        tree_view_builder build_tree(tree_view_builder::option::checkbox, &monitor);
+        std::shared_ptr<include_tree const> full_tree =
+            build_tree(result.include_graph);
+
+        result.removals = std::make_shared<removal_simulator>(*full_tree);
+        result.include_filter = std::make_shared<
+            incremental_tree_filter
+        >(std::move(full_tree));
+    }
+
+    report_progress(&monitor, "Building views", 100);
+}
+
+// -----------------------------------------------------------------------------
+//
+// Takes what build_views() made for previous, whose graphs are the same as
+// the ones just loaded.
+void reuse_views(loaded_graphs const& previous, loaded_graphs& result)
+{
+    result.include_graph = previous.include_graph;
+    result.filesystem_graph = previous.filesystem_graph;
+    result.exclusive_sizes = previous.exclusive_sizes;
+    result.include_chains = previous.include_chains;
+    result.path_rollups = previous.path_rollups;
+    result.include_paths = previous.include_paths;
+    result.filesystem_paths = previous.filesystem_paths;
+    result.filesystem_tree = previous.filesystem_tree;
+    result.removals = previous.removals;
+    result.include_filter = previous.include_filter;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+//
+std::shared_ptr<loaded_graphs> load_graphs(
+    std::vector<std::string> files,
+    task_monitor& monitor,
+    std::shared_ptr<loaded_graphs const> previous)
+{
+    auto result = std::make_shared<loaded_graphs>();
+    try
+    {
+        files = expand_log_paths(files);
+
+        // Fingerprinted before reading so a log rewritten while it's
+        // being parsed is picked up by the next reload.
+        result->inputs = files;
+        result->input_fingerprints.reserve(files.size());
+        for(auto&& file : files)
+        {
+            try
+            {
+                result->input_fingerprints.push_back(fingerprint_log(file));
+            }
+            catch(std::exception&)
+            {
+                // Unreadable logs are reported when they're parsed.
+                result->input_fingerprints.push_back(log_fingerprint());
+            }
+        }
+
+        if(previous &&
+           previous->inputs == result->inputs &&
+           previous->input_fingerprints == result->input_fingerprints)
+        {
+            return nullptr;
+        }
+
+        input_files inputs = classify_inputs(files);
+        std::shared_ptr<graph_snapshot> graphs = read_include_graphs(inputs, true, monitor, *result);
+
+        report_progress(&monitor, "Counting translation units", 0);
+        if(result->aggregate_stats)
+        {
+            auto counts = std::make_shared<std::vector<std::size_t>>();
+            counts->reserve(result->aggregate_stats->size());
+            for(auto&& stats : *result->aggregate_stats)
+                counts->push_back(stats.num_translation_units);
+
+            result->translation_units = counts;
+        }
+        else
+        {
+            result->translation_units = std::make_shared<
+                std::vector<std::size_t>
+            >(translation_unit_counts(graphs->includes));
+        }
+
+        // A build that rewrites the log without changing what it
+        // includes gives the same graphs back, so everything worked
+        // out from them can be kept, removals included.
+        if(previous && previous->include_graph &&
+           same_graph(*previous->include_graph, graphs->includes) &&
+           same_graph(*previous->filesystem_graph, graphs->paths))
+        {
+            report_progress(&monitor, "Reusing unchanged graphs", 0);
+            reuse_views(*previous, *result);
+        }
+        else
+        {
+            build_views(graphs, monitor, *result);
+        }
+
+        if(previous && previous->include_graph)
+        {
+            report_progress(&monitor, "Comparing", 0);
+            result->changes = std::make_shared<
+                size_changes
+            >(compare_sizes(*previous->include_graph, *result->include_graph));
+        }
+
+        // Timings are optional, so a bad trace is reported but
+        // doesn't stop the load.
+        time_report times;
+        std::vector<std::string> timed_files = inputs.traces;
+        if(inputs.single_log())
+            timed_files.push_back(inputs.logs.front());
+
+        for(std::size_t i = 0; i < timed_files.size(); ++i)
+        {
+            report_progress(&monitor, "Reading timings", static_cast<int>((i * 100) / timed_files.size()));
+            try
+            {
+                times.merge(read_time_report(timed_files[i]));
+            }
+            catch(std::exception& e)
+            {
+                result->errors.push_back(timed_files[i] + ": " + e.what());
+            }
+        }
+
+        if(!times.header_seconds.empty())
+        {
+            result->header_times = std::make_shared<
+                std::vector<double>
+            >(attach_header_times(times, *result->include_graph));
+        }
+    }
+    catch(task_cancelled&)
+    {
+        throw;
+    }
+    catch(std::exception& e)
+    {
+        // Keep the fingerprints so a log that's broken until the
+        // build rewrites it isn't retried until then.
+        auto failed = std::make_shared<loaded_graphs>();
+        failed->inputs = std::move(result->inputs);
+        failed->input_fingerprints = std::move(result->input_fingerprints);
+        failed->error = e.what();
+        result = failed;
+    }
+
+    return result;
+}
+
+// -----------------------------------------------------------------------------
+//
+std::shared_ptr<loaded_diff> load_diff(
+    std::vector<std::string> baseline_files,
+    std::shared_ptr<loaded_graphs const> current,
+    task_monitor& monitor)
+{
+    auto result = std::make_shared<loaded_diff>();
+    try
+    {
+        input_files inputs = classify_inputs(expand_log_paths(baseline_files));
+        loaded_graphs baseline;
+        std::shared_ptr<graph_snapshot> graphs = read_include_graphs(inputs, false, monitor, baseline);
+        result->errors = std::move(baseline.errors);
+
+        // A single log's cost is its cost in its one translation unit,
+        // so it compares like for like with an aggregate's.
+        report_progress(&monitor, "Comparing", 0);
+        diff_input before;
+        before.graph = &graphs->includes;
+        before.costs = project_costs(graphs->includes, baseline.aggregate_stats.get());
+        before.logs = inputs.logs;
+
+        diff_input after;
+        after.graph = current->include_graph.get();
+        after.costs = project_costs(*current->include_graph, current->aggregate_stats.get());
+        after.logs = current->inputs;
+
+        result->diff = std::make_shared<graph_diff const>(diff_graphs(before, after));
+        report_progress(&monitor, "Comparing", 100);
+    }
+    catch(task_cancelled&)
+    {
+        throw;
+    }
+    catch(std::exception& e)
+    {
+        result->error = e.what();
+    }
+
+    return result;
+}
+
+// -----------------------------------------------------------------------------
+//
+std::shared_ptr<recommended_pch> recommend_loaded_pch(
+    std::shared_ptr<loaded_graphs const> graphs,
+    pch_options const& options,
+    task_monitor& monitor)
+{
+    auto result = std::make_shared<recommended_pch>();
+    result->graphs = graphs;
+
+    try
+    {
+        report_progress(&monitor, "Picking precompiled headers", 0);
+        result->pch = recommend_pch(
+            *graphs->include_graph, *graphs->translation_units, options, &monitor);
+        report_progress(&monitor, "Picking precompiled headers", 100);
+    }
+    catch(task_cancelled&)
+    {
+        throw;
+    }
+    catch(std::exception& e)
+    {
+        result->error = e.what();
+    }
+
+    return result;
+}
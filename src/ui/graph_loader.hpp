@@ -0,0 +1,146 @@
+// *****************************************************************************
+//
+// ui/graph_loader.hpp
+//
+// Loads include logs into everything the dialog shows, as one unit of work
+// that can run off the UI thread. Stages are parse, stat sizes, dominators,
+// invert to paths and build views, each reported through the task_monitor.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_UI_GRAPHLOADER_HPP_
+#define CPPSIZE_UI_GRAPHLOADER_HPP_
+
+#include "analysis/graph_diff.hpp"
+#include "analysis/include_aggregate.hpp"
+#include "analysis/include_chains.hpp"
+#include "analysis/path_rollups.hpp"
+#include "analysis/pch_recommender.hpp"
+#include "analysis/size_changes.hpp"
+#include "parse/graph_snapshot.hpp"
+#include "util/path_table.hpp"
+#include "util/task_monitor.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+class include_tree;
+class incremental_tree_filter;
+class removal_simulator;
+
+// -----------------------------------------------------------------------------
+//
+struct loaded_graphs
+{
+    std::shared_ptr<cpp_dep::include_graph_t const> include_graph;
+    std::shared_ptr<cpp_dep::include_graph_t const> filesystem_graph;
+    std::shared_ptr<incremental_tree_filter> include_filter;
+    std::shared_ptr<include_tree const> filesystem_tree;
+
+    // What-if state for unchecked includes, over the full include tree.
+    std::shared_ptr<removal_simulator> removals;
+
+    // Bytes each header takes with it if removed, from the dominator tree.
+    std::shared_ptr<std::vector<std::size_t> const> exclusive_sizes;
+
+    // Chains of includes that reach each header.
+    std::shared_ptr<include_chain_index const> include_chains;
+
+    // Per directory totals over the filesystem graph.
+    std::shared_ptr<path_rollups_t const> path_rollups;
+
+    // Names of both graphs interned into one shared path_table.
+    std::shared_ptr<vertex_paths const> include_paths;
+    std::shared_ptr<vertex_paths const> filesystem_paths;
+
+    // Per vertex frontend time, only set if timings were found.
+    std::shared_ptr<std::vector<double> const> header_times;
+
+    // Only set when several logs were merged.
+    std::shared_ptr<aggregate_stats_t const> aggregate_stats;
+
+    // Translation units that include each vertex, see
+    // translation_unit_counts().
+    std::shared_ptr<std::vector<std::size_t> const> translation_units;
+
+    // Only set when reloading, against the graph that was replaced.
+    std::shared_ptr<size_changes const> changes;
+
+    // Every file the load read, in order, so a reload can tell whether
+    // anything changed.
+    std::vector<std::string> inputs;
+    std::vector<log_fingerprint> input_fingerprints;
+
+    // Logs that failed when merging several.
+    std::vector<std::string> errors;
+
+    // Set instead of the graphs if loading failed outright.
+    std::string error;
+};
+
+// A single log is loaded as is, several logs or directories of logs are
+// merged. Clang -ftime-trace files among them, and msvc /d1reportTime
+// output in a single log, give the headers timings. Throws task_cancelled
+// if the monitor asks to stop, other errors are returned in
+// loaded_graphs::error.
+//
+// Reloads pass the graphs being replaced as previous. If none of the files
+// changed since previous was loaded, nothing is loaded and null is
+// returned, otherwise the headers are compared with previous to fill in
+// loaded_graphs::changes. Unchanged logs among several come from their
+// snapshots, but a changed log is parsed again in full, a text log having
+// nothing to patch a previous graph from. If that gives the same graphs
+// as previous, everything else previous worked out from them is shared
+// rather than built again.
+std::shared_ptr<loaded_graphs> load_graphs(
+    std::vector<std::string> files,
+    task_monitor& monitor,
+    std::shared_ptr<loaded_graphs const> previous = nullptr);
+
+// -----------------------------------------------------------------------------
+//
+struct loaded_diff
+{
+    std::shared_ptr<graph_diff const> diff;
+
+    // Logs that failed when merging several.
+    std::vector<std::string> errors;
+
+    // Set instead of the diff if loading failed outright.
+    std::string error;
+};
+
+// Loads baseline_files the same way load_graphs() does and compares them
+// with current, the baseline being the before side. Throws task_cancelled
+// if the monitor asks to stop, other errors are returned in
+// loaded_diff::error.
+std::shared_ptr<loaded_diff> load_diff(
+    std::vector<std::string> baseline_files,
+    std::shared_ptr<loaded_graphs const> current,
+    task_monitor& monitor);
+
+// -----------------------------------------------------------------------------
+//
+struct recommended_pch
+{
+    // What the pch was picked from.
+    std::shared_ptr<loaded_graphs const> graphs;
+    pch_recommendation pch;
+
+    // Set instead of the pch if picking failed.
+    std::string error;
+};
+
+// Picks a pch for graphs, see recommend_pch(). Throws task_cancelled if the
+// monitor asks to stop.
+std::shared_ptr<recommended_pch> recommend_loaded_pch(
+    std::shared_ptr<loaded_graphs const> graphs,
+    pch_options const& options,
+    task_monitor& monitor);
+
+#endif // CPPSIZE_UI_GRAPHLOADER_HPP_
@@ -0,0 +1,186 @@
+// *****************************************************************************
+//
+// ui/include_tree.hpp
+//
+// Compact, Qt free record of the inferred include tree. Each node is a few
+// integers referring back into the include graph so that the item model
+// can build display data on demand instead of up front.
+//
+// The whole tree is still walked when a log is loaded, one node per edge
+// the walk takes, rather than expanded a level at a time. Order and
+// occurence come out of that one walk, and the tree filter and removal
+// simulator both need every node anyway. What's deferred is everything
+// Qt, which was most of the cost: rows, strings and sizes only exist
+// for what the view has fetched.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_UI_INCLUDETREE_HPP_
+#define CPPSIZE_UI_INCLUDETREE_HPP_
+
+#include "cpp_dep/cpp_dep.hpp"
+#include <boost/range/iterator_range.hpp>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+class include_tree
+{
+public:
+
+    typedef std::uint32_t node_index_t;
+    typedef boost::iterator_range<node_index_t const*> child_range_t;
+
+    enum : node_index_t
+    {
+        npos = ~node_index_t(0)
+    };
+
+    struct node
+    {
+        cpp_dep::include_vertex_descriptor_t vertex;
+        node_index_t parent;
+        node_index_t root;
+        node_index_t row;
+        int order;
+    };
+
+    include_tree(
+        std::shared_ptr<cpp_dep::include_graph_t const> graph,
+        std::uint32_t options)
+        : graph_(std::move(graph))
+        , options_(options)
+        , occurence_(boost::num_vertices(*graph_), 0)
+    {}
+
+    node_index_t add_node(
+        node_index_t parent,
+        cpp_dep::include_vertex_descriptor_t vertex,
+        int order,
+        int occurence)
+    {
+        node n;
+        n.vertex = vertex;
+        n.parent = parent;
+        n.root = parent == npos ? node_index_t(nodes_.size()) : nodes_[parent].root;
+        n.row = 0;
+        n.order = order;
+        nodes_.push_back(n);
+        occurence_[vertex] = occurence;
+        return node_index_t(nodes_.size() - 1);
+    }
+
+    // Builds the child lists. Must be called once all nodes are added.
+    void finalise()
+    {
+        // Bucket num_nodes holds the roots.
+        std::size_t num_nodes = nodes_.size();
+        child_offsets_.assign(num_nodes + 2, 0);
+        for(auto&& n : nodes_)
+        {
+            ++child_offsets_[bucket(n.parent) + 1];
+        }
+
+        std::partial_sum(
+            child_offsets_.begin(),
+            child_offsets_.end(),
+            child_offsets_.begin());
+
+        children_.resize(num_nodes);
+        std::vector<node_index_t> fill(
+            child_offsets_.begin(),
+            child_offsets_.end() - 1);
+
+        for(node_index_t i = 0; i < num_nodes; ++i)
+        {
+            std::size_t b = bucket(nodes_[i].parent);
+            nodes_[i].row = fill[b] - child_offsets_[b];
+            children_[fill[b]++] = i;
+        }
+    }
+
+    std::size_t size() const
+    {
+        return nodes_.size();
+    }
+
+    node const& operator[](node_index_t i) const
+    {
+        return nodes_[i];
+    }
+
+    // Children of i, or the roots if i is npos.
+    child_range_t children(node_index_t i) const
+    {
+        std::size_t b = bucket(i);
+        return child_range_t(
+            children_.data() + child_offsets_[b],
+            children_.data() + child_offsets_[b + 1]);
+    }
+
+    cpp_dep::include_vertex_t const& file(node_index_t i) const
+    {
+        return (*graph_)[nodes_[i].vertex];
+    }
+
+    std::size_t file_size(node_index_t i) const
+    {
+        cpp_dep::include_vertex_t const& f = file(i);
+        return f.size + f.size_dependencies;
+    }
+
+    std::size_t total_size(node_index_t i) const
+    {
+        return file_size(nodes_[i].root);
+    }
+
+    int occurence(node_index_t i) const
+    {
+        return occurence_[nodes_[i].vertex];
+    }
+
+    // The same, for a vertex with a node in the tree.
+    int vertex_occurence(cpp_dep::include_vertex_descriptor_t v) const
+    {
+        return occurence_[v];
+    }
+
+    cpp_dep::include_graph_t const& graph() const
+    {
+        return *graph_;
+    }
+
+    std::shared_ptr<cpp_dep::include_graph_t const> const& graph_ptr() const
+    {
+        return graph_;
+    }
+
+    std::uint32_t options() const
+    {
+        return options_;
+    }
+
+private:
+
+    std::size_t bucket(node_index_t i) const
+    {
+        return i == npos ? nodes_.size() : i;
+    }
+
+    std::shared_ptr<cpp_dep::include_graph_t const> graph_;
+    std::uint32_t options_;
+    std::vector<node> nodes_;
+    std::vector<int> occurence_;
+    std::vector<std::uint32_t> child_offsets_;
+    std::vector<node_index_t> children_;
+};
+
+#endif // CPPSIZE_UI_INCLUDETREE_HPP_
@@ -0,0 +1,565 @@
+// *****************************************************************************
+//
+// ui/include_tree_model.cpp
+//
+// Item model over an include_tree.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "ui/include_tree_model.hpp"
+#include "ui/tree_view_builder.hpp"
+#include <QBrush>
+#include <algorithm>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+    // Number of rows handed to the view per fetchMore so that expanding a
+    // header with thousands of direct includes stays responsive.
+    int const kFetchBatchSize = 256;
+
+    QString formatDelta(qint64 delta)
+    {
+        QString sign = delta > 0 ? "+" : "-";
+        qint64 magnitude = delta < 0 ? -delta : delta;
+        if(magnitude < 1024)
+            return sign + QString::number(magnitude) + "b";
+
+        return sign + QString::number((magnitude + 1023) / 1024) + "kb";
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+IncludeTreeModel::IncludeTreeModel(QStringList headers, QObject* parent)
+    : QAbstractItemModel(parent)
+    , headers_(std::move(headers))
+{}
+
+// -----------------------------------------------------------------------------
+//
+void IncludeTreeModel::setTree(std::shared_ptr<include_tree const> tree)
+{
+    beginResetModel();
+    tree_ = std::move(tree);
+    fetched_.assign(tree_ ? tree_->size() + 1 : 0, 0);
+    endResetModel();
+}
+
+// -----------------------------------------------------------------------------
+//
+void IncludeTreeModel::setAggregateStats(std::shared_ptr<aggregate_stats_t const> stats)
+{
+    beginResetModel();
+    aggregate_stats_ = std::move(stats);
+    endResetModel();
+}
+
+// -----------------------------------------------------------------------------
+//
+void IncludeTreeModel::setRemovalSimulator(std::shared_ptr<removal_simulator> removals)
+{
+    beginResetModel();
+    removals_ = std::move(removals);
+    endResetModel();
+}
+
+// -----------------------------------------------------------------------------
+//
+void IncludeTreeModel::setExclusiveSizes(std::shared_ptr<std::vector<std::size_t> const> sizes)
+{
+    beginResetModel();
+    exclusive_sizes_ = std::move(sizes);
+    endResetModel();
+}
+
+// -----------------------------------------------------------------------------
+//
+void IncludeTreeModel::setVertexPaths(std::shared_ptr<vertex_paths const> paths)
+{
+    beginResetModel();
+    paths_ = std::move(paths);
+    endResetModel();
+}
+
+// -----------------------------------------------------------------------------
+//
+void IncludeTreeModel::setHeaderTimes(std::shared_ptr<std::vector<double> const> times)
+{
+    beginResetModel();
+    header_times_ = std::move(times);
+    endResetModel();
+}
+
+// -----------------------------------------------------------------------------
+//
+void IncludeTreeModel::setSizeChanges(std::shared_ptr<size_changes const> changes)
+{
+    beginResetModel();
+    size_changes_ = std::move(changes);
+    endResetModel();
+}
+
+// -----------------------------------------------------------------------------
+//
+void IncludeTreeModel::setPathRollups(std::shared_ptr<path_rollups_t const> rollups)
+{
+    beginResetModel();
+    path_rollups_ = std::move(rollups);
+    endResetModel();
+}
+
+// -----------------------------------------------------------------------------
+//
+cpp_dep::include_vertex_descriptor_t IncludeTreeModel::vertex(QModelIndex const& index) const
+{
+    return (*tree_)[nodeIndex(index)].vertex;
+}
+
+// -----------------------------------------------------------------------------
+//
+cpp_dep::include_vertex_descriptor_t IncludeTreeModel::rootVertex(QModelIndex const& index) const
+{
+    return (*tree_)[(*tree_)[nodeIndex(index)].root].vertex;
+}
+
+// -----------------------------------------------------------------------------
+//
+void IncludeTreeModel::clear()
+{
+    setTree(nullptr);
+}
+
+// -----------------------------------------------------------------------------
+//
+QModelIndex IncludeTreeModel::index(int row, int column, QModelIndex const& parent) const
+{
+    if(!tree_ || row < 0 || column < 0 || column >= headers_.size())
+        return QModelIndex();
+
+    include_tree::node_index_t p = nodeIndex(parent);
+    if(row >= static_cast<int>(fetched_[fetchSlot(p)]))
+        return QModelIndex();
+
+    return createIndex(row, column, quintptr(tree_->children(p)[row]));
+}
+
+// -----------------------------------------------------------------------------
+//
+QModelIndex IncludeTreeModel::parent(QModelIndex const& index) const
+{
+    if(!tree_ || !index.isValid())
+        return QModelIndex();
+
+    include_tree::node_index_t p = (*tree_)[nodeIndex(index)].parent;
+    if(p == include_tree::npos)
+        return QModelIndex();
+
+    return createIndex((*tree_)[p].row, 0, quintptr(p));
+}
+
+// -----------------------------------------------------------------------------
+//
+int IncludeTreeModel::rowCount(QModelIndex const& parent) const
+{
+    if(!tree_ || parent.column() > 0)
+        return 0;
+
+    return fetched_[fetchSlot(nodeIndex(parent))];
+}
+
+// -----------------------------------------------------------------------------
+//
+int IncludeTreeModel::columnCount(QModelIndex const&) const
+{
+    return headers_.size();
+}
+
+// -----------------------------------------------------------------------------
+//
+bool IncludeTreeModel::hasChildren(QModelIndex const& parent) const
+{
+    if(!tree_ || parent.column() > 0)
+        return false;
+
+    return !tree_->children(nodeIndex(parent)).empty();
+}
+
+// -----------------------------------------------------------------------------
+//
+bool IncludeTreeModel::canFetchMore(QModelIndex const& parent) const
+{
+    if(!tree_ || parent.column() > 0)
+        return false;
+
+    include_tree::node_index_t p = nodeIndex(parent);
+    return fetched_[fetchSlot(p)] < tree_->children(p).size();
+}
+
+// -----------------------------------------------------------------------------
+//
+void IncludeTreeModel::fetchMore(QModelIndex const& parent)
+{
+    if(!canFetchMore(parent))
+        return;
+
+    include_tree::node_index_t p = nodeIndex(parent);
+    std::uint32_t& fetched = fetched_[fetchSlot(p)];
+    std::uint32_t available = static_cast<std::uint32_t>(tree_->children(p).size());
+    std::uint32_t count = std::min<std::uint32_t>(available - fetched, kFetchBatchSize);
+
+    beginInsertRows(parent, fetched, fetched + count - 1);
+    fetched += count;
+    endInsertRows();
+}
+
+// -----------------------------------------------------------------------------
+//
+QVariant IncludeTreeModel::data(QModelIndex const& index, int role) const
+{
+    if(!tree_ || !index.isValid())
+        return QVariant();
+
+    include_tree::node_index_t node = nodeIndex(index);
+    switch(role)
+    {
+    case Qt::DisplayRole:
+        return displayData(node, index.column());
+    case SortRole:
+        return sortData(node, index.column());
+    case Qt::TextAlignmentRole:
+        if(index.column() != ColFile)
+            return int(Qt::AlignRight | Qt::AlignVCenter);
+        break;
+    case Qt::ForegroundRole:
+        if(index.column() == ColFile || index.column() == ColChange)
+        {
+            if(size_change const* change = sizeChange(node))
+            {
+                switch(change->state)
+                {
+                case size_change::grown: return QBrush(Qt::darkRed);
+                case size_change::shrunk: return QBrush(Qt::darkGreen);
+                case size_change::added: return QBrush(Qt::darkBlue);
+                case size_change::unchanged: break;
+                }
+            }
+        }
+        break;
+    case Qt::CheckStateRole:
+        if(index.column() == ColFile && isCheckable(node))
+        {
+            cpp_dep::include_vertex_descriptor_t v = (*tree_)[node].vertex;
+            if(removals_->is_removed((*tree_)[(*tree_)[node].parent].vertex, v))
+                return Qt::Unchecked;
+
+            // Still in the tree here but no longer included from anywhere.
+            return removals_->is_included(v) ? Qt::Checked : Qt::PartiallyChecked;
+        }
+        break;
+    }
+
+    return QVariant();
+}
+
+// -----------------------------------------------------------------------------
+//
+bool IncludeTreeModel::setData(QModelIndex const& index, QVariant const& value, int role)
+{
+    if(!tree_ || !index.isValid() || role != Qt::CheckStateRole)
+        return false;
+
+    include_tree::node_index_t node = nodeIndex(index);
+    if(!isCheckable(node))
+        return false;
+
+    cpp_dep::include_vertex_descriptor_t parent = (*tree_)[(*tree_)[node].parent].vertex;
+    cpp_dep::include_vertex_descriptor_t child = (*tree_)[node].vertex;
+    bool changed = value.toInt() == Qt::Unchecked
+        ? removals_->remove_include(parent, child)
+        : removals_->restore_include(parent, child);
+
+    // A removal can change the sizes of every ancestor and of the same
+    // headers anywhere else in the tree, so refresh everything the view
+    // has been handed.
+    if(changed)
+    {
+        refreshFetchedRows();
+        emit removalsChanged();
+    }
+
+    return changed;
+}
+
+// -----------------------------------------------------------------------------
+//
+QVariant IncludeTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if(orientation != Qt::Horizontal || section < 0 || section >= headers_.size())
+        return QVariant();
+
+    if(role == Qt::DisplayRole)
+        return headers_[section];
+
+    return QVariant();
+}
+
+// -----------------------------------------------------------------------------
+//
+Qt::ItemFlags IncludeTreeModel::flags(QModelIndex const& index) const
+{
+    if(!index.isValid())
+        return Qt::NoItemFlags;
+
+    Qt::ItemFlags f = Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+    if(index.column() == ColFile && isCheckable(nodeIndex(index)))
+        f |= Qt::ItemIsUserCheckable;
+
+    return f;
+}
+
+// -----------------------------------------------------------------------------
+//
+include_tree::node_index_t IncludeTreeModel::nodeIndex(QModelIndex const& index) const
+{
+    if(!index.isValid())
+        return include_tree::npos;
+
+    return static_cast<include_tree::node_index_t>(index.internalId());
+}
+
+// -----------------------------------------------------------------------------
+//
+std::size_t IncludeTreeModel::fetchSlot(include_tree::node_index_t node) const
+{
+    return node == include_tree::npos ? tree_->size() : node;
+}
+
+// -----------------------------------------------------------------------------
+//
+QVariant IncludeTreeModel::displayData(include_tree::node_index_t node, int column) const
+{
+    switch(column)
+    {
+    case ColFile:
+        return fileName(node);
+    case ColSize:
+        return QString::number((qint64(fileSize(node)) + 1023) / 1024) + "kb";
+    case ColPercent:
+    {
+        qint64 total_size = totalSize(node);
+        qint64 percent = total_size ? (qint64(fileSize(node)) * 100) / total_size : 0;
+        return QString::number(percent) + "%";
+    }
+    case ColOrder:
+        return QString::number((*tree_)[node].order);
+    case ColOccurence:
+        return QString::number(occurence(node));
+    case ColExclusive:
+        if(exclusive_sizes_)
+            return QString::number((qint64((*exclusive_sizes_)[(*tree_)[node].vertex]) + 1023) / 1024) + "kb";
+        break;
+    case ColTranslationUnits:
+        if(aggregate_stats_)
+            return QString::number(aggregateStats(node).num_translation_units);
+        break;
+    case ColProjectSize:
+        if(aggregate_stats_)
+            return QString::number((qint64(aggregateStats(node).transitive_size) + 1023) / 1024) + "kb";
+        break;
+    case ColTime:
+        if(header_times_)
+            return QString::number(headerTime(node) * 1000, 'f', 1) + "ms";
+        break;
+    case ColTimePercent:
+        if(header_times_)
+        {
+            double total = headerTime((*tree_)[node].root);
+            qint64 percent = total > 0 ? qint64((headerTime(node) * 100) / total) : 0;
+            return QString::number(percent) + "%";
+        }
+        break;
+    case ColChange:
+        if(size_change const* change = sizeChange(node))
+        {
+            if(change->state == size_change::added)
+                return tr("new");
+            if(change->state != size_change::unchanged)
+                return formatDelta(change->delta);
+        }
+        break;
+    case ColHeaders:
+        // A file's count of one says nothing.
+        if(path_rollups_ && !tree_->children(node).empty())
+            return QString::number(qint64(pathRollup(node).num_headers));
+        break;
+    }
+
+    return QVariant();
+}
+
+// -----------------------------------------------------------------------------
+//
+QVariant IncludeTreeModel::sortData(include_tree::node_index_t node, int column) const
+{
+    switch(column)
+    {
+    case ColFile:
+        if(paths_)
+            return qint64(paths_->table->rank(paths_->ids[(*tree_)[node].vertex]));
+        return fileName(node);
+    case ColSize:
+    case ColPercent:
+        return qint64(fileSize(node));
+    case ColOrder:
+        return (*tree_)[node].order;
+    case ColOccurence:
+        return occurence(node);
+    case ColExclusive:
+        if(exclusive_sizes_)
+            return qint64((*exclusive_sizes_)[(*tree_)[node].vertex]);
+        break;
+    case ColTranslationUnits:
+        if(aggregate_stats_)
+            return qint64(aggregateStats(node).num_translation_units);
+        break;
+    case ColProjectSize:
+        if(aggregate_stats_)
+            return qint64(aggregateStats(node).transitive_size);
+        break;
+    case ColTime:
+    case ColTimePercent:
+        if(header_times_)
+            return headerTime(node);
+        break;
+    case ColChange:
+        if(size_change const* change = sizeChange(node))
+            return qint64(change->delta);
+        break;
+    case ColHeaders:
+        if(path_rollups_)
+            return qint64(pathRollup(node).num_headers);
+        break;
+    }
+
+    return QVariant();
+}
+
+// -----------------------------------------------------------------------------
+//
+QString IncludeTreeModel::fileName(include_tree::node_index_t node) const
+{
+    if(!paths_)
+        return QString::fromStdString(tree_->file(node).name);
+
+    // Only rows in view ask for their name, so it's built from the table
+    // each time rather than kept for every path.
+    return QString::fromStdString(paths_->table->str(paths_->ids[(*tree_)[node].vertex]));
+}
+
+// -----------------------------------------------------------------------------
+//
+double IncludeTreeModel::headerTime(include_tree::node_index_t node) const
+{
+    return (*header_times_)[(*tree_)[node].vertex];
+}
+
+// -----------------------------------------------------------------------------
+//
+size_change const* IncludeTreeModel::sizeChange(include_tree::node_index_t node) const
+{
+    if(!size_changes_)
+        return nullptr;
+
+    return &size_changes_->vertices[(*tree_)[node].vertex];
+}
+
+// -----------------------------------------------------------------------------
+//
+aggregate_header_stats const& IncludeTreeModel::aggregateStats(include_tree::node_index_t node) const
+{
+    return (*aggregate_stats_)[(*tree_)[node].vertex];
+}
+
+// -----------------------------------------------------------------------------
+//
+path_rollup const& IncludeTreeModel::pathRollup(include_tree::node_index_t node) const
+{
+    return (*path_rollups_)[(*tree_)[node].vertex];
+}
+
+// -----------------------------------------------------------------------------
+//
+bool IncludeTreeModel::wantsCheckboxes() const
+{
+    return tree_ && (tree_->options() & tree_view_builder::option::checkbox);
+}
+
+// -----------------------------------------------------------------------------
+//
+bool IncludeTreeModel::isCheckable(include_tree::node_index_t node) const
+{
+    // Top level items are translation units, there's no include to remove.
+    return removals_ && wantsCheckboxes() && (*tree_)[node].parent != include_tree::npos;
+}
+
+// -----------------------------------------------------------------------------
+//
+std::size_t IncludeTreeModel::fileSize(include_tree::node_index_t node) const
+{
+    if(path_rollups_)
+        return pathRollup(node).total_bytes;
+
+    if(removals_)
+        return removals_->file_size((*tree_)[node].vertex);
+
+    return tree_->file_size(node);
+}
+
+// -----------------------------------------------------------------------------
+//
+std::size_t IncludeTreeModel::totalSize(include_tree::node_index_t node) const
+{
+    return fileSize((*tree_)[node].root);
+}
+
+// -----------------------------------------------------------------------------
+//
+int IncludeTreeModel::occurence(include_tree::node_index_t node) const
+{
+    if(path_rollups_)
+        return static_cast<int>(pathRollup(node).inclusions);
+
+    if(removals_)
+        return tree_->occurence(node) - removals_->removed_includes((*tree_)[node].vertex);
+
+    return tree_->occurence(node);
+}
+
+// -----------------------------------------------------------------------------
+//
+void IncludeTreeModel::refreshFetchedRows()
+{
+    int last_column = headers_.size() - 1;
+    for(std::size_t slot = 0; slot < fetched_.size(); ++slot)
+    {
+        if(fetched_[slot] == 0)
+            continue;
+
+        QModelIndex parent;
+        if(slot != tree_->size())
+        {
+            include_tree::node_index_t p = static_cast<include_tree::node_index_t>(slot);
+            parent = createIndex((*tree_)[p].row, 0, quintptr(p));
+        }
+
+        emit dataChanged(
+            index(0, 0, parent),
+            index(fetched_[slot] - 1, last_column, parent));
+    }
+}
@@ -0,0 +1,159 @@
+// *****************************************************************************
+//
+// ui/include_tree_model.hpp
+//
+// Item model over an include_tree. Rows are only handed to the view as
+// their parent is expanded, and all column text is built on demand from
+// the include graph.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_UI_INCLUDETREEMODEL_HPP_
+#define CPPSIZE_UI_INCLUDETREEMODEL_HPP_
+
+#include "ui/include_tree.hpp"
+#include "analysis/include_aggregate.hpp"
+#include "analysis/path_rollups.hpp"
+#include "analysis/size_changes.hpp"
+#include "ui/removal_simulator.hpp"
+#include "util/path_table.hpp"
+#include <QAbstractItemModel>
+#include <QStringList>
+#include <memory>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+class IncludeTreeModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+
+    enum Col
+    {
+        ColFile,
+        ColSize,
+        ColPercent,
+        ColOrder,
+        ColOccurence,
+        ColExclusive,
+        ColTranslationUnits,
+        ColProjectSize,
+        ColTime,
+        ColTimePercent,
+        ColChange,
+        ColHeaders,
+    };
+
+    enum Role
+    {
+        // Raw value for the column, used by the sort proxy.
+        SortRole = Qt::UserRole,
+    };
+
+    // One column is shown per header, in Col order.
+    explicit IncludeTreeModel(QStringList headers, QObject* parent = nullptr);
+
+    void setTree(std::shared_ptr<include_tree const> tree);
+    void clear();
+
+    // Per vertex project wide stats when the graph is an aggregate of
+    // several logs, or null.
+    void setAggregateStats(std::shared_ptr<aggregate_stats_t const> stats);
+
+    // Unchecking an include removes it from the simulator and the size,
+    // percent and occurence columns then show what would be left. Shared
+    // between the full and filtered trees of the same graph.
+    void setRemovalSimulator(std::shared_ptr<removal_simulator> removals);
+
+    // Per vertex bytes that go away if the header is removed outright,
+    // see exclusive_sizes(), or null.
+    void setExclusiveSizes(std::shared_ptr<std::vector<std::size_t> const> sizes);
+
+    // Interned names for the tree's graph. With these each distinct name
+    // is converted to a QString once and sorts by rank, otherwise names
+    // come from the graph.
+    void setVertexPaths(std::shared_ptr<vertex_paths const> paths);
+
+    // Per vertex frontend time in seconds, see attach_header_times(), or
+    // null.
+    void setHeaderTimes(std::shared_ptr<std::vector<double> const> times);
+
+    // Per vertex change since the graph was last loaded, see
+    // compare_sizes(), or null. Changed headers are coloured and the
+    // change column shows the difference in bytes.
+    void setSizeChanges(std::shared_ptr<size_changes const> changes);
+
+    // Per vertex totals when the tree is of the path graph, see
+    // rollup_paths(), or null. The size, percent and occurence columns
+    // then show everything under a directory and the headers column how
+    // many files that is.
+    void setPathRollups(std::shared_ptr<path_rollups_t const> rollups);
+
+    // The vertex shown by a valid index of this model.
+    cpp_dep::include_vertex_descriptor_t vertex(QModelIndex const& index) const;
+
+    // The vertex at the top of the tree a valid index is shown under,
+    // the translation unit or log it was included from.
+    cpp_dep::include_vertex_descriptor_t rootVertex(QModelIndex const& index) const;
+
+    // -------------------------------------------------------------------------
+    // QAbstractItemModel overrides.
+    QModelIndex index(int row, int column, QModelIndex const& parent = QModelIndex()) const override;
+    QModelIndex parent(QModelIndex const& index) const override;
+    int rowCount(QModelIndex const& parent = QModelIndex()) const override;
+    int columnCount(QModelIndex const& parent = QModelIndex()) const override;
+    bool hasChildren(QModelIndex const& parent = QModelIndex()) const override;
+    bool canFetchMore(QModelIndex const& parent) const override;
+    void fetchMore(QModelIndex const& parent) override;
+    QVariant data(QModelIndex const& index, int role = Qt::DisplayRole) const override;
+    bool setData(QModelIndex const& index, QVariant const& value, int role = Qt::EditRole) override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(QModelIndex const& index) const override;
+
+signals:
+
+    // An include was unchecked or checked again, changing the
+    // simulator's sizes.
+    void removalsChanged();
+
+private:
+
+    include_tree::node_index_t nodeIndex(QModelIndex const& index) const;
+    std::size_t fetchSlot(include_tree::node_index_t node) const;
+    QVariant displayData(include_tree::node_index_t node, int column) const;
+    QVariant sortData(include_tree::node_index_t node, int column) const;
+    QString fileName(include_tree::node_index_t node) const;
+    double headerTime(include_tree::node_index_t node) const;
+    size_change const* sizeChange(include_tree::node_index_t node) const;
+    aggregate_header_stats const& aggregateStats(include_tree::node_index_t node) const;
+    path_rollup const& pathRollup(include_tree::node_index_t node) const;
+    bool wantsCheckboxes() const;
+    bool isCheckable(include_tree::node_index_t node) const;
+    std::size_t fileSize(include_tree::node_index_t node) const;
+    std::size_t totalSize(include_tree::node_index_t node) const;
+    int occurence(include_tree::node_index_t node) const;
+    void refreshFetchedRows();
+
+    QStringList headers_;
+    std::shared_ptr<include_tree const> tree_;
+    std::shared_ptr<aggregate_stats_t const> aggregate_stats_;
+    std::shared_ptr<removal_simulator> removals_;
+    std::shared_ptr<std::vector<std::size_t> const> exclusive_sizes_;
+    std::shared_ptr<vertex_paths const> paths_;
+    std::shared_ptr<std::vector<double> const> header_times_;
+    std::shared_ptr<size_changes const> size_changes_;
+    std::shared_ptr<path_rollups_t const> path_rollups_;
+
+    // Number of children handed to the view so far for each node. The last
+    // slot is for the top level items.
+    std::vector<std::uint32_t> fetched_;
+};
+
+#endif // CPPSIZE_UI_INCLUDETREEMODEL_HPP_
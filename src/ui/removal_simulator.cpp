@@ -0,0 +1,335 @@
+// *****************************************************************************
+//
+// ui/removal_simulator.cpp
+//
+// What-if bookkeeping for removing include edges.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#include "ui/removal_simulator.hpp"
+#include <boost/graph/strong_components.hpp>
+#include <algorithm>
+#include <numeric>
+
+// -----------------------------------------------------------------------------
+//
+removal_simulator::removal_simulator(include_tree const& full_tree)
+    : graph_(full_tree.graph_ptr())
+    , removed_bytes_(full_tree.size())
+{
+    cpp_dep::include_graph_t const& g = *graph_;
+    std::size_t num_vertices = boost::num_vertices(g);
+    std::size_t num_nodes = full_tree.size();
+
+    // Nodes are stored in visit order, so a subtree is a
+    // contiguous range starting at its root.
+    std::vector<std::uint32_t> node_end(num_nodes);
+    for(std::size_t n = num_nodes; n-- > 0; )
+    {
+        node_end[n] = std::max<std::uint32_t>(node_end[n], static_cast<std::uint32_t>(n + 1));
+        include_tree::node_index_t parent = full_tree[n].parent;
+        if(parent != include_tree::npos)
+            node_end[parent] = std::max(node_end[parent], node_end[n]);
+    }
+
+    position_.assign(num_vertices, include_tree::npos);
+    subtree_end_.assign(num_vertices, include_tree::npos);
+    included_.assign(num_vertices, false);
+    is_root_.assign(num_vertices, false);
+    for(include_tree::node_index_t n = 0; n < num_nodes; ++n)
+    {
+        vertex_t v = full_tree[n].vertex;
+        if(position_[v] == include_tree::npos)
+        {
+            position_[v] = n;
+            subtree_end_[v] = node_end[n];
+            included_[v] = true;
+        }
+
+        if(full_tree[n].parent == include_tree::npos)
+            is_root_[v] = true;
+    }
+
+    live_includes_.assign(num_vertices, 0);
+    for(auto v : boost::make_iterator_range(boost::vertices(g)))
+    {
+        if(!included_[v])
+            continue;
+
+        for(auto child : boost::make_iterator_range(boost::adjacent_vertices(v, g)))
+        {
+            ++live_includes_[child];
+        }
+    }
+
+    initial_includes_ = live_includes_;
+
+    // strong_components numbers a component only after every component
+    // it reaches, so walking them in number order sees what's below
+    // first.
+    std::vector<std::size_t> component(num_vertices);
+    std::size_t num_components = boost::strong_components(g, component.data());
+    std::vector<std::size_t> component_size(num_components, 0);
+    for(auto v : boost::make_iterator_range(boost::vertices(g)))
+        ++component_size[component[v]];
+
+    std::vector<vertex_t> by_component(num_vertices);
+    std::iota(by_component.begin(), by_component.end(), vertex_t(0));
+    std::sort(by_component.begin(), by_component.end(),
+        [&component](vertex_t a, vertex_t b)
+        {
+            return component[a] < component[b];
+        });
+
+    std::vector<bool> component_reaches_cycle(num_components, false);
+    for(vertex_t v : by_component)
+    {
+        std::size_t c = component[v];
+        if(component_size[c] > 1)
+            component_reaches_cycle[c] = true;
+
+        for(auto child : boost::make_iterator_range(boost::adjacent_vertices(v, g)))
+        {
+            if(child == v || component_reaches_cycle[component[child]])
+                component_reaches_cycle[c] = true;
+        }
+    }
+
+    reaches_cycle_.assign(num_vertices, false);
+    for(auto v : boost::make_iterator_range(boost::vertices(g)))
+        reaches_cycle_[v] = component_reaches_cycle[component[v]];
+
+    marks_.assign(num_vertices, 0);
+}
+
+// -----------------------------------------------------------------------------
+//
+bool removal_simulator::remove_include(vertex_t parent, vertex_t child)
+{
+    if(!removed_edges_.insert(edge_key(parent, child)).second)
+        return false;
+
+    if(!included_[parent])
+        return true;
+
+    std::vector<vertex_t> held;
+    live_includes_[child] -= edge_multiplicity(parent, child);
+    if(live_includes_[child] == 0 && !is_root_[child])
+        drop(child, held);
+    else if(reaches_cycle_[child])
+        held.push_back(child);
+
+    if(!held.empty())
+        drop_unsupported(held);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+//
+bool removal_simulator::restore_include(vertex_t parent, vertex_t child)
+{
+    if(removed_edges_.erase(edge_key(parent, child)) == 0)
+        return false;
+
+    if(!included_[parent])
+        return true;
+
+    live_includes_[child] += edge_multiplicity(parent, child);
+    if(!included_[child])
+        revive(child);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+//
+bool removal_simulator::is_removed(vertex_t parent, vertex_t child) const
+{
+    return removed_edges_.count(edge_key(parent, child)) != 0;
+}
+
+// -----------------------------------------------------------------------------
+//
+std::size_t removal_simulator::file_size(vertex_t v) const
+{
+    if(!included_[v])
+        return 0;
+
+    cpp_dep::include_vertex_t const& file = (*graph_)[v];
+    std::size_t size = file.size + file.size_dependencies;
+    if(position_[v] == include_tree::npos)
+        return size;
+
+    // Merged graphs take the largest size_dependencies seen for a header,
+    // which need not match this tree, so don't let it wrap.
+    std::size_t removed = static_cast<std::size_t>(
+        removed_bytes_.sum(position_[v], subtree_end_[v]));
+
+    return removed < size ? size - removed : 0;
+}
+
+// -----------------------------------------------------------------------------
+//
+int removal_simulator::edge_multiplicity(vertex_t parent, vertex_t child) const
+{
+    auto children = boost::adjacent_vertices(parent, *graph_);
+    return static_cast<int>(std::count(children.first, children.second, child));
+}
+
+// -----------------------------------------------------------------------------
+//
+void removal_simulator::drop(vertex_t v, std::vector<vertex_t>& held)
+{
+    // Anything still included from elsewhere keeps a non zero
+    // count and stops the walk, so only what really disappears
+    // is visited. A count kept up from inside a cycle can't be
+    // trusted, so those headers are handed back in held.
+    cpp_dep::include_graph_t const& g = *graph_;
+    std::vector<vertex_t> pending(1, v);
+    while(!pending.empty())
+    {
+        vertex_t u = pending.back();
+        pending.pop_back();
+
+        included_[u] = false;
+        if(position_[u] != include_tree::npos)
+            removed_bytes_.add(position_[u], static_cast<std::int64_t>(g[u].size));
+
+        for(auto child : boost::make_iterator_range(boost::adjacent_vertices(u, g)))
+        {
+            if(removed_edges_.count(edge_key(u, child)))
+                continue;
+
+            if(--live_includes_[child] > 0 && included_[child] && reaches_cycle_[child])
+                held.push_back(child);
+            else if(live_includes_[child] == 0 && included_[child] && !is_root_[child])
+                pending.push_back(child);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+void removal_simulator::drop_unsupported(std::vector<vertex_t> const& held)
+{
+    enum : std::uint8_t { unmarked, below_held, supported };
+
+    // Everything still included under the held headers is suspect.
+    // Whatever is included from outside that set is supported, as
+    // is whatever it includes, and the rest only had the cycles.
+    cpp_dep::include_graph_t const& g = *graph_;
+    std::vector<vertex_t> below;
+    for(vertex_t v : held)
+    {
+        if(included_[v] && !is_root_[v] && marks_[v] == unmarked)
+        {
+            marks_[v] = below_held;
+            below.push_back(v);
+        }
+    }
+
+    for(std::size_t i = 0; i < below.size(); ++i)
+    {
+        vertex_t u = below[i];
+        for(auto child : boost::make_iterator_range(boost::adjacent_vertices(u, g)))
+        {
+            if(included_[child] && !is_root_[child] && marks_[child] == unmarked &&
+               !removed_edges_.count(edge_key(u, child)))
+            {
+                marks_[child] = below_held;
+                below.push_back(child);
+            }
+        }
+    }
+
+    std::vector<vertex_t> pending;
+    for(vertex_t v : below)
+    {
+        for(auto e : boost::make_iterator_range(boost::in_edges(v, g)))
+        {
+            vertex_t parent = boost::source(e, g);
+            if(included_[parent] && marks_[parent] == unmarked &&
+               !removed_edges_.count(edge_key(parent, v)))
+            {
+                marks_[v] = supported;
+                pending.push_back(v);
+                break;
+            }
+        }
+    }
+
+    while(!pending.empty())
+    {
+        vertex_t u = pending.back();
+        pending.pop_back();
+        for(auto child : boost::make_iterator_range(boost::adjacent_vertices(u, g)))
+        {
+            if(marks_[child] == below_held && !removed_edges_.count(edge_key(u, child)))
+            {
+                marks_[child] = supported;
+                pending.push_back(child);
+            }
+        }
+    }
+
+    for(vertex_t v : below)
+    {
+        if(marks_[v] == below_held)
+        {
+            included_[v] = false;
+            if(position_[v] != include_tree::npos)
+                removed_bytes_.add(position_[v], static_cast<std::int64_t>(g[v].size));
+        }
+    }
+
+    for(vertex_t v : below)
+    {
+        if(marks_[v] == below_held)
+        {
+            for(auto child : boost::make_iterator_range(boost::adjacent_vertices(v, g)))
+            {
+                if(!removed_edges_.count(edge_key(v, child)))
+                    --live_includes_[child];
+            }
+        }
+    }
+
+    for(vertex_t v : below)
+        marks_[v] = unmarked;
+}
+
+// -----------------------------------------------------------------------------
+//
+void removal_simulator::revive(vertex_t v)
+{
+    cpp_dep::include_graph_t const& g = *graph_;
+    std::vector<vertex_t> pending(1, v);
+    included_[v] = true;
+    while(!pending.empty())
+    {
+        vertex_t u = pending.back();
+        pending.pop_back();
+
+        if(position_[u] != include_tree::npos)
+            removed_bytes_.add(position_[u], -static_cast<std::int64_t>(g[u].size));
+
+        for(auto child : boost::make_iterator_range(boost::adjacent_vertices(u, g)))
+        {
+            if(removed_edges_.count(edge_key(u, child)))
+                continue;
+
+            ++live_includes_[child];
+            if(!included_[child])
+            {
+                included_[child] = true;
+                pending.push_back(child);
+            }
+        }
+    }
+}
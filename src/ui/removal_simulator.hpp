@@ -0,0 +1,98 @@
+// *****************************************************************************
+//
+// ui/removal_simulator.hpp
+//
+// What-if bookkeeping for removing include edges. Each header keeps a count
+// of live includes from headers that are still pulled in, so removing an
+// edge only visits the headers that actually drop out. Bytes that drop out
+// are recorded against their position in the inferred include tree so the
+// loss under any header is a single range sum. Headers in an include cycle
+// can keep each other's counts up after everything else has let go of
+// them, so when a header that can reach a cycle survives a removal,
+// whatever is below it is checked again for a path from a translation
+// unit.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_UI_REMOVALSIMULATOR_HPP_
+#define CPPSIZE_UI_REMOVALSIMULATOR_HPP_
+
+#include "ui/include_tree.hpp"
+#include "util/fenwick_tree.hpp"
+#include <unordered_set>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+class removal_simulator
+{
+public:
+
+    typedef cpp_dep::include_vertex_descriptor_t vertex_t;
+
+    // full_tree must be the unfiltered include tree of its graph.
+    explicit removal_simulator(include_tree const& full_tree);
+
+    // Removes or restores every include of child from parent. Returns
+    // false if that didn't change anything.
+    bool remove_include(vertex_t parent, vertex_t child);
+    bool restore_include(vertex_t parent, vertex_t child);
+
+    bool is_removed(vertex_t parent, vertex_t child) const;
+
+    // False once nothing that is still included includes v.
+    bool is_included(vertex_t v) const
+    {
+        return included_[v];
+    }
+
+    // size + size_dependencies less whatever has been removed from
+    // under v, or 0 if v itself is no longer included.
+    std::size_t file_size(vertex_t v) const;
+
+    // Number of includes of v lost to removals so far.
+    int removed_includes(vertex_t v) const
+    {
+        return initial_includes_[v] - live_includes_[v];
+    }
+
+private:
+
+    static std::uint64_t edge_key(vertex_t parent, vertex_t child)
+    {
+        return (std::uint64_t(parent) << 32) | std::uint64_t(child);
+    }
+
+    int edge_multiplicity(vertex_t parent, vertex_t child) const;
+    void drop(vertex_t v, std::vector<vertex_t>& held);
+    void drop_unsupported(std::vector<vertex_t> const& held);
+    void revive(vertex_t v);
+
+    std::shared_ptr<cpp_dep::include_graph_t const> graph_;
+
+    // Position of the node where each vertex is first included, and the
+    // end of that node's subtree, in the inferred tree's visit order.
+    std::vector<std::uint32_t> position_;
+    std::vector<std::uint32_t> subtree_end_;
+
+    fenwick_tree removed_bytes_;
+    std::vector<int> live_includes_;
+    std::vector<int> initial_includes_;
+    std::vector<bool> included_;
+    std::vector<bool> is_root_;
+
+    // True for headers that can reach an include cycle in the full graph,
+    // the only ones whose count can be held up by a cycle.
+    std::vector<bool> reaches_cycle_;
+
+    // Scratch marks for drop_unsupported, all zero between calls.
+    std::vector<std::uint8_t> marks_;
+    std::unordered_set<std::uint64_t> removed_edges_;
+};
+
+#endif // CPPSIZE_UI_REMOVALSIMULATOR_HPP_
@@ -2,7 +2,8 @@
 //
 // ui/tree_view_builder.hpp
 //
-// Boost.Graph DFS visitor to construct a tree view from a boost graph.
+// Boost.Graph DFS visitor to construct the include_tree shown by a tree
+// view from a boost graph.
 //
 // Copyright Chris Glover 2015
 //
@@ -15,7 +16,8 @@
 #define CPPSIZE_UI_TREEVIEWBUILDER_HPP_
 
 #include <boost/graph/depth_first_search.hpp>
-#include "ui/include_tree_widget_item.hpp"
+#include "ui/include_tree.hpp"
+#include "util/task_monitor.hpp"
 #include "cpp_dep/inferred_include_visitor.hpp"
 
 // -----------------------------------------------------------------------------
@@ -35,18 +37,26 @@ public:
         };
     };
 
-    tree_view_builder_base(std::uint32_t options)
+    // A monitor that asks to stop makes the build throw task_cancelled
+    // part way through the walk.
+    tree_view_builder_base(std::uint32_t options, task_monitor const* monitor = nullptr)
         : options_(options)
+        , poll_(monitor)
     {}
 
-    void operator()(cpp_dep::include_graph_t const& g, QTreeWidget* root)
+    std::shared_ptr<include_tree> operator()(
+        std::shared_ptr<cpp_dep::include_graph_t const> const& g)
     {
-        current_item_ = nullptr;
+        auto tree = std::make_shared<include_tree>(g, options_);
+        tree_ = tree.get();
+        current_node_ = include_tree::npos;
         current_order_ = 0;
-        total_size_ = 0;
-        root_ = root;
 
-        this->visit(g);
+        this->visit(*g);
+
+        tree_->finalise();
+        tree_ = nullptr;
+        return tree;
     }
 
 private:
@@ -60,38 +70,18 @@ private:
 
     void root_file(cpp_dep::include_vertex_descriptor_t const& v, cpp_dep::include_graph_t const& g)
     {
-        cpp_dep::include_vertex_t const& file = g[v];
-
-        total_size_ = file.size + file.size_dependencies;
-        current_item_ = new IncludeTreeWidgetItem(root_);
-        current_item_->setColumnFile(file.name.c_str());
-        current_item_->setColumnSize(total_size_, total_size_);
-        current_item_->setColumnOrder(current_order_++);
-        current_item_->setColumnOccurence(this->get_include_count(v));
-
-        if(wants_checkboxes())
-        {
-            current_item_->showCheckbox();
-        }
+        poll_();
+        current_node_ = tree_->add_node(
+            include_tree::npos, v, current_order_++, this->get_include_count(v));
     }
 
     void include_file(cpp_dep::include_vertex_descriptor_t const& v, cpp_dep::include_graph_t const& g)
     {
+        poll_();
         if(!derived().filter(v, g))            return;
 
-        cpp_dep::include_vertex_t const& file = g[v];
-        
-        std::size_t show_size = file.size + file.size_dependencies;
-        current_item_ = new IncludeTreeWidgetItem(current_item_);
-        current_item_->setColumnFile(file.name.c_str());
-        current_item_->setColumnSize(show_size, total_size_);
-        current_item_->setColumnOrder(current_order_++);
-        current_item_->setColumnOccurence(this->get_include_count(v));
-
-        if(wants_checkboxes())
-        {
-            current_item_->showCheckbox();
-        }
+        current_node_ = tree_->add_node(
+            current_node_, v, current_order_++, this->get_include_count(v));
     }
 
     void finish_file(cpp_dep::include_vertex_descriptor_t const& v, cpp_dep::include_graph_t const& g)
@@ -99,7 +89,7 @@ private:
         if(!derived().filter(v, g))
             return;
 
-        current_item_ = current_item_->parent();
+        current_node_ = (*tree_)[current_node_].parent;
     }
 
     Derived& derived()
@@ -107,24 +97,19 @@ private:
         return *static_cast<Derived*>(this);
     }
 
-    bool wants_checkboxes() const
-    {
-        return (options_ & option::checkbox);
-    }
-
-    QTreeWidget* root_;
-    IncludeTreeWidgetItem* current_item_;
+    include_tree* tree_;
+    include_tree::node_index_t current_node_;
     int current_order_;
-    std::size_t total_size_;
     std::uint32_t options_;
+    cancellation_poll poll_;
 };
 
 // -----------------------------------------------------------------------------
 //
 struct tree_view_builder : tree_view_builder_base<tree_view_builder>
 {
-    tree_view_builder(std::uint32_t options)
-        : tree_view_builder_base(options)
+    tree_view_builder(std::uint32_t options, task_monitor const* monitor = nullptr)
+        : tree_view_builder_base(options, monitor)
     {}
 };
 
@@ -0,0 +1,61 @@
+// *****************************************************************************
+//
+// util/fenwick_tree.hpp
+//
+// Binary indexed tree giving O(log n) point updates and range sums.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_UTIL_FENWICKTREE_HPP_
+#define CPPSIZE_UTIL_FENWICKTREE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+class fenwick_tree
+{
+public:
+
+    explicit fenwick_tree(std::size_t size = 0)
+        : sums_(size + 1, 0)
+    {}
+
+    void add(std::size_t pos, std::int64_t delta)
+    {
+        for(++pos; pos < sums_.size(); pos += pos & (~pos + 1))
+        {
+            sums_[pos] += delta;
+        }
+    }
+
+    // Sum of [first, last).
+    std::int64_t sum(std::size_t first, std::size_t last) const
+    {
+        return prefix_sum(last) - prefix_sum(first);
+    }
+
+private:
+
+    std::int64_t prefix_sum(std::size_t end) const
+    {
+        std::int64_t total = 0;
+        for(; end > 0; end -= end & (~end + 1))
+        {
+            total += sums_[end];
+        }
+
+        return total;
+    }
+
+    std::vector<std::int64_t> sums_;
+};
+
+#endif // CPPSIZE_UTIL_FENWICKTREE_HPP_
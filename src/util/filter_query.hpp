@@ -0,0 +1,635 @@
+// *****************************************************************************
+//
+// util/filter_query.hpp
+//
+// The filter box query language. A query is whitespace separated terms and
+// a file matches when it matches every term:
+//
+//   text          name contains text
+//   ^text         name starts with text
+//   text$         name ends with text
+//   ^text$        name is text
+//   */detail/*    glob over the whole name, * is any run and ? any character
+//   size>100k     own size, with an optional k or m suffix
+//   count>=5      times the file is included
+//   -term         name, or number, must not match term
+//
+// Predicates compare with <, <=, >, >= or =. A term that isn't a well formed
+// predicate is matched as text, so a query half way through being typed
+// still filters sensibly.
+//
+// Every piece of text in a query is compiled once into a single Aho-Corasick
+// automaton, so testing a name is one pass over its characters whatever the
+// number of terms.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_UTIL_FILTERQUERY_HPP_
+#define CPPSIZE_UTIL_FILTERQUERY_HPP_
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+// Finds every occurrence of a set of patterns in one pass over the text.
+// Transitions are a full table per state, which is plenty small for the
+// handful of patterns a query holds.
+class pattern_automaton
+{
+public:
+
+    pattern_automaton()
+        : next_(kAlphabet, 0)
+        , fail_(1, 0)
+        , own_outputs_(1)
+    {}
+
+    // Returns the pattern's id. Adding the same text twice returns the
+    // same id.
+    std::size_t add(std::string const& pattern)
+    {
+        auto existing = std::find(patterns_.begin(), patterns_.end(), pattern);
+        if(existing != patterns_.end())
+            return existing - patterns_.begin();
+
+        std::uint32_t state = 0;
+        for(char c : pattern)
+        {
+            std::uint32_t& next = next_[state * kAlphabet + index(c)];
+            if(next == 0)
+            {
+                next = static_cast<std::uint32_t>(fail_.size());
+                next_.resize(next_.size() + kAlphabet, 0);
+                fail_.push_back(0);
+                own_outputs_.emplace_back();
+            }
+
+            // next_ may have moved.
+            state = next_[state * kAlphabet + index(c)];
+        }
+
+        std::size_t id = patterns_.size();
+        patterns_.push_back(pattern);
+        own_outputs_[state].push_back(static_cast<std::uint32_t>(id));
+        return id;
+    }
+
+    // Fills in the failure transitions. No patterns can be added after.
+    void finalise()
+    {
+        // Breadth first so a state's failure is done before its children.
+        std::deque<std::uint32_t> queue;
+        for(std::size_t c = 0; c < kAlphabet; ++c)
+        {
+            if(next_[c] != 0)
+                queue.push_back(next_[c]);
+        }
+
+        std::vector<std::uint32_t> order(1, 0);
+        while(!queue.empty())
+        {
+            std::uint32_t state = queue.front();
+            queue.pop_front();
+            order.push_back(state);
+
+            for(std::size_t c = 0; c < kAlphabet; ++c)
+            {
+                std::uint32_t& next = next_[state * kAlphabet + c];
+                std::uint32_t fallback = next_[fail_[state] * kAlphabet + c];
+                if(next == 0)
+                {
+                    next = fallback;
+                }
+                else
+                {
+                    fail_[next] = fallback;
+                    queue.push_back(next);
+                }
+            }
+        }
+
+        // A state also ends every pattern its failure chain ends.
+        output_offsets_.assign(fail_.size() + 1, 0);
+        std::vector<std::vector<std::uint32_t>> outputs(fail_.size());
+        for(std::uint32_t state : order)
+        {
+            outputs[state] = own_outputs_[state];
+            if(state != 0)
+            {
+                std::vector<std::uint32_t> const& inherited = outputs[fail_[state]];
+                outputs[state].insert(outputs[state].end(), inherited.begin(), inherited.end());
+            }
+        }
+
+        for(std::size_t state = 0; state < outputs.size(); ++state)
+        {
+            output_offsets_[state + 1] = output_offsets_[state] +
+                static_cast<std::uint32_t>(outputs[state].size());
+            outputs_.insert(outputs_.end(), outputs[state].begin(), outputs[state].end());
+        }
+
+        own_outputs_.clear();
+        own_outputs_.shrink_to_fit();
+    }
+
+    std::size_t size() const
+    {
+        return patterns_.size();
+    }
+
+    std::string const& pattern(std::size_t id) const
+    {
+        return patterns_[id];
+    }
+
+    // Calls on_match(id, end) for every occurrence, where end is one past
+    // the occurrence's last character.
+    template<typename OnMatch>
+    void scan(std::string const& text, OnMatch&& on_match) const
+    {
+        std::uint32_t state = 0;
+        for(std::size_t i = 0; i < text.size(); ++i)
+        {
+            state = next_[state * kAlphabet + index(text[i])];
+            for(std::uint32_t o = output_offsets_[state]; o < output_offsets_[state + 1]; ++o)
+                on_match(outputs_[o], i + 1);
+        }
+    }
+
+private:
+
+    static std::size_t const kAlphabet = 256;
+
+    static std::size_t index(char c)
+    {
+        return static_cast<unsigned char>(c);
+    }
+
+    std::vector<std::string> patterns_;
+    std::vector<std::uint32_t> next_;
+    std::vector<std::uint32_t> fail_;
+    std::vector<std::vector<std::uint32_t>> own_outputs_;
+    std::vector<std::uint32_t> output_offsets_;
+    std::vector<std::uint32_t> outputs_;
+};
+
+// -----------------------------------------------------------------------------
+//
+class filter_query
+{
+public:
+
+    // Matches everything.
+    filter_query()
+    {
+        patterns_.finalise();
+    }
+
+    explicit filter_query(std::string const& text)
+    {
+        std::size_t i = 0;
+        while(i < text.size())
+        {
+            while(i < text.size() && std::isspace(static_cast<unsigned char>(text[i])))
+                ++i;
+
+            std::size_t start = i;
+            while(i < text.size() && !std::isspace(static_cast<unsigned char>(text[i])))
+                ++i;
+
+            if(i > start)
+                add_term(text.substr(start, i - start));
+        }
+
+        patterns_.finalise();
+        hits_.resize(patterns_.size());
+    }
+
+    bool empty() const
+    {
+        return text_terms_.empty() && numeric_terms_.empty();
+    }
+
+    // Not safe to call from more than one thread at once, give each
+    // thread its own copy.
+    bool matches(std::string const& name, std::size_t size, std::size_t count) const
+    {
+        for(auto&& term : numeric_terms_)
+        {
+            std::size_t value = term.field == numeric_field::size ? size : count;
+            if(compare(value, term.op, term.value) == term.negated)
+                return false;
+        }
+
+        if(text_terms_.empty())
+            return true;
+
+        std::fill(hits_.begin(), hits_.end(), 0);
+        std::size_t length = name.size();
+        patterns_.scan(
+            name,
+            [this, length](std::size_t id, std::size_t end)
+            {
+                std::size_t begin = end - patterns_.pattern(id).size();
+                std::uint8_t hit = hit_anywhere;
+                if(begin == 0)
+                    hit |= hit_prefix;
+                if(end == length)
+                    hit |= hit_suffix;
+                if(begin == 0 && end == length)
+                    hit |= hit_exact;
+
+                hits_[id] |= hit;
+            }
+        );
+
+        for(auto&& term : text_terms_)
+        {
+            bool found;
+            if(term.kind == text_kind::glob)
+            {
+                found = (term.pattern == kNoPattern || hits_[term.pattern])
+                    && glob_match(term.text, name);
+            }
+            else
+            {
+                found = (hits_[term.pattern] & required_hit(term.kind)) != 0;
+            }
+
+            if(found == term.negated)
+                return false;
+        }
+
+        return true;
+    }
+
+    // Text every match must contain, for narrowing the candidates with a
+    // substring_index before testing them.
+    std::vector<std::string> const& required_substrings() const
+    {
+        return required_substrings_;
+    }
+
+    // True if everything this matches is also matched by previous, so only
+    // previous's matches need testing again.
+    bool refines(filter_query const& previous) const
+    {
+        if(previous.empty())
+            return false;
+
+        for(auto&& old_term : previous.numeric_terms_)
+        {
+            if(std::find(numeric_terms_.begin(), numeric_terms_.end(), old_term) == numeric_terms_.end())
+                return false;
+        }
+
+        for(auto&& old_term : previous.text_terms_)
+        {
+            bool implied = std::any_of(
+                text_terms_.begin(),
+                text_terms_.end(),
+                [&old_term](text_term const& new_term)
+                {
+                    return implies(new_term, old_term);
+                }
+            );
+
+            if(!implied)
+                return false;
+        }
+
+        return true;
+    }
+
+private:
+
+    enum class text_kind
+    {
+        contains,
+        prefix,
+        suffix,
+        exact,
+        glob,
+    };
+
+    enum class numeric_field
+    {
+        size,
+        count,
+    };
+
+    enum class compare_op
+    {
+        less,
+        less_equal,
+        greater,
+        greater_equal,
+        equal,
+    };
+
+    enum hit_flags : std::uint8_t
+    {
+        hit_anywhere = 1,
+        hit_prefix = 2,
+        hit_suffix = 4,
+        hit_exact = 8,
+    };
+
+    static std::size_t const kNoPattern = ~std::size_t(0);
+
+    struct text_term
+    {
+        text_kind kind;
+        bool negated;
+        std::string text;
+
+        // For a glob, its longest literal run, which it can't match without.
+        std::size_t pattern;
+    };
+
+    struct numeric_term
+    {
+        numeric_field field;
+        compare_op op;
+        std::size_t value;
+        bool negated;
+
+        bool operator==(numeric_term const& other) const
+        {
+            return field == other.field && op == other.op
+                && value == other.value && negated == other.negated;
+        }
+    };
+
+    void add_term(std::string token)
+    {
+        bool negated = token.size() > 1 && token[0] == '-';
+        if(negated)
+            token.erase(0, 1);
+
+        numeric_term numeric;
+        if(parse_predicate(token, numeric))
+        {
+            numeric.negated = negated;
+            numeric_terms_.push_back(numeric);
+            return;
+        }
+
+        text_term term;
+        term.negated = negated;
+        term.pattern = kNoPattern;
+        if(token.find_first_of("*?") != std::string::npos)
+        {
+            term.kind = text_kind::glob;
+            term.text = token;
+
+            std::string longest;
+            for(std::string const& run : literal_runs(token))
+            {
+                if(run.size() > longest.size())
+                    longest = run;
+                if(!negated && run.size() >= 3)
+                    required_substrings_.push_back(run);
+            }
+
+            if(!longest.empty())
+                term.pattern = patterns_.add(longest);
+
+            text_terms_.push_back(term);
+            return;
+        }
+
+        // A lone anchor is just text.
+        bool prefix = token.size() > 1 && token.front() == '^';
+        if(prefix)
+            token.erase(0, 1);
+
+        bool suffix = token.size() > 1 && token.back() == '$';
+        if(suffix)
+            token.pop_back();
+
+        if(prefix && suffix)
+            term.kind = text_kind::exact;
+        else if(prefix)
+            term.kind = text_kind::prefix;
+        else if(suffix)
+            term.kind = text_kind::suffix;
+        else
+            term.kind = text_kind::contains;
+
+        term.text = token;
+        term.pattern = patterns_.add(token);
+        if(!negated)
+            required_substrings_.push_back(token);
+
+        text_terms_.push_back(term);
+    }
+
+    // field op number, with an optional k or m suffix on the number.
+    static bool parse_predicate(std::string const& token, numeric_term& term)
+    {
+        std::size_t i;
+        if(token.compare(0, 4, "size") == 0)
+        {
+            term.field = numeric_field::size;
+            i = 4;
+        }
+        else if(token.compare(0, 5, "count") == 0)
+        {
+            term.field = numeric_field::count;
+            i = 5;
+        }
+        else
+        {
+            return false;
+        }
+
+        auto next_is = [&token, &i](char c)
+        {
+            return i < token.size() && token[i] == c;
+        };
+
+        if(next_is('<'))
+        {
+            ++i;
+            term.op = next_is('=') ? compare_op::less_equal : compare_op::less;
+        }
+        else if(next_is('>'))
+        {
+            ++i;
+            term.op = next_is('=') ? compare_op::greater_equal : compare_op::greater;
+        }
+        else if(next_is('='))
+        {
+            term.op = compare_op::equal;
+        }
+        else
+        {
+            return false;
+        }
+
+        if(next_is('='))
+            ++i;
+
+        std::size_t digits = i;
+        std::size_t value = 0;
+        while(i < token.size() && std::isdigit(static_cast<unsigned char>(token[i])))
+            value = value * 10 + (token[i++] - '0');
+
+        if(i == digits)
+            return false;
+
+        if(next_is('k') || next_is('K'))
+        {
+            value *= 1024;
+            ++i;
+        }
+        else if(next_is('m') || next_is('M'))
+        {
+            value *= 1024 * 1024;
+            ++i;
+        }
+
+        if(i != token.size())
+            return false;
+
+        term.value = value;
+        return true;
+    }
+
+    static bool compare(std::size_t value, compare_op op, std::size_t operand)
+    {
+        switch(op)
+        {
+        case compare_op::less: return value < operand;
+        case compare_op::less_equal: return value <= operand;
+        case compare_op::greater: return value > operand;
+        case compare_op::greater_equal: return value >= operand;
+        case compare_op::equal: return value == operand;
+        }
+
+        return false;
+    }
+
+    static std::uint8_t required_hit(text_kind kind)
+    {
+        switch(kind)
+        {
+        case text_kind::prefix: return hit_prefix;
+        case text_kind::suffix: return hit_suffix;
+        case text_kind::exact: return hit_exact;
+        default: return hit_anywhere;
+        }
+    }
+
+    // The runs of a glob between its wildcards.
+    static std::vector<std::string> literal_runs(std::string const& glob)
+    {
+        std::vector<std::string> runs;
+        std::string run;
+        for(char c : glob)
+        {
+            if(c == '*' || c == '?')
+            {
+                if(!run.empty())
+                    runs.push_back(std::move(run));
+                run.clear();
+            }
+            else
+            {
+                run.push_back(c);
+            }
+        }
+
+        if(!run.empty())
+            runs.push_back(std::move(run));
+
+        return runs;
+    }
+
+    // Backtracks only to the last star, so it's linear unless the glob has
+    // many stars.
+    static bool glob_match(std::string const& glob, std::string const& name)
+    {
+        std::size_t g = 0;
+        std::size_t n = 0;
+        std::size_t star = std::string::npos;
+        std::size_t star_n = 0;
+        while(n < name.size())
+        {
+            if(g < glob.size() && (glob[g] == '?' || glob[g] == name[n]))
+            {
+                ++g;
+                ++n;
+            }
+            else if(g < glob.size() && glob[g] == '*')
+            {
+                star = g++;
+                star_n = n;
+            }
+            else if(star != std::string::npos)
+            {
+                g = star + 1;
+                n = ++star_n;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        while(g < glob.size() && glob[g] == '*')
+            ++g;
+
+        return g == glob.size();
+    }
+
+    // Whether a name matching new_term always matches old_term.
+    static bool implies(text_term const& new_term, text_term const& old_term)
+    {
+        if(new_term.negated || old_term.negated
+        || new_term.kind == text_kind::glob || old_term.kind == text_kind::glob)
+        {
+            return new_term.negated == old_term.negated
+                && new_term.kind == old_term.kind
+                && new_term.text == old_term.text;
+        }
+
+        std::string const& n = new_term.text;
+        std::string const& o = old_term.text;
+        bool starts = n.size() >= o.size() && n.compare(0, o.size(), o) == 0;
+        bool ends = n.size() >= o.size() && n.compare(n.size() - o.size(), o.size(), o) == 0;
+        switch(old_term.kind)
+        {
+        case text_kind::contains:
+            return n.find(o) != std::string::npos;
+        case text_kind::prefix:
+            return starts && (new_term.kind == text_kind::prefix || new_term.kind == text_kind::exact);
+        case text_kind::suffix:
+            return ends && (new_term.kind == text_kind::suffix || new_term.kind == text_kind::exact);
+        case text_kind::exact:
+            return new_term.kind == text_kind::exact && n == o;
+        default:
+            return false;
+        }
+    }
+
+    pattern_automaton patterns_;
+    std::vector<text_term> text_terms_;
+    std::vector<numeric_term> numeric_terms_;
+    std::vector<std::string> required_substrings_;
+    mutable std::vector<std::uint8_t> hits_;
+};
+
+#endif // CPPSIZE_UTIL_FILTERQUERY_HPP_
@@ -0,0 +1,192 @@
+// *****************************************************************************
+//
+// util/incremental_tree_filter.hpp
+//
+// Filters a full include_tree down to the nodes that match a filter_query
+// plus every node on the way to them. The previous match set is cached so
+// that extending the query only re-tests vertices that matched last time
+// instead of re-walking the whole graph, and a fresh query only tests the
+// vertices the trigram index hands back for the text it requires.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_UTIL_INCREMENTALTREEFILTER_HPP_
+#define CPPSIZE_UTIL_INCREMENTALTREEFILTER_HPP_
+
+#include "ui/include_tree.hpp"
+#include "ui/tree_view_builder.hpp"
+#include "util/filter_query.hpp"
+#include "util/substring_index.hpp"
+#include "util/task_monitor.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+class incremental_tree_filter
+{
+public:
+
+    explicit incremental_tree_filter(std::shared_ptr<include_tree const> full_tree)
+        : full_tree_(std::move(full_tree))
+        , name_index_(full_tree_->graph())
+    {
+        // Index every node by its vertex so matches can be
+        // walked up the tree without a full traversal.
+        std::size_t num_vertices = boost::num_vertices(full_tree_->graph());
+        vertex_node_offsets_.assign(num_vertices + 1, 0);
+        for(include_tree::node_index_t i = 0; i < full_tree_->size(); ++i)
+        {
+            ++vertex_node_offsets_[(*full_tree_)[i].vertex + 1];
+        }
+
+        std::partial_sum(
+            vertex_node_offsets_.begin(),
+            vertex_node_offsets_.end(),
+            vertex_node_offsets_.begin());
+
+        vertex_nodes_.resize(full_tree_->size());
+        std::vector<std::uint32_t> fill(
+            vertex_node_offsets_.begin(),
+            vertex_node_offsets_.end() - 1);
+
+        for(include_tree::node_index_t i = 0; i < full_tree_->size(); ++i)
+        {
+            vertex_nodes_[fill[(*full_tree_)[i].vertex]++] = i;
+        }
+    }
+
+    // Returns the filtered tree, or the full tree if query is empty.
+    // Throws task_cancelled if monitor asks to stop, leaving the cache as it
+    // was so the next query can still refine the last one that finished.
+    std::shared_ptr<include_tree const> operator()(
+        filter_query query,
+        task_monitor const* monitor = nullptr)
+    {
+        if(query.empty())
+        {
+            previous_query_ = filter_query();
+            previous_matches_.clear();
+            previous_tree_.reset();
+            return full_tree_;
+        }
+
+        // A refined query that drops no matches gives the same tree.
+        cancellation_poll poll(monitor);
+        std::vector<cpp_dep::include_vertex_descriptor_t> matches;
+        bool refined = update_matches(query, matches, poll);
+        std::shared_ptr<include_tree const> tree = previous_tree_;
+        if(!refined || matches.size() != previous_matches_.size() || !tree)
+            tree = build_tree(matches, poll);
+
+        previous_query_ = std::move(query);
+        previous_matches_ = std::move(matches);
+        previous_tree_ = tree;
+        return tree;
+    }
+
+private:
+
+    // Fills result with the vertices matching query. Returns true if only
+    // the previous matches were re-tested.
+    bool update_matches(
+        filter_query const& query,
+        std::vector<cpp_dep::include_vertex_descriptor_t>& result,
+        cancellation_poll& poll) const
+    {
+        cpp_dep::include_graph_t const& g = full_tree_->graph();
+        include_tree const& full = *full_tree_;
+        auto matches = [&g, &full, &query, &poll](cpp_dep::include_vertex_descriptor_t v)
+        {
+            poll();
+            return query.matches(g[v].name, g[v].size, std::size_t(full.vertex_occurence(v)));
+        };
+
+        bool refined = query.refines(previous_query_);
+        if(refined)
+            result = previous_matches_;
+        else
+            result = name_index_.candidates(query.required_substrings());
+
+        result.erase(
+            std::remove_if(
+                result.begin(),
+                result.end(),
+                [&matches](cpp_dep::include_vertex_descriptor_t v)
+                {
+                    return !matches(v);
+                }
+            ),
+            result.end()
+        );
+
+        return refined;
+    }
+
+    // Replays the full tree keeping every vertex that lies on a path to a
+    // match, exactly as filtered_tree_view_builder would.
+    std::shared_ptr<include_tree const> build_tree(
+        std::vector<cpp_dep::include_vertex_descriptor_t> const& matches,
+        cancellation_poll& poll) const
+    {
+        include_tree const& full = *full_tree_;
+        std::size_t num_nodes = full.size();
+
+        std::vector<bool> keepers(boost::num_vertices(full.graph()), false);
+        std::vector<bool> marked(num_nodes, false);
+        for(auto v : matches)
+        {
+            poll();
+            for(std::uint32_t n = vertex_node_offsets_[v]; n < vertex_node_offsets_[v + 1]; ++n)
+            {
+                // Stop as soon as we hit a chain that's already marked.
+                for(include_tree::node_index_t i = vertex_nodes_[n];
+                    i != include_tree::npos && !marked[i];
+                    i = full[i].parent)
+                {
+                    marked[i] = true;
+                    keepers[full[i].vertex] = true;
+                }
+            }
+        }
+
+        auto tree = std::make_shared<include_tree>(
+            full.graph_ptr(), tree_view_builder::option::none);
+
+        // Nodes are stored in visit order so parents always come first.
+        // Filtered out nodes forward to their nearest kept ancestor.
+        std::vector<include_tree::node_index_t> remap(num_nodes, include_tree::npos);
+        int order = 0;
+        for(include_tree::node_index_t i = 0; i < num_nodes; ++i)
+        {
+            poll();
+            include_tree::node const& n = full[i];
+            include_tree::node_index_t parent =
+                n.parent == include_tree::npos ? include_tree::npos : remap[n.parent];
+
+            if(n.parent == include_tree::npos || keepers[n.vertex])
+                remap[i] = tree->add_node(parent, n.vertex, order++, full.occurence(i));
+            else
+                remap[i] = parent;
+        }
+
+        tree->finalise();
+        return tree;
+    }
+
+    std::shared_ptr<include_tree const> full_tree_;
+    substring_index name_index_;
+    std::vector<std::uint32_t> vertex_node_offsets_;
+    std::vector<include_tree::node_index_t> vertex_nodes_;
+    filter_query previous_query_;
+    std::vector<cpp_dep::include_vertex_descriptor_t> previous_matches_;
+    std::shared_ptr<include_tree const> previous_tree_;
+};
+
+#endif // CPPSIZE_UTIL_INCREMENTALTREEFILTER_HPP_
@@ -0,0 +1,88 @@
+// *****************************************************************************
+//
+// util/parallel_for.hpp
+//
+// Minimal work sharing loop over an index range using std::thread. Work
+// items are handed out one at a time from an atomic counter so uneven
+// items balance across the threads.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_UTIL_PARALLELFOR_HPP_
+#define CPPSIZE_UTIL_PARALLELFOR_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+// Number of threads to use for count items when num_threads were asked for,
+// 0 meaning the hardware concurrency.
+inline unsigned resolve_thread_count(unsigned num_threads, std::size_t count)
+{
+    if(num_threads == 0)
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    return static_cast<unsigned>(
+        std::max<std::size_t>(1, std::min<std::size_t>(num_threads, count)));
+}
+
+// -----------------------------------------------------------------------------
+//
+// Calls f(thread_index, item_index) for every item in [0, count). The
+// calling thread takes part as thread 0. The first exception thrown by f
+// is rethrown once all threads have finished.
+template<typename Function>
+void parallel_for(std::size_t count, unsigned num_threads, Function f)
+{
+    num_threads = resolve_thread_count(num_threads, count);
+
+    std::atomic<std::size_t> next_item(0);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto worker = [&](unsigned thread_index)
+    {
+        try
+        {
+            for(std::size_t i = next_item++; i < count; i = next_item++)
+            {
+                f(thread_index, i);
+            }
+        }
+        catch(...)
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if(!error)
+                error = std::current_exception();
+
+            next_item = count;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(unsigned t = 1; t < num_threads; ++t)
+    {
+        threads.emplace_back(worker, t);
+    }
+
+    worker(0);
+    for(auto&& t : threads)
+    {
+        t.join();
+    }
+
+    if(error)
+        std::rethrow_exception(error);
+}
+
+#endif // CPPSIZE_UTIL_PARALLELFOR_HPP_
@@ -0,0 +1,90 @@
+// *****************************************************************************
+//
+// util/parallel_top_n.hpp
+//
+// The best n items of an index range in one parallel pass. Each thread
+// keeps a bounded heap of the best items it has seen, so only the
+// survivors of every thread are ever sorted, not the whole range.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_UTIL_PARALLELTOPN_HPP_
+#define CPPSIZE_UTIL_PARALLELTOPN_HPP_
+
+#include "util/parallel_for.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+// make(i, item) fills in item for index i and returns false to leave i out.
+// before(a, b) is true if a ranks ahead of b, and should break ties so the
+// result doesn't depend on how the range was split. Returns at most n
+// items, best first. num_threads of 0 uses the hardware concurrency.
+template<typename T, typename Make, typename Before>
+std::vector<T> parallel_top_n(
+    std::size_t count,
+    std::size_t n,
+    unsigned num_threads,
+    Make make,
+    Before before)
+{
+    // Small enough that threads balance, big enough that handing out a
+    // block costs nothing next to scoring it.
+    std::size_t const block_size = 4096;
+
+    std::vector<T> top;
+    if(n == 0 || count == 0)
+        return top;
+
+    std::size_t num_blocks = (count + block_size - 1) / block_size;
+    num_threads = resolve_thread_count(num_threads, num_blocks);
+
+    // The front of each heap is the worst item it's keeping, which is
+    // the one a better item replaces.
+    std::vector<std::vector<T>> heaps(num_threads);
+    parallel_for(
+        num_blocks,
+        num_threads,
+        [&](unsigned thread, std::size_t block)
+        {
+            std::vector<T>& heap = heaps[thread];
+            std::size_t last = std::min(count, (block + 1) * block_size);
+            T item;
+            for(std::size_t i = block * block_size; i < last; ++i)
+            {
+                if(!make(i, item))
+                    continue;
+
+                if(heap.size() < n)
+                {
+                    heap.push_back(item);
+                    std::push_heap(heap.begin(), heap.end(), before);
+                }
+                else if(before(item, heap.front()))
+                {
+                    std::pop_heap(heap.begin(), heap.end(), before);
+                    heap.back() = item;
+                    std::push_heap(heap.begin(), heap.end(), before);
+                }
+            }
+        }
+    );
+
+    for(auto&& heap : heaps)
+        top.insert(top.end(), heap.begin(), heap.end());
+
+    std::sort(top.begin(), top.end(), before);
+    if(top.size() > n)
+        top.resize(n);
+
+    return top;
+}
+
+#endif // CPPSIZE_UTIL_PARALLELTOPN_HPP_
@@ -0,0 +1,352 @@
+// *****************************************************************************
+//
+// util/path_table.hpp
+//
+// Interned file paths. Every path is a node in a trie of path components,
+// so a directory prefix shared by thousands of headers is stored once and
+// each distinct component's text lives once in an arena. Paths are then
+// handled as 32 bit ids, and once the table is finalised each id has a
+// rank giving its position in sorted order, so ordering two paths is an
+// integer compare.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_UTIL_PATHTABLE_HPP_
+#define CPPSIZE_UTIL_PATHTABLE_HPP_
+
+#include "cpp_dep/cpp_dep.hpp"
+#include <boost/functional/hash.hpp>
+#include <boost/utility/string_ref.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+// Append only storage for strings that never move once added.
+class string_arena
+{
+public:
+
+    boost::string_ref add(boost::string_ref s)
+    {
+        if(blocks_.empty() || block_used_ + s.size() > block_size_)
+        {
+            std::size_t size = s.size() > kBlockSize ? s.size() : kBlockSize;
+            blocks_.emplace_back(new char[size]);
+            block_size_ = size;
+            block_used_ = 0;
+            bytes_reserved_ += size;
+        }
+
+        char* data = blocks_.back().get() + block_used_;
+        std::memcpy(data, s.data(), s.size());
+        block_used_ += s.size();
+        return boost::string_ref(data, s.size());
+    }
+
+    std::size_t bytes_reserved() const
+    {
+        return bytes_reserved_;
+    }
+
+private:
+
+    static std::size_t const kBlockSize = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    std::size_t block_size_ = 0;
+    std::size_t block_used_ = 0;
+    std::size_t bytes_reserved_ = 0;
+};
+
+// -----------------------------------------------------------------------------
+//
+class path_table
+{
+public:
+
+    typedef std::uint32_t path_id;
+
+    enum : path_id
+    {
+        // The empty path, parent of every top level component.
+        empty = 0
+    };
+
+    path_table()
+        : nodes_(1)
+    {}
+
+    path_id intern(boost::string_ref path)
+    {
+        if(!indexed_)
+            rebuild_index();
+
+        // Components keep the separator before them so the exact
+        // path, slashes and all, comes back out of str().
+        path_id node = empty;
+        while(!path.empty())
+        {
+            std::size_t end = path.substr(1).find_first_of("/\\");
+            end = end == boost::string_ref::npos ? path.size() : end + 1;
+
+            node = child(node, intern_component(path.substr(0, end)));
+            path.remove_prefix(end);
+        }
+
+        return node;
+    }
+
+    std::string str(path_id id) const
+    {
+        std::vector<path_id> chain;
+        for(path_id n = id; n != empty; n = nodes_[n].parent)
+        {
+            chain.push_back(n);
+        }
+
+        std::string result;
+        for(auto i = chain.rbegin(); i != chain.rend(); ++i)
+        {
+            boost::string_ref component = components_[nodes_[*i].component];
+            result.append(component.data(), component.size());
+        }
+
+        return result;
+    }
+
+    path_id parent(path_id id) const
+    {
+        return nodes_[id].parent;
+    }
+
+    // Last component of the path, including its leading separator.
+    boost::string_ref leaf(path_id id) const
+    {
+        return components_[nodes_[id].component];
+    }
+
+    std::size_t size() const
+    {
+        return nodes_.size();
+    }
+
+    // Computes ranks by walking the trie depth first with each node's
+    // children in order, so no path is ever built as a string. Paths are
+    // ordered component by component, as filesystem paths are, which keeps
+    // everything under a directory together. Paths interned after this
+    // have no rank until it's called again.
+    //
+    // The lookups intern() uses are released here and rebuilt if it's
+    // called again, so a finished table holds little more than its text.
+    void finalise()
+    {
+        release_index();
+
+        std::vector<path_id> child_offsets(nodes_.size() + 1, 0);
+        for(path_id i = 1; i < nodes_.size(); ++i)
+        {
+            ++child_offsets[nodes_[i].parent + 1];
+        }
+
+        for(std::size_t i = 1; i < child_offsets.size(); ++i)
+        {
+            child_offsets[i] += child_offsets[i - 1];
+        }
+
+        std::vector<path_id> children(nodes_.size() - 1);
+        {
+            std::vector<path_id> next(child_offsets.begin(), child_offsets.end() - 1);
+            for(path_id i = 1; i < nodes_.size(); ++i)
+            {
+                children[next[nodes_[i].parent]++] = i;
+            }
+        }
+
+        for(path_id i = 0; i < nodes_.size(); ++i)
+        {
+            std::sort(
+                children.begin() + child_offsets[i],
+                children.begin() + child_offsets[i + 1],
+                [this](path_id a, path_id b)
+                {
+                    int order = component_text(a).compare(component_text(b));
+                    if(order != 0)
+                        return order < 0;
+
+                    return components_[nodes_[a].component] < components_[nodes_[b].component];
+                }
+            );
+        }
+
+        // Children are pushed in reverse so the smallest is ranked first.
+        ranks_.resize(nodes_.size());
+        std::uint32_t rank = 0;
+        std::vector<path_id> stack(1, empty);
+        while(!stack.empty())
+        {
+            path_id n = stack.back();
+            stack.pop_back();
+            ranks_[n] = rank++;
+            for(path_id c = child_offsets[n + 1]; c != child_offsets[n]; --c)
+            {
+                stack.push_back(children[c - 1]);
+            }
+        }
+    }
+
+    // Position of id among every interned path in sorted order.
+    std::uint32_t rank(path_id id) const
+    {
+        return ranks_[id];
+    }
+
+    // Approximate memory held by the table, counting each hash map entry
+    // as its value and a next pointer plus a pointer per bucket.
+    std::size_t bytes_used() const
+    {
+        return arena_.bytes_reserved()
+            + nodes_.capacity() * sizeof(node)
+            + components_.capacity() * sizeof(boost::string_ref)
+            + ranks_.capacity() * sizeof(std::uint32_t)
+            + hash_bytes(component_ids_)
+            + hash_bytes(children_);
+    }
+
+private:
+
+    struct node
+    {
+        node()
+            : parent(empty)
+            , component(0)
+        {}
+
+        path_id parent;
+        std::uint32_t component;
+    };
+
+    void release_index()
+    {
+        decltype(component_ids_)().swap(component_ids_);
+        decltype(children_)().swap(children_);
+        nodes_.shrink_to_fit();
+        components_.shrink_to_fit();
+        indexed_ = false;
+    }
+
+    void rebuild_index()
+    {
+        for(std::uint32_t i = 0; i < components_.size(); ++i)
+        {
+            component_ids_.emplace(components_[i], i);
+        }
+
+        for(path_id i = 1; i < nodes_.size(); ++i)
+        {
+            children_.emplace((std::uint64_t(nodes_[i].parent) << 32) | nodes_[i].component, i);
+        }
+
+        indexed_ = true;
+    }
+
+    template<typename Map>
+    static std::size_t hash_bytes(Map const& map)
+    {
+        return map.size() * (sizeof(typename Map::value_type) + sizeof(void*))
+            + map.bucket_count() * sizeof(void*);
+    }
+
+    // A node's component without its leading separator, so siblings
+    // compare by name whichever separator the log used.
+    boost::string_ref component_text(path_id id) const
+    {
+        boost::string_ref component = components_[nodes_[id].component];
+        if(!component.empty() && (component.front() == '/' || component.front() == '\\'))
+            component.remove_prefix(1);
+
+        return component;
+    }
+
+    std::uint32_t intern_component(boost::string_ref component)
+    {
+        auto i = component_ids_.find(component);
+        if(i != component_ids_.end())
+            return i->second;
+
+        std::uint32_t id = static_cast<std::uint32_t>(components_.size());
+        boost::string_ref stored = arena_.add(component);
+        components_.push_back(stored);
+        component_ids_.emplace(stored, id);
+        return id;
+    }
+
+    path_id child(path_id parent, std::uint32_t component)
+    {
+        std::uint64_t key = (std::uint64_t(parent) << 32) | component;
+
+        auto i = children_.find(key);
+        if(i != children_.end())
+            return i->second;
+
+        path_id id = static_cast<path_id>(nodes_.size());
+        node n;
+        n.parent = parent;
+        n.component = component;
+        nodes_.push_back(n);
+        children_.emplace(key, id);
+        return id;
+    }
+
+    struct string_ref_hash
+    {
+        std::size_t operator()(boost::string_ref s) const
+        {
+            return boost::hash_range(s.begin(), s.end());
+        }
+    };
+
+    string_arena arena_;
+    std::vector<boost::string_ref> components_;
+    std::unordered_map<boost::string_ref, std::uint32_t, string_ref_hash> component_ids_;
+    std::vector<node> nodes_;
+    std::unordered_map<std::uint64_t, path_id> children_;
+    std::vector<std::uint32_t> ranks_;
+    bool indexed_ = true;
+};
+
+// -----------------------------------------------------------------------------
+//
+// The interned path of every vertex of one graph.
+struct vertex_paths
+{
+    std::shared_ptr<path_table const> table;
+    std::vector<path_table::path_id> ids;
+};
+
+// Interns the name of every vertex of g into table.
+inline std::vector<path_table::path_id> intern_vertex_names(
+    path_table& table,
+    cpp_dep::include_graph_t const& g)
+{
+    std::vector<path_table::path_id> ids;
+    ids.reserve(boost::num_vertices(g));
+    for(auto v : boost::make_iterator_range(boost::vertices(g)))
+    {
+        ids.push_back(table.intern(g[v].name));
+    }
+
+    return ids;
+}
+
+#endif // CPPSIZE_UTIL_PATHTABLE_HPP_
@@ -0,0 +1,173 @@
+// *****************************************************************************
+//
+// util/substring_index.hpp
+//
+// Trigram index over the vertex names of an include graph. A token resolves
+// to the small set of vertices whose names contain all of its trigrams, so
+// only those need an actual substring test.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_UTIL_SUBSTRINGINDEX_HPP_
+#define CPPSIZE_UTIL_SUBSTRINGINDEX_HPP_
+
+#include "cpp_dep/cpp_dep.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+class substring_index
+{
+public:
+
+    typedef cpp_dep::include_vertex_descriptor_t vertex_t;
+
+    explicit substring_index(cpp_dep::include_graph_t const& g)
+        : num_vertices_(boost::num_vertices(g))
+    {
+        std::vector<std::pair<std::uint32_t, vertex_t>> postings;
+        for(auto v : boost::make_iterator_range(boost::vertices(g)))
+        {
+            std::string const& name = g[v].name;
+            for(std::size_t i = 0; i + 3 <= name.size(); ++i)
+            {
+                postings.emplace_back(trigram(name.data() + i), v);
+            }
+        }
+
+        std::sort(postings.begin(), postings.end());
+        postings.erase(
+            std::unique(postings.begin(), postings.end()),
+            postings.end());
+
+        vertices_.reserve(postings.size());
+        for(auto&& p : postings)
+        {
+            if(keys_.empty() || keys_.back() != p.first)
+            {
+                keys_.push_back(p.first);
+                offsets_.push_back(static_cast<std::uint32_t>(vertices_.size()));
+            }
+
+            vertices_.push_back(p.second);
+        }
+
+        offsets_.push_back(static_cast<std::uint32_t>(vertices_.size()));
+    }
+
+    // Sorted list of vertices that may contain every token in match_list.
+    // Tokens shorter than a trigram can't narrow the search, so if every
+    // token is short all vertices are returned.
+    std::vector<vertex_t> candidates(std::vector<std::string> const& match_list) const
+    {
+        std::vector<vertex_t> result;
+        bool narrowed = false;
+        for(auto&& token : match_list)
+        {
+            if(token.size() < 3)
+                continue;
+
+            if(!narrowed)
+            {
+                result = token_candidates(token);
+                narrowed = true;
+            }
+            else
+            {
+                std::vector<vertex_t> other = token_candidates(token);
+                intersect(result, other.data(), other.data() + other.size());
+            }
+
+            if(result.empty())
+                return result;
+        }
+
+        if(!narrowed)
+        {
+            result.resize(num_vertices_);
+            for(std::size_t v = 0; v < num_vertices_; ++v)
+            {
+                result[v] = v;
+            }
+        }
+
+        return result;
+    }
+
+private:
+
+    static std::uint32_t trigram(char const* s)
+    {
+        return (std::uint32_t(static_cast<unsigned char>(s[0])) << 16) |
+               (std::uint32_t(static_cast<unsigned char>(s[1])) << 8) |
+               (std::uint32_t(static_cast<unsigned char>(s[2])));
+    }
+
+    std::vector<vertex_t> token_candidates(std::string const& token) const
+    {
+        // Gather the posting lists, smallest first so the
+        // intersections shrink as quickly as possible.
+        std::vector<std::pair<vertex_t const*, vertex_t const*>> lists;
+        for(std::size_t i = 0; i + 3 <= token.size(); ++i)
+        {
+            std::uint32_t key = trigram(token.data() + i);
+            auto k = std::lower_bound(keys_.begin(), keys_.end(), key);
+            if(k == keys_.end() || *k != key)
+                return std::vector<vertex_t>();
+
+            std::size_t idx = k - keys_.begin();
+            lists.emplace_back(
+                vertices_.data() + offsets_[idx],
+                vertices_.data() + offsets_[idx + 1]);
+        }
+
+        std::sort(
+            lists.begin(),
+            lists.end(),
+            [](auto const& a, auto const& b)
+            {
+                return (a.second - a.first) < (b.second - b.first);
+            }
+        );
+
+        std::vector<vertex_t> result(lists.front().first, lists.front().second);
+        for(std::size_t i = 1; i < lists.size() && !result.empty(); ++i)
+        {
+            intersect(result, lists[i].first, lists[i].second);
+        }
+
+        return result;
+    }
+
+    static void intersect(
+        std::vector<vertex_t>& result,
+        vertex_t const* first,
+        vertex_t const* last)
+    {
+        std::vector<vertex_t> out;
+        out.reserve(std::min<std::size_t>(result.size(), last - first));
+        std::set_intersection(
+            result.begin(), result.end(),
+            first, last,
+            std::back_inserter(out));
+
+        result.swap(out);
+    }
+
+    std::size_t num_vertices_;
+    std::vector<std::uint32_t> keys_;
+    std::vector<std::uint32_t> offsets_;
+    std::vector<vertex_t> vertices_;
+};
+
+#endif // CPPSIZE_UTIL_SUBSTRINGINDEX_HPP_
@@ -0,0 +1,101 @@
+// *****************************************************************************
+//
+// util/task_monitor.hpp
+//
+// Qt free interface that long running work uses to report progress and to
+// find out that it should stop. Work that is cancelled throws
+// task_cancelled out to whoever started it.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_UTIL_TASKMONITOR_HPP_
+#define CPPSIZE_UTIL_TASKMONITOR_HPP_
+
+#include <stdexcept>
+
+// -----------------------------------------------------------------------------
+//
+class task_cancelled : public std::runtime_error
+{
+public:
+
+    task_cancelled()
+        : std::runtime_error("Cancelled")
+    {}
+};
+
+// -----------------------------------------------------------------------------
+//
+class task_monitor
+{
+public:
+
+    virtual ~task_monitor()
+    {}
+
+    // May be called from any thread.
+    virtual void progress(char const* stage, int percent) = 0;
+    virtual bool cancelled() const = 0;
+
+    void check_cancelled() const
+    {
+        if(cancelled())
+            throw task_cancelled();
+    }
+};
+
+// -----------------------------------------------------------------------------
+//
+// Null safe helpers so callers can take an optional monitor.
+inline void report_progress(task_monitor* monitor, char const* stage, int percent)
+{
+    if(monitor)
+    {
+        monitor->check_cancelled();
+        monitor->progress(stage, percent);
+    }
+}
+
+inline void check_cancelled(task_monitor const* monitor)
+{
+    if(monitor)
+        monitor->check_cancelled();
+}
+
+// -----------------------------------------------------------------------------
+//
+// Checks an optional monitor every interval calls, for loops too tight to
+// take the atomic load on every pass. Throws task_cancelled once the
+// monitor asks to stop.
+class cancellation_poll
+{
+public:
+
+    explicit cancellation_poll(task_monitor const* monitor, unsigned interval = 1024)
+        : monitor_(monitor)
+        , interval_(interval)
+        , countdown_(interval)
+    {}
+
+    void operator()()
+    {
+        if(monitor_ && --countdown_ == 0)
+        {
+            countdown_ = interval_;
+            monitor_->check_cancelled();
+        }
+    }
+
+private:
+
+    task_monitor const* monitor_;
+    unsigned interval_;
+    unsigned countdown_;
+};
+
+#endif // CPPSIZE_UTIL_TASKMONITOR_HPP_
@@ -0,0 +1,89 @@
+// *****************************************************************************
+//
+// test/dominator_tree_test.cpp
+//
+// Immediate dominators and exclusive sizes of small hand built graphs,
+// worked out on paper.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+
+#include "test_graphs.hpp"
+#include "analysis/dominator_tree.hpp"
+#include <boost/test/unit_test.hpp>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+cpp_dep::include_vertex_descriptor_t const kNone =
+    boost::graph_traits<cpp_dep::include_graph_t>::null_vertex();
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(dominator_tree_test)
+
+// -----------------------------------------------------------------------------
+//
+// 0 includes 1 and 2, which both include 3, which includes 4. 1 also
+// includes 5.
+BOOST_AUTO_TEST_CASE(single_root)
+{
+    cpp_dep::include_graph_t g = make_graph(
+        { 1, 10, 100, 1000, 10000, 100000 },
+        { { 0, 1 }, { 0, 2 }, { 1, 3 }, { 2, 3 }, { 3, 4 }, { 1, 5 } });
+
+    std::vector<cpp_dep::include_vertex_descriptor_t> idom = immediate_dominators(g);
+    std::vector<cpp_dep::include_vertex_descriptor_t> expected = { kNone, 0, 0, 0, 3, 1 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(idom.begin(), idom.end(), expected.begin(), expected.end());
+
+    // 3 is reached through both 1 and 2, so removing either leaves it.
+    std::vector<std::size_t> exclusive = exclusive_sizes(g);
+    std::vector<std::size_t> expected_sizes = { 111111, 100010, 100, 11000, 10000, 100000 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(exclusive.begin(), exclusive.end(), expected_sizes.begin(), expected_sizes.end());
+}
+
+// -----------------------------------------------------------------------------
+//
+// Two translation units sharing a header, which only the virtual root
+// above both dominates. Header 3 is only reached through 2.
+BOOST_AUTO_TEST_CASE(shared_between_roots)
+{
+    cpp_dep::include_graph_t g = make_graph(
+        { 1, 10, 100, 1000 },
+        { { 0, 2 }, { 1, 2 }, { 2, 3 } });
+
+    std::vector<cpp_dep::include_vertex_descriptor_t> idom = immediate_dominators(g);
+    std::vector<cpp_dep::include_vertex_descriptor_t> expected = { kNone, kNone, kNone, 2 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(idom.begin(), idom.end(), expected.begin(), expected.end());
+
+    std::vector<std::size_t> exclusive = exclusive_sizes(g);
+    std::vector<std::size_t> expected_sizes = { 1, 10, 1100, 1000 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(exclusive.begin(), exclusive.end(), expected_sizes.begin(), expected_sizes.end());
+}
+
+// -----------------------------------------------------------------------------
+//
+// A cycle below the root: 1 and 2 include each other and 2 includes 3.
+BOOST_AUTO_TEST_CASE(cycle)
+{
+    cpp_dep::include_graph_t g = make_graph(
+        { 1, 10, 100, 1000 },
+        { { 0, 1 }, { 1, 2 }, { 2, 1 }, { 2, 3 } });
+
+    std::vector<cpp_dep::include_vertex_descriptor_t> idom = immediate_dominators(g);
+    std::vector<cpp_dep::include_vertex_descriptor_t> expected = { kNone, 0, 1, 2 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(idom.begin(), idom.end(), expected.begin(), expected.end());
+
+    std::vector<std::size_t> exclusive = exclusive_sizes(g);
+    std::vector<std::size_t> expected_sizes = { 1111, 1110, 1100, 1000 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(exclusive.begin(), exclusive.end(), expected_sizes.begin(), expected_sizes.end());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,173 @@
+// *****************************************************************************
+//
+// test/filter_query_test.cpp
+//
+// Each form of term in the filter query language, how terms combine, and
+// which queries refine which.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+
+#include "util/filter_query.hpp"
+#include <boost/test/unit_test.hpp>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+struct match_case
+{
+    char const* query;
+    char const* name;
+    std::size_t size;
+    std::size_t count;
+    bool matches;
+};
+
+match_case const kMatchCases[] =
+{
+    // Text.
+    { "vector",                       "/usr/include/c++/vector",        0, 0, true },
+    { "vector",                       "/usr/include/c++/list",          0, 0, false },
+    { "Vector",                       "/usr/include/c++/vector",        0, 0, false },
+    { "^/usr",                        "/usr/include/c++/vector",        0, 0, true },
+    { "^include",                     "/usr/include/c++/vector",        0, 0, false },
+    { "vector$",                      "/usr/include/c++/vector",        0, 0, true },
+    { "c++$",                         "/usr/include/c++/vector",        0, 0, false },
+    { "^a.h$",                        "a.h",                            0, 0, true },
+    { "^a.h$",                        "ba.h",                           0, 0, false },
+    { "^a.h$",                        "a.hpp",                          0, 0, false },
+    { "^",                            "a^b",                            0, 0, true },
+    { "$",                            "a.h",                            0, 0, false },
+
+    // Globs.
+    { "*/detail/*",                   "boost/detail/foo.hpp",           0, 0, true },
+    { "*/detail/*",                   "detail/foo.hpp",                 0, 0, false },
+    { "*.h",                          "a.h",                            0, 0, true },
+    { "*.h",                          "a.hpp",                          0, 0, false },
+    { "a?c",                          "abc",                            0, 0, true },
+    { "a?c",                          "ac",                             0, 0, false },
+    { "*",                            "anything",                       0, 0, true },
+    { "*a*a*a*",                      "banana",                         0, 0, true },
+    { "*a*a*a*a*",                    "banana",                         0, 0, false },
+
+    // Predicates.
+    { "size>100",                     "a.h",                          101, 0, true },
+    { "size>100",                     "a.h",                          100, 0, false },
+    { "size>=100",                    "a.h",                          100, 0, true },
+    { "size<1k",                      "a.h",                         1023, 0, true },
+    { "size<1k",                      "a.h",                         1024, 0, false },
+    { "size<=1K",                     "a.h",                         1024, 0, true },
+    { "size=2m",                      "a.h",                      2097152, 0, true },
+    { "size>1M",                      "a.h",                      1048576, 0, false },
+    { "count>=5",                     "a.h",                            0, 5, true },
+    { "count>=5",                     "a.h",                            0, 4, false },
+    { "count=3",                      "a.h",                            0, 3, true },
+    { "count<3",                      "a.h",                            0, 3, false },
+
+    // A predicate that doesn't parse is text.
+    { "size>",                        "size>",                          0, 0, true },
+    { "size>",                        "a.h",                          100, 0, false },
+    { "size>1x",                      "size>1x.h",                      0, 0, true },
+    { "sizes>1",                      "a.h",                            5, 0, false },
+    { "count",                        "account.h",                      0, 0, true },
+
+    // Negation.
+    { "-detail",                      "boost/detail/foo.hpp",           0, 0, false },
+    { "-detail",                      "boost/foo.hpp",                  0, 0, true },
+    { "-^boost",                      "boost/foo.hpp",                  0, 0, false },
+    { "-*.hpp",                       "boost/foo.hpp",                  0, 0, false },
+    { "-*.hpp",                       "boost/foo.h",                    0, 0, true },
+    { "-size>100",                    "a.h",                          200, 0, false },
+    { "-size>100",                    "a.h",                           50, 0, true },
+    { "-",                            "a-b.h",                          0, 0, true },
+
+    // Every term has to match.
+    { "boost detail",                 "boost/detail/foo.hpp",           0, 0, true },
+    { "boost detail",                 "boost/foo.hpp",                  0, 0, false },
+    { "  boost   foo  ",              "boost/foo.hpp",                  0, 0, true },
+    { "boost -detail *.hpp size>1k",  "boost/foo.hpp",               2048, 0, true },
+    { "boost -detail *.hpp size>1k",  "boost/foo.hpp",                512, 0, false },
+    { "boost -detail *.hpp size>1k",  "boost/detail/foo.hpp",        2048, 0, false },
+    { "o o o",                        "o",                              0, 0, true },
+    { "^ab b$",                       "ab",                             0, 0, true },
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(filter_query_test)
+
+// -----------------------------------------------------------------------------
+//
+BOOST_AUTO_TEST_CASE(terms)
+{
+    for(auto&& c : kMatchCases)
+    {
+        filter_query query(c.query);
+        BOOST_CHECK_MESSAGE(
+            query.matches(c.name, c.size, c.count) == c.matches,
+            "\"" << c.query << "\" against " << c.name
+                << " size " << c.size << " count " << c.count
+                << " should " << (c.matches ? "" : "not ") << "match");
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+BOOST_AUTO_TEST_CASE(empty_query_matches_everything)
+{
+    BOOST_CHECK(filter_query().empty());
+    BOOST_CHECK(filter_query("   ").empty());
+    BOOST_CHECK(filter_query().matches("a.h", 0, 0));
+    BOOST_CHECK(filter_query("").matches("", 0, 0));
+    BOOST_CHECK(!filter_query("a").empty());
+}
+
+// -----------------------------------------------------------------------------
+//
+BOOST_AUTO_TEST_CASE(required_substrings)
+{
+    // Negated terms and short glob runs don't narrow anything down.
+    std::vector<std::string> required = filter_query("^boost -detail *.hpp */mpl/* *x* size>1k").required_substrings();
+    std::vector<std::string> expected = { "boost", ".hpp", "/mpl/" };
+    BOOST_CHECK_EQUAL_COLLECTIONS(required.begin(), required.end(), expected.begin(), expected.end());
+}
+
+// -----------------------------------------------------------------------------
+//
+BOOST_AUTO_TEST_CASE(refines)
+{
+    auto refines = [](char const* next, char const* previous)
+    {
+        return filter_query(next).refines(filter_query(previous));
+    };
+
+    // Typing more of a term only narrows the matches.
+    BOOST_CHECK(refines("vecto", "vect"));
+    BOOST_CHECK(refines("^vect", "vect"));
+    BOOST_CHECK(refines("^vector", "^vect"));
+    BOOST_CHECK(refines("^vect$", "vect$"));
+    BOOST_CHECK(refines("boost detail", "boost"));
+    BOOST_CHECK(refines("boost size>1k", "size>1k"));
+    BOOST_CHECK(refines("-detail boost", "-detail"));
+
+    BOOST_CHECK(!refines("vect", "vecto"));
+    BOOST_CHECK(!refines("vect", "^vect"));
+    BOOST_CHECK(!refines("^vect", "vect$"));
+    BOOST_CHECK(!refines("boost", "boost detail"));
+    BOOST_CHECK(!refines("size>2k", "size>1k"));
+    BOOST_CHECK(!refines("-details", "-detail"));
+    BOOST_CHECK(!refines("*.h", "*.hpp"));
+
+    // There's nothing to narrow down from the empty query.
+    BOOST_CHECK(!refines("vector", ""));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,215 @@
+// *****************************************************************************
+//
+// test/graph_diff_test.cpp
+//
+// Headers and includes matched by name across two graphs, the log roots
+// matched to each other, and the order changes are ranked in.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+
+#include "test_graphs.hpp"
+#include "analysis/graph_diff.hpp"
+#include <boost/test/unit_test.hpp>
+#include <numeric>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+cpp_dep::include_graph_t make_named_graph(
+    std::vector<std::string> const& names,
+    std::vector<std::pair<int, int>> const& edges)
+{
+    cpp_dep::include_graph_t g = make_graph(std::vector<std::size_t>(names.size(), 0), edges);
+    for(std::size_t i = 0; i < names.size(); ++i)
+        g[i].name = names[i];
+
+    return g;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(graph_diff_test)
+
+// -----------------------------------------------------------------------------
+//
+// x.h grows and swaps y.h for z.h, w.h stays the same, and the logs were
+// loaded from different directories.
+BOOST_AUTO_TEST_CASE(hand_built_graphs)
+{
+    cpp_dep::include_graph_t before_graph = make_named_graph(
+        { "/old/includes.txt", "x.h", "y.h", "w.h" },
+        { { 0, 1 }, { 1, 2 }, { 0, 3 } });
+
+    cpp_dep::include_graph_t after_graph = make_named_graph(
+        { "/new/Includes.txt", "z.h", "x.h", "w.h" },
+        { { 0, 2 }, { 2, 1 }, { 0, 3 } });
+
+    diff_input before;
+    before.graph = &before_graph;
+    before.costs = { 115, 110, 10, 5 };
+    before.logs = { "/old/includes.txt" };
+
+    diff_input after;
+    after.graph = &after_graph;
+    after.costs = { 175, 20, 170, 5 };
+    after.logs = { "/new/Includes.txt" };
+
+    graph_diff diff = diff_graphs(before, after);
+    BOOST_CHECK_EQUAL(diff.total_delta, 130);
+
+    BOOST_REQUIRE_EQUAL(diff.headers.size(), 4u);
+    BOOST_CHECK_EQUAL(diff.headers[0].name, "/new/Includes.txt");
+    BOOST_CHECK_EQUAL(diff.headers[0].state, header_diff::changed);
+    BOOST_CHECK_EQUAL(diff.headers[0].delta(), 60);
+
+    BOOST_CHECK_EQUAL(diff.headers[1].name, "x.h");
+    BOOST_CHECK_EQUAL(diff.headers[1].state, header_diff::changed);
+    BOOST_CHECK_EQUAL(diff.headers[1].cost_before, 110u);
+    BOOST_CHECK_EQUAL(diff.headers[1].cost_after, 170u);
+
+    BOOST_CHECK_EQUAL(diff.headers[2].name, "z.h");
+    BOOST_CHECK_EQUAL(diff.headers[2].state, header_diff::added);
+    BOOST_CHECK_EQUAL(diff.headers[2].delta(), 20);
+    BOOST_REQUIRE_EQUAL(diff.headers[2].new_includers.size(), 1u);
+    BOOST_CHECK_EQUAL(diff.headers[2].new_includers[0], 0u);
+
+    BOOST_CHECK_EQUAL(diff.headers[3].name, "y.h");
+    BOOST_CHECK_EQUAL(diff.headers[3].state, header_diff::removed);
+    BOOST_CHECK_EQUAL(diff.headers[3].delta(), -10);
+
+    BOOST_REQUIRE_EQUAL(diff.added_edges.size(), 1u);
+    BOOST_CHECK_EQUAL(diff.added_edges[0].includer, "x.h");
+    BOOST_CHECK_EQUAL(diff.added_edges[0].included, "z.h");
+    BOOST_CHECK_EQUAL(diff.added_edges[0].cost, 20u);
+
+    BOOST_REQUIRE_EQUAL(diff.removed_edges.size(), 1u);
+    BOOST_CHECK_EQUAL(diff.removed_edges[0].includer, "x.h");
+    BOOST_CHECK_EQUAL(diff.removed_edges[0].included, "y.h");
+    BOOST_CHECK_EQUAL(diff.removed_edges[0].cost, 10u);
+}
+
+// -----------------------------------------------------------------------------
+//
+// A header named like a log but included by something is still a header.
+BOOST_AUTO_TEST_CASE(only_roots_match_as_logs)
+{
+    cpp_dep::include_graph_t before_graph = make_named_graph(
+        { "a/includes.txt", "b/includes.txt" },
+        { { 0, 1 } });
+
+    cpp_dep::include_graph_t after_graph = make_named_graph(
+        { "c/includes.txt" },
+        {});
+
+    diff_input before;
+    before.graph = &before_graph;
+    before.costs = { 10, 10 };
+    before.logs = { "includes.txt" };
+
+    diff_input after;
+    after.graph = &after_graph;
+    after.costs = { 10 };
+    after.logs = { "includes.txt" };
+
+    graph_diff diff = diff_graphs(before, after);
+    BOOST_REQUIRE_EQUAL(diff.headers.size(), 1u);
+    BOOST_CHECK_EQUAL(diff.headers[0].name, "b/includes.txt");
+    BOOST_CHECK_EQUAL(diff.headers[0].state, header_diff::removed);
+    BOOST_REQUIRE_EQUAL(diff.removed_edges.size(), 1u);
+    BOOST_CHECK(diff.added_edges.empty());
+}
+
+// -----------------------------------------------------------------------------
+//
+// The same graph with its vertices in another order has nothing to report,
+// and changing some costs reports exactly those headers, biggest first.
+BOOST_AUTO_TEST_CASE(renumbered_graphs)
+{
+    std::mt19937 rng(7);
+    for(int i = 0; i < 50; ++i)
+    {
+        int num_vertices = 1 + rng() % 40;
+        cpp_dep::include_graph_t before_graph = random_dag(rng, num_vertices, rng() % (num_vertices * 3));
+
+        std::vector<int> renumbered(num_vertices);
+        std::iota(renumbered.begin(), renumbered.end(), 0);
+        std::shuffle(renumbered.begin(), renumbered.end(), rng);
+
+        std::vector<std::size_t> sizes(num_vertices);
+        for(int v = 0; v < num_vertices; ++v)
+            sizes[renumbered[v]] = before_graph[v].size;
+
+        std::vector<std::pair<int, int>> edges;
+        for(auto e : boost::make_iterator_range(boost::edges(before_graph)))
+            edges.emplace_back(renumbered[boost::source(e, before_graph)], renumbered[boost::target(e, before_graph)]);
+
+        cpp_dep::include_graph_t after_graph = make_graph(sizes, edges);
+        for(int v = 0; v < num_vertices; ++v)
+            after_graph[renumbered[v]].name = before_graph[v].name;
+
+        diff_input before;
+        before.graph = &before_graph;
+        before.costs = project_costs(before_graph);
+
+        diff_input after;
+        after.graph = &after_graph;
+        after.costs = project_costs(after_graph);
+
+        graph_diff diff = diff_graphs(before, after);
+        BOOST_CHECK(diff.headers.empty());
+        BOOST_CHECK(diff.added_edges.empty());
+        BOOST_CHECK(diff.removed_edges.empty());
+        BOOST_CHECK_EQUAL(diff.total_delta, 0);
+
+        std::int64_t total_delta = 0;
+        std::size_t num_changed = 0;
+        for(int v = 0; v < num_vertices; ++v)
+        {
+            if(rng() % 4 == 0)
+            {
+                std::size_t grown = 1 + rng() % 100;
+                after.costs[renumbered[v]] += grown;
+                total_delta += grown;
+                ++num_changed;
+            }
+        }
+
+        diff = diff_graphs(before, after);
+        BOOST_CHECK_EQUAL(diff.headers.size(), num_changed);
+        BOOST_CHECK_EQUAL(diff.total_delta, total_delta);
+        for(std::size_t h = 1; h < diff.headers.size(); ++h)
+            BOOST_CHECK_GE(diff.headers[h - 1].delta(), diff.headers[h].delta());
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+BOOST_AUTO_TEST_CASE(project_costs_of_a_graph)
+{
+    cpp_dep::include_graph_t g = make_graph({ 1, 10, 100 }, { { 0, 1 }, { 1, 2 } });
+    g[0].size_dependencies = 110;
+    g[1].size_dependencies = 100;
+
+    std::vector<std::size_t> costs = project_costs(g);
+    std::vector<std::size_t> expected = { 111, 110, 100 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(costs.begin(), costs.end(), expected.begin(), expected.end());
+
+    aggregate_stats_t stats(3);
+    stats[0].transitive_size = 7;
+    stats[1].transitive_size = 8;
+    stats[2].transitive_size = 9;
+    costs = project_costs(g, &stats);
+    expected = { 7, 8, 9 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(costs.begin(), costs.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
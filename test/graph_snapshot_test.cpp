@@ -0,0 +1,215 @@
+// *****************************************************************************
+//
+// test/graph_snapshot_test.cpp
+//
+// A snapshot has to load back the graphs it was written from, and has to
+// be turned down once its log changes or a different normaliser asks.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+
+#include "test_graphs.hpp"
+#include "parse/graph_snapshot.hpp"
+#include "parse/include_log_parser.hpp"
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+namespace fs = boost::filesystem;
+
+// A copy of a sample log in the temp directory, removed along with its
+// snapshot when done.
+class temp_log
+{
+public:
+
+    explicit temp_log(char const* sample)
+        : filename_((fs::temp_directory_path() / fs::unique_path("cpp-size-test-%%%%-%%%%.txt")).string())
+    {
+        std::ifstream in(sample, std::ios::binary);
+        BOOST_REQUIRE_MESSAGE(in, "Failed to open " << sample);
+        contents_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        write(contents_);
+    }
+
+    ~temp_log()
+    {
+        boost::system::error_code ec;
+        fs::remove(filename_, ec);
+        fs::remove(snapshot_filename(filename_), ec);
+    }
+
+    temp_log(temp_log const&) = delete;
+    temp_log& operator=(temp_log const&) = delete;
+
+    std::string const& filename() const
+    {
+        return filename_;
+    }
+
+    std::string const& contents() const
+    {
+        return contents_;
+    }
+
+    void write(std::string const& contents)
+    {
+        std::ofstream out(filename_, std::ios::binary | std::ios::trunc);
+        out << contents;
+    }
+
+private:
+
+    std::string filename_;
+    std::string contents_;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(graph_snapshot_test)
+
+// -----------------------------------------------------------------------------
+//
+BOOST_AUTO_TEST_CASE(round_trip)
+{
+    for(char const* sample : { "test/includes-gcc.txt", "test/includes-msvc.txt" })
+    {
+        BOOST_TEST_CONTEXT(sample)
+        {
+            temp_log log(sample);
+            graph_snapshot parsed;
+            parsed.includes = read_include_log(log.filename().c_str(), 1);
+            parsed.paths = cpp_dep::invert_to_paths(parsed.includes);
+            parsed.has_paths = true;
+            write_graph_snapshot(log.filename(), parsed);
+
+            graph_snapshot loaded;
+            BOOST_REQUIRE(read_graph_snapshot(log.filename(), loaded));
+            BOOST_CHECK(loaded.has_paths);
+
+            std::vector<std::string> expected = summarise(parsed.includes);
+            std::vector<std::string> actual = summarise(loaded.includes);
+            BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+
+            expected = summarise(parsed.paths);
+            actual = summarise(loaded.paths);
+            BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+// Loading writes a snapshot the next load reads back, and one written
+// without paths is parsed again when paths are asked for.
+BOOST_AUTO_TEST_CASE(load_writes_snapshot)
+{
+    temp_log log("test/includes-gcc.txt");
+    BOOST_CHECK(!fs::exists(snapshot_filename(log.filename())));
+
+    std::shared_ptr<graph_snapshot> first = load_include_log(log.filename(), false, 1);
+    BOOST_CHECK(!first->has_paths);
+    BOOST_REQUIRE(fs::exists(snapshot_filename(log.filename())));
+
+    graph_snapshot loaded;
+    BOOST_REQUIRE(read_graph_snapshot(log.filename(), loaded));
+    BOOST_CHECK(!loaded.has_paths);
+    BOOST_CHECK(summarise(loaded.includes) == summarise(first->includes));
+
+    std::shared_ptr<graph_snapshot> with_paths = load_include_log(log.filename(), true, 1);
+    BOOST_CHECK(with_paths->has_paths);
+    BOOST_CHECK(summarise(with_paths->includes) == summarise(first->includes));
+    BOOST_REQUIRE(read_graph_snapshot(log.filename(), loaded));
+    BOOST_CHECK(loaded.has_paths);
+}
+
+// -----------------------------------------------------------------------------
+//
+BOOST_AUTO_TEST_CASE(stale_snapshots_are_rejected)
+{
+    temp_log log("test/includes-gcc.txt");
+    graph_snapshot loaded;
+    BOOST_CHECK(!read_graph_snapshot(log.filename(), loaded));
+
+    load_include_log(log.filename(), true, 1);
+    BOOST_REQUIRE(read_graph_snapshot(log.filename(), loaded));
+
+    // Another normaliser may have named the headers differently.
+    path_normaliser always_folded;
+    always_folded.set_case_folding(path_normaliser::case_folding::always);
+    BOOST_CHECK(!read_graph_snapshot(log.filename(), loaded, always_folded));
+
+    path_normaliser renamed;
+    renamed.add_root("/usr/include", "<system>");
+    BOOST_CHECK(!read_graph_snapshot(log.filename(), loaded, renamed));
+
+    // The same size and modification time with different contents.
+    std::time_t mtime = fs::last_write_time(log.filename());
+    std::string edited = log.contents();
+    edited[0] = edited[0] == '.' ? ',' : '.';
+    log.write(edited);
+    fs::last_write_time(log.filename(), mtime);
+    BOOST_CHECK_EQUAL(fs::file_size(log.filename()), log.contents().size());
+    BOOST_CHECK(!read_graph_snapshot(log.filename(), loaded));
+
+    // Back as it was, but appended to.
+    log.write(log.contents() + log.contents());
+    BOOST_CHECK(!read_graph_snapshot(log.filename(), loaded));
+}
+
+// -----------------------------------------------------------------------------
+//
+BOOST_AUTO_TEST_CASE(damaged_snapshots_are_rejected)
+{
+    temp_log log("test/includes-msvc.txt");
+    load_include_log(log.filename(), true, 1);
+
+    std::string snapshot = snapshot_filename(log.filename());
+    std::string bytes;
+    {
+        std::ifstream in(snapshot, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    BOOST_REQUIRE(bytes.size() > 64);
+    for(std::size_t length : { std::size_t(0), std::size_t(7), bytes.size() / 2, bytes.size() - 1 })
+    {
+        {
+            std::ofstream out(snapshot, std::ios::binary | std::ios::trunc);
+            out.write(bytes.data(), static_cast<std::streamsize>(length));
+        }
+
+        graph_snapshot loaded;
+        BOOST_CHECK_MESSAGE(!read_graph_snapshot(log.filename(), loaded), "Cut to " << length << " bytes");
+    }
+
+    // A damaged snapshot is replaced by the next load.
+    std::shared_ptr<graph_snapshot> reloaded = load_include_log(log.filename(), true, 1);
+    graph_snapshot loaded;
+    BOOST_REQUIRE(read_graph_snapshot(log.filename(), loaded));
+    BOOST_CHECK(summarise(loaded.includes) == summarise(reloaded->includes));
+}
+
+// -----------------------------------------------------------------------------
+//
+BOOST_AUTO_TEST_CASE(snapshot_filenames)
+{
+    BOOST_CHECK(!is_snapshot_filename("includes.txt"));
+    BOOST_CHECK(is_snapshot_filename(snapshot_filename("includes.txt")));
+    BOOST_CHECK(is_snapshot_filename(snapshot_filename("includes.txt") + ".tmp"));
+    BOOST_CHECK(!is_snapshot_filename("includes.txt.tmp"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
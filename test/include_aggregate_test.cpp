@@ -0,0 +1,187 @@
+// *****************************************************************************
+//
+// test/include_aggregate_test.cpp
+//
+// Project wide stats of graphs merged by header name, however the graphs
+// are split between partial aggregates, and translation units that turn
+// up in more than one log.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+
+#include "test_graphs.hpp"
+#include "analysis/include_aggregate.hpp"
+#include <boost/test/unit_test.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+struct file
+{
+    char const* name;
+    std::size_t size;
+    std::size_t size_dependencies;
+};
+
+cpp_dep::include_graph_t make_log(
+    std::vector<file> const& files,
+    std::vector<std::pair<int, int>> const& edges)
+{
+    cpp_dep::include_graph_t g = make_graph(std::vector<std::size_t>(files.size(), 0), edges);
+    for(std::size_t i = 0; i < files.size(); ++i)
+    {
+        g[i].name = files[i].name;
+        g[i].size = files[i].size;
+        g[i].size_dependencies = files[i].size_dependencies;
+    }
+
+    return g;
+}
+
+// a.cpp includes x.h, which includes y.h.
+cpp_dep::include_graph_t log_a()
+{
+    return make_log(
+        { { "a.cpp", 1, 110 }, { "x.h", 100, 10 }, { "y.h", 10, 0 } },
+        { { 0, 1 }, { 1, 2 } });
+}
+
+// b.cpp includes x.h, configured so it doesn't include y.h, and z.h.
+cpp_dep::include_graph_t log_b()
+{
+    return make_log(
+        { { "b.cpp", 2, 105 }, { "x.h", 100, 0 }, { "z.h", 5, 0 } },
+        { { 0, 1 }, { 0, 2 } });
+}
+
+// Two translation units in one log, c.cpp includes y.h and d.cpp
+// includes z.h.
+cpp_dep::include_graph_t log_cd()
+{
+    return make_log(
+        { { "c.cpp", 3, 10 }, { "y.h", 10, 0 }, { "d.cpp", 4, 5 }, { "z.h", 5, 0 } },
+        { { 0, 1 }, { 2, 3 } });
+}
+
+// Stats by name, as "translation units, bytes parsed, transitive size".
+std::map<std::string, std::string> stats_by_name(include_aggregate const& aggregate)
+{
+    std::map<std::string, std::string> by_name;
+    cpp_dep::include_graph_t const& g = aggregate.graph();
+    for(auto v : boost::make_iterator_range(boost::vertices(g)))
+    {
+        aggregate_header_stats const& s = aggregate.stats()[v];
+        by_name[g[v].name] =
+            std::to_string(s.num_translation_units) + " " +
+            std::to_string(s.bytes_parsed) + " " +
+            std::to_string(s.transitive_size);
+    }
+
+    return by_name;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(include_aggregate_test)
+
+// -----------------------------------------------------------------------------
+//
+// x.h pulls in y.h for a.cpp but not for b.cpp, so its cost is what each
+// of them saw rather than the most either saw twice over.
+BOOST_AUTO_TEST_CASE(stats)
+{
+    include_aggregate aggregate;
+    aggregate.add(log_a());
+    aggregate.add(log_b());
+    aggregate.add(log_cd());
+
+    BOOST_CHECK_EQUAL(aggregate.num_translation_units(), 4u);
+    BOOST_CHECK_EQUAL(boost::num_vertices(aggregate.graph()), 7u);
+
+    std::map<std::string, std::string> stats = stats_by_name(aggregate);
+    BOOST_CHECK_EQUAL(stats["x.h"], "2 200 210");
+
+    // Translation units are counted through the merged graph, where b.cpp
+    // reaches y.h through x.h, and y.h costs what it did in the others.
+    BOOST_CHECK_EQUAL(stats["y.h"], "3 30 30");
+    BOOST_CHECK_EQUAL(stats["z.h"], "2 10 10");
+    BOOST_CHECK_EQUAL(stats["a.cpp"], "1 1 111");
+    BOOST_CHECK_EQUAL(stats["d.cpp"], "1 4 9");
+}
+
+// -----------------------------------------------------------------------------
+//
+// However the logs are shared between partial aggregates, merging them
+// gives the same stats.
+BOOST_AUTO_TEST_CASE(merged_partials)
+{
+    include_aggregate whole;
+    whole.add(log_a());
+    whole.add(log_b());
+    whole.add(log_cd());
+
+    include_aggregate first;
+    first.add(log_cd());
+    include_aggregate second;
+    second.add(log_b());
+    second.add(log_a());
+    include_aggregate empty;
+
+    include_aggregate merged;
+    merged.merge(empty);
+    merged.merge(first);
+    merged.merge(second);
+
+    BOOST_CHECK(stats_by_name(merged) == stats_by_name(whole));
+    BOOST_CHECK_EQUAL(merged.num_translation_units(), whole.num_translation_units());
+}
+
+// -----------------------------------------------------------------------------
+//
+// The same translation unit in two logs is one translation unit, whether
+// the logs went to the same partial or not.
+BOOST_AUTO_TEST_CASE(repeated_translation_unit)
+{
+    include_aggregate once;
+    once.add(log_a());
+
+    include_aggregate twice;
+    twice.add(log_a());
+    twice.add(log_a());
+    BOOST_CHECK_EQUAL(twice.num_translation_units(), 1u);
+    BOOST_CHECK(stats_by_name(twice) == stats_by_name(once));
+
+    include_aggregate other;
+    other.add(log_a());
+    include_aggregate merged;
+    merged.add(log_a());
+    merged.merge(other);
+    BOOST_CHECK(stats_by_name(merged) == stats_by_name(once));
+}
+
+// -----------------------------------------------------------------------------
+//
+BOOST_AUTO_TEST_CASE(errors_are_merged)
+{
+    include_aggregate first;
+    first.add_error("a.txt: bad");
+    include_aggregate second;
+    second.add_error("b.txt: worse");
+    first.merge(second);
+
+    std::vector<std::string> expected = { "a.txt: bad", "b.txt: worse" };
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        first.errors().begin(), first.errors().end(),
+        expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
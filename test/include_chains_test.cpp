@@ -0,0 +1,246 @@
+// *****************************************************************************
+//
+// test/include_chains_test.cpp
+//
+// Include chains against every chain found by brute force, over random
+// graphs small enough to list them all, with and without cycles.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+
+#include "test_graphs.hpp"
+#include "analysis/include_chains.hpp"
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <set>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+typedef cpp_dep::include_vertex_descriptor_t vertex_t;
+typedef std::vector<vertex_t> chain_files;
+
+// Every chain without repeated files from a translation unit, or from
+// root, to v.
+std::set<chain_files> all_chains(cpp_dep::include_graph_t const& g, vertex_t v, vertex_t root)
+{
+    std::set<chain_files> found;
+    chain_files path(1, v);
+    std::vector<char> on_path(boost::num_vertices(g), 0);
+    on_path[v] = 1;
+
+    // Walks back up the includers so each chain is found once.
+    struct walker
+    {
+        cpp_dep::include_graph_t const& g;
+        vertex_t root;
+        std::set<chain_files>& found;
+        chain_files& path;
+        std::vector<char>& on_path;
+
+        void operator()(vertex_t u)
+        {
+            bool is_root = root == kAnyTranslationUnit ? boost::in_degree(u, g) == 0 : u == root;
+            if(is_root)
+            {
+                found.insert(chain_files(path.rbegin(), path.rend()));
+                return;
+            }
+
+            std::set<vertex_t> includers;
+            for(auto e : boost::make_iterator_range(boost::in_edges(u, g)))
+                includers.insert(boost::source(e, g));
+
+            for(vertex_t includer : includers)
+            {
+                if(on_path[includer])
+                    continue;
+
+                on_path[includer] = 1;
+                path.push_back(includer);
+                (*this)(includer);
+                path.pop_back();
+                on_path[includer] = 0;
+            }
+        }
+    };
+
+    walker{ g, root, found, path, on_path }(v);
+    return found;
+}
+
+std::size_t chain_bytes(cpp_dep::include_graph_t const& g, chain_files const& files)
+{
+    std::size_t bytes = 0;
+    for(vertex_t v : files)
+        bytes += g[v].size;
+
+    return bytes;
+}
+
+// Ranked as chains() ranks them, most bytes then fewest files.
+bool ranks_before(std::pair<std::size_t, std::size_t> a, std::pair<std::size_t, std::size_t> b)
+{
+    return a.first != b.first ? a.first > b.first : a.second < b.second;
+}
+
+void check_against_brute_force(cpp_dep::include_graph_t const& g, std::mt19937& rng)
+{
+    include_chain_index index(g);
+    std::size_t num_vertices = boost::num_vertices(g);
+    std::vector<vertex_t> roots(1, kAnyTranslationUnit);
+    for(vertex_t v = 0; v < num_vertices; ++v)
+    {
+        if(boost::in_degree(v, g) == 0)
+            roots.push_back(v);
+    }
+
+    for(vertex_t root : roots)
+    {
+        for(vertex_t v = 0; v < num_vertices; ++v)
+        {
+            std::set<chain_files> expected = all_chains(g, v, root);
+
+            // Anything only included from a cycle has no chain from a
+            // translation unit, but shortest_chain still answers for it.
+            include_chain shortest = index.shortest_chain(v, root);
+            if(expected.empty())
+            {
+                if(root != kAnyTranslationUnit)
+                    BOOST_CHECK(shortest.files.empty());
+
+                BOOST_CHECK(index.chains(v, 10, root).empty());
+                continue;
+            }
+
+            std::size_t fewest = num_vertices + 1;
+            for(auto&& files : expected)
+                fewest = std::min(fewest, files.size());
+
+            BOOST_CHECK(expected.count(shortest.files));
+            BOOST_CHECK_EQUAL(shortest.files.size(), fewest);
+            BOOST_CHECK_EQUAL(shortest.bytes, chain_bytes(g, shortest.files));
+
+            // Every chain once, ranked.
+            std::vector<include_chain> found = index.chains(v, expected.size() + 1, root);
+            std::set<chain_files> found_files;
+            for(std::size_t i = 0; i < found.size(); ++i)
+            {
+                BOOST_CHECK(expected.count(found[i].files));
+                BOOST_CHECK(found_files.insert(found[i].files).second);
+                BOOST_CHECK_EQUAL(found[i].bytes, chain_bytes(g, found[i].files));
+                if(i > 0)
+                {
+                    BOOST_CHECK(!ranks_before(
+                        std::make_pair(found[i].bytes, found[i].files.size()),
+                        std::make_pair(found[i - 1].bytes, found[i - 1].files.size())));
+                }
+            }
+
+            BOOST_CHECK(found_files == expected);
+
+            // The first few are the best few.
+            std::size_t max_chains = 1 + rng() % 3;
+            std::vector<std::pair<std::size_t, std::size_t>> ranked;
+            for(auto&& files : expected)
+                ranked.emplace_back(chain_bytes(g, files), files.size());
+
+            std::sort(ranked.begin(), ranked.end(), ranks_before);
+            std::vector<include_chain> best = index.chains(v, max_chains, root);
+            BOOST_REQUIRE_EQUAL(best.size(), std::min(max_chains, expected.size()));
+            for(std::size_t i = 0; i < best.size(); ++i)
+            {
+                BOOST_CHECK_EQUAL(best[i].bytes, ranked[i].first);
+                BOOST_CHECK_EQUAL(best[i].files.size(), ranked[i].second);
+            }
+
+            // Only the shortest candidates are ranked.
+            std::vector<std::size_t> lengths;
+            for(auto&& files : expected)
+                lengths.push_back(files.size());
+
+            std::sort(lengths.begin(), lengths.end());
+            std::size_t max_candidates = 1 + rng() % lengths.size();
+            for(auto&& chain : index.chains(v, 1, root, max_candidates))
+                BOOST_CHECK_LE(chain.files.size(), lengths[max_candidates - 1]);
+        }
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(include_chains_test)
+
+// -----------------------------------------------------------------------------
+//
+// 0 and 1 are translation units. 0 reaches 4 through 2 or through 3, and
+// 1 reaches it directly.
+BOOST_AUTO_TEST_CASE(hand_built_graph)
+{
+    cpp_dep::include_graph_t g = make_graph(
+        { 1, 2, 10, 100, 1000 },
+        { { 0, 2 }, { 0, 3 }, { 2, 4 }, { 3, 4 }, { 1, 4 }, { 2, 3 } });
+
+    include_chain_index index(g);
+    include_chain shortest = index.shortest_chain(4);
+    BOOST_CHECK(shortest.files == chain_files({ 1, 4 }));
+    BOOST_CHECK_EQUAL(shortest.bytes, 1002u);
+
+    shortest = index.shortest_chain(4, 0);
+    BOOST_CHECK_EQUAL(shortest.files.size(), 3u);
+    BOOST_CHECK(index.shortest_chain(2, 1).files.empty());
+
+    std::vector<include_chain> from_0 = index.chains(4, 10, 0);
+    BOOST_REQUIRE_EQUAL(from_0.size(), 3u);
+    BOOST_CHECK(from_0[0].files == chain_files({ 0, 2, 3, 4 }));
+    BOOST_CHECK_EQUAL(from_0[0].bytes, 1111u);
+    BOOST_CHECK(from_0[1].files == chain_files({ 0, 3, 4 }));
+    BOOST_CHECK(from_0[2].files == chain_files({ 0, 2, 4 }));
+
+    std::vector<include_chain> from_any = index.chains(4, 2);
+    BOOST_REQUIRE_EQUAL(from_any.size(), 2u);
+    BOOST_CHECK(from_any[0].files == chain_files({ 0, 2, 3, 4 }));
+    BOOST_CHECK(from_any[1].files == chain_files({ 0, 3, 4 }));
+}
+
+// -----------------------------------------------------------------------------
+//
+BOOST_AUTO_TEST_CASE(matches_brute_force_on_random_graphs)
+{
+    std::mt19937 rng(8);
+    for(int i = 0; i < 100; ++i)
+    {
+        int num_vertices = 2 + rng() % 10;
+        check_against_brute_force(random_dag(rng, num_vertices, rng() % (num_vertices * 2)), rng);
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+// Includes back up the graph make cycles that chains mustn't go round.
+BOOST_AUTO_TEST_CASE(matches_brute_force_on_random_cyclic_graphs)
+{
+    std::mt19937 rng(9);
+    for(int i = 0; i < 100; ++i)
+    {
+        int num_vertices = 2 + rng() % 10;
+        cpp_dep::include_graph_t g = random_dag(rng, num_vertices, rng() % (num_vertices * 2));
+        for(int e = 0; e < 3; ++e)
+        {
+            vertex_t a = rng() % num_vertices;
+            vertex_t b = rng() % num_vertices;
+            boost::add_edge(std::max(a, b), std::min(a, b), g);
+        }
+
+        check_against_brute_force(g, rng);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,236 @@
+// *****************************************************************************
+//
+// test/include_log_parser_test.cpp
+//
+// The chunked parser has to build the same graph as parsing the whole log
+// in one go, wherever the chunks are split.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+
+#include "test_graphs.hpp"
+#include "parse/include_log_parser.hpp"
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+char const* const kSampleLogs[] =
+{
+    "test/includes-gcc.txt",
+    "test/includes-msvc.txt",
+    "test/includes-simple.txt",
+};
+
+// Three translation units whose includes overlap, with one top level
+// include after the nested ones so a chunk can start part way through a
+// translation unit.
+char const kMultiUnitLog[] =
+    "a.cpp\r\n"
+    "Note: including file: x.h\r\n"
+    "Note: including file:  y.h\r\n"
+    "Note: including file:   z.h\r\n"
+    "Note: including file: y.h\r\n"
+    "b.cpp\r\n"
+    "Note: including file: y.h\r\n"
+    "Note: including file:  z.h\r\n"
+    "Note: including file: w.h\r\n"
+    "c.cpp\r\n"
+    "Note: including file: z.h\r\n"
+    "Note: including file: x.h\r\n"
+    "Note: including file:  y.h\r\n";
+
+std::string read_file(char const* filename)
+{
+    std::ifstream in(filename, std::ios::binary);
+    BOOST_REQUIRE_MESSAGE(in, "Failed to open " << filename);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// Offsets of every line the parallel parser may start a chunk at.
+std::vector<std::size_t> chunk_boundaries(std::string const& log)
+{
+    std::vector<std::size_t> boundaries;
+    for(std::size_t pos = 0; pos < log.size(); )
+    {
+        std::size_t eol = log.find('\n', pos);
+        std::size_t end = eol == std::string::npos ? log.size() : eol;
+        include_log_line line = classify_include_log_line(log.data() + pos, log.data() + end);
+        if((line.kind == include_log_line::include && line.depth == 1) ||
+            line.kind == include_log_line::source)
+        {
+            boundaries.push_back(pos);
+        }
+
+        pos = eol == std::string::npos ? log.size() : eol + 1;
+    }
+
+    return boundaries;
+}
+
+// Parses log split at each of splits, one builder per chunk appended in
+// order, as read_include_log does when it runs in parallel.
+std::vector<std::string> parse_split(std::string const& log, std::vector<std::size_t> const& splits)
+{
+    include_log_builder builder("log");
+    char const* first = log.data();
+    std::size_t begin = 0;
+    for(std::size_t c = 0; c <= splits.size(); ++c)
+    {
+        std::size_t end = c < splits.size() ? splits[c] : log.size();
+        if(c == 0)
+        {
+            builder.add_lines(first + begin, first + end);
+        }
+        else
+        {
+            include_log_builder chunk;
+            chunk.add_lines(first + begin, first + end);
+            builder.append(chunk);
+        }
+
+        begin = end;
+    }
+
+    return summarise(builder.finish(1));
+}
+
+void check_every_split(std::string const& log)
+{
+    std::vector<std::string> whole = parse_split(log, {});
+    for(std::size_t split : chunk_boundaries(log))
+    {
+        std::vector<std::string> parts = parse_split(log, { split });
+        BOOST_CHECK_EQUAL_COLLECTIONS(parts.begin(), parts.end(), whole.begin(), whole.end());
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(include_log_parser_test)
+
+// -----------------------------------------------------------------------------
+//
+BOOST_AUTO_TEST_CASE(split_at_every_boundary_of_sample_logs)
+{
+    for(char const* sample : kSampleLogs)
+    {
+        BOOST_TEST_CONTEXT(sample)
+        {
+            check_every_split(read_file(sample));
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+BOOST_AUTO_TEST_CASE(split_multiple_msvc_translation_units)
+{
+    check_every_split(kMultiUnitLog);
+
+    std::string log = kMultiUnitLog;
+    std::vector<std::size_t> boundaries = chunk_boundaries(log);
+    std::vector<std::string> whole = parse_split(log, {});
+    for(std::size_t i = 0; i < boundaries.size(); ++i)
+    {
+        for(std::size_t j = i + 1; j < boundaries.size(); ++j)
+        {
+            std::vector<std::string> parts = parse_split(log, { boundaries[i], boundaries[j] });
+            BOOST_CHECK_EQUAL_COLLECTIONS(parts.begin(), parts.end(), whole.begin(), whole.end());
+        }
+    }
+
+    // Each source starts a translation unit of its own, so the includes
+    // hang off the sources and not the log.
+    std::vector<std::string> expected =
+    {
+        "a.cpp -> x.h",
+        "a.cpp -> y.h",
+        "b.cpp -> w.h",
+        "b.cpp -> y.h",
+        "c.cpp -> x.h",
+        "c.cpp -> z.h",
+        "x.h -> y.h",
+        "x.h -> y.h",
+        "y.h -> z.h",
+        "y.h -> z.h",
+    };
+
+    std::vector<std::string> edges;
+    for(auto&& line : whole)
+    {
+        if(line.find(" -> ") != std::string::npos)
+            edges.push_back(line);
+    }
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(edges.begin(), edges.end(), expected.begin(), expected.end());
+}
+
+// -----------------------------------------------------------------------------
+//
+// Logs under a few megabytes are never split, so a sample is repeated
+// until read_include_log runs on more than one thread.
+BOOST_AUTO_TEST_CASE(parallel_read_matches_serial_read)
+{
+    namespace fs = boost::filesystem;
+
+    std::string const gcc = read_file("test/includes-gcc.txt");
+    std::string const msvc = read_file("test/includes-msvc.txt");
+    std::size_t const kLogSize = 12 * 1024 * 1024;
+
+    std::string gcc_log;
+    while(gcc_log.size() < kLogSize)
+        gcc_log += gcc;
+
+    // Renaming the source each time gives thousands of translation units.
+    std::string msvc_log;
+    for(int unit = 0; msvc_log.size() < kLogSize; ++unit)
+        msvc_log += "unit" + std::to_string(unit) + ".cpp\r\n" + msvc.substr(msvc.find('\n') + 1);
+
+    for(std::string const* log : { &gcc_log, &msvc_log })
+    {
+        fs::path filename = fs::temp_directory_path() / fs::unique_path("cpp-size-test-%%%%-%%%%.txt");
+        {
+            std::ofstream out(filename.string(), std::ios::binary);
+            out << *log;
+        }
+
+        std::vector<std::string> serial = summarise(read_include_log(filename.string().c_str(), 1));
+        std::vector<std::string> parallel = summarise(read_include_log(filename.string().c_str(), 4));
+        fs::remove(filename);
+
+        BOOST_CHECK_EQUAL_COLLECTIONS(parallel.begin(), parallel.end(), serial.begin(), serial.end());
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+// A stream is parsed as its reads arrive, so it's split wherever a read
+// happens to end.
+BOOST_AUTO_TEST_CASE(stream_read_matches_file_read)
+{
+    for(char const* sample : kSampleLogs)
+    {
+        BOOST_TEST_CONTEXT(sample)
+        {
+            std::istringstream in(read_file(sample));
+            std::vector<std::string> streamed = summarise(read_include_log(in, sample, 1));
+            std::vector<std::string> read = summarise(read_include_log(sample, 1));
+            BOOST_CHECK_EQUAL_COLLECTIONS(streamed.begin(), streamed.end(), read.begin(), read.end());
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,146 @@
+// *****************************************************************************
+//
+// test/path_normaliser_test.cpp
+//
+// Canonical names for separators, dot segments, case and mapped roots, and
+// which normalisers are told apart by their fingerprints.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+
+#include "parse/path_normaliser.hpp"
+#include <boost/test/unit_test.hpp>
+#include <stdexcept>
+#include <string>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+struct name_case
+{
+    char const* name;
+    char const* normalised;
+};
+
+name_case const kDefaultCases[] =
+{
+    // Already canonical.
+    { "/usr/include/c++/vector",                "/usr/include/c++/vector" },
+    { "include/a.h",                            "include/a.h" },
+
+    // Separators and dot segments.
+    { "a//b///c.h",                             "a/b/c.h" },
+    { "./a/./b.h",                              "a/b.h" },
+    { "/usr/include/../include/./stdio.h",      "/usr/include/stdio.h" },
+    { "../a/b.h",                               "../a/b.h" },
+    { "a/../../b.h",                            "../b.h" },
+    { "/../a.h",                                "/a.h" },
+    { ".",                                      "." },
+    { "a/..",                                   "." },
+
+    // Windows paths are folded to lower case, others aren't.
+    { "C:\\Program Files\\MSVC\\include\\vector", "c:/program files/msvc/include/vector" },
+    { "C:/Foo/../Bar.h",                        "c:/bar.h" },
+    { "C:\\..\\a.h",                            "c:/a.h" },
+    { "Foo\\Bar.h",                             "foo/bar.h" },
+    { "Foo/Bar.h",                              "Foo/Bar.h" },
+
+    // A UNC share keeps both its slashes.
+    { "\\\\Server\\Share\\A.h",                 "//server/share/a.h" },
+    { "//server/share/../a.h",                  "//server/a.h" },
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(path_normaliser_test)
+
+// -----------------------------------------------------------------------------
+//
+BOOST_AUTO_TEST_CASE(default_normalisation)
+{
+    path_normaliser normalise;
+    for(auto&& c : kDefaultCases)
+    {
+        BOOST_CHECK_EQUAL(normalise(c.name), c.normalised);
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+BOOST_AUTO_TEST_CASE(case_folding)
+{
+    path_normaliser never;
+    never.set_case_folding(path_normaliser::case_folding::never);
+    BOOST_CHECK_EQUAL(never("C:\\Foo\\Bar.h"), "C:/Foo/Bar.h");
+
+    path_normaliser always;
+    always.set_case_folding(path_normaliser::case_folding::always);
+    BOOST_CHECK_EQUAL(always("/Usr/Include/A.h"), "/usr/include/a.h");
+
+    BOOST_CHECK(parse_case_folding("auto") == path_normaliser::case_folding::windows_paths);
+    BOOST_CHECK(parse_case_folding("always") == path_normaliser::case_folding::always);
+    BOOST_CHECK(parse_case_folding("never") == path_normaliser::case_folding::never);
+    BOOST_CHECK_THROW(parse_case_folding("Always"), std::runtime_error);
+}
+
+// -----------------------------------------------------------------------------
+//
+BOOST_AUTO_TEST_CASE(mapped_roots)
+{
+    path_normaliser normalise;
+    normalise.add_root("C:\\msys64\\mingw64", "<toolchain>");
+    normalise.add_root("/usr=<usr>");
+    normalise.add_root("/usr/include", "<include>/");
+
+    // The root is normalised like any other name.
+    BOOST_CHECK_EQUAL(normalise("C:/MSYS64/mingw64/include/stdio.h"), "<toolchain>/include/stdio.h");
+    BOOST_CHECK_EQUAL(normalise("c:\\msys64\\mingw64"), "<toolchain>");
+
+    // Only whole segments match and the longest root wins.
+    BOOST_CHECK_EQUAL(normalise("C:/msys64/mingw64x/a.h"), "c:/msys64/mingw64x/a.h");
+    BOOST_CHECK_EQUAL(normalise("/usr/include/a.h"), "<include>/a.h");
+    BOOST_CHECK_EQUAL(normalise("/usr/lib/a.h"), "<usr>/lib/a.h");
+    BOOST_CHECK_EQUAL(normalise("/usr/include2/a.h"), "<usr>/include2/a.h");
+    BOOST_CHECK_EQUAL(normalise("/usr2/a.h"), "/usr2/a.h");
+
+    // Names are matched once they're canonical.
+    BOOST_CHECK_EQUAL(normalise("/usr/lib/../include/a.h"), "<include>/a.h");
+
+    BOOST_CHECK_THROW(normalise.add_root("no-mapping"), std::runtime_error);
+    BOOST_CHECK_THROW(normalise.add_root("=to"), std::runtime_error);
+}
+
+// -----------------------------------------------------------------------------
+//
+BOOST_AUTO_TEST_CASE(fingerprints)
+{
+    path_normaliser plain;
+    BOOST_CHECK_EQUAL(plain.fingerprint(), path_normaliser().fingerprint());
+
+    path_normaliser never;
+    never.set_case_folding(path_normaliser::case_folding::never);
+    BOOST_CHECK_NE(plain.fingerprint(), never.fingerprint());
+
+    path_normaliser mapped;
+    mapped.add_root("/usr", "<usr>");
+    BOOST_CHECK_NE(plain.fingerprint(), mapped.fingerprint());
+
+    path_normaliser mapped_elsewhere;
+    mapped_elsewhere.add_root("/usr", "<system>");
+    BOOST_CHECK_NE(mapped.fingerprint(), mapped_elsewhere.fingerprint());
+
+    // Roots split differently between from and to are still different.
+    path_normaliser split_one;
+    split_one.add_root("/ab", "c");
+    path_normaliser split_two;
+    split_two.add_root("/a", "bc");
+    BOOST_CHECK_NE(split_one.fingerprint(), split_two.fingerprint());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
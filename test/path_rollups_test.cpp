@@ -0,0 +1,138 @@
+// *****************************************************************************
+//
+// test/path_rollups_test.cpp
+//
+// Directory totals of hand built path graphs, named by component and in
+// full, matched against the include graph they came from.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+
+#include "test_graphs.hpp"
+#include "analysis/path_rollups.hpp"
+#include <boost/test/unit_test.hpp>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+cpp_dep::include_graph_t make_named_graph(
+    std::vector<std::string> const& names,
+    std::vector<std::size_t> const& sizes,
+    std::vector<std::pair<int, int>> const& edges)
+{
+    cpp_dep::include_graph_t g = make_graph(sizes, edges);
+    for(std::size_t i = 0; i < names.size(); ++i)
+        g[i].name = names[i];
+
+    return g;
+}
+
+// main.cpp includes a.h, which includes b.h, and includes b.h and c.h
+// itself.
+cpp_dep::include_graph_t make_includes()
+{
+    return make_named_graph(
+        { "main.cpp", "/usr/include/a.h", "/usr/include/sys/b.h", "/proj/c.h" },
+        { 1, 100, 10, 1000 },
+        { { 0, 1 }, { 0, 2 }, { 1, 2 }, { 0, 3 } });
+}
+
+void check_rollup(path_rollup const& rollup, std::size_t total_bytes, std::size_t num_headers, std::size_t inclusions)
+{
+    BOOST_CHECK_EQUAL(rollup.total_bytes, total_bytes);
+    BOOST_CHECK_EQUAL(rollup.num_headers, num_headers);
+    BOOST_CHECK_EQUAL(rollup.inclusions, inclusions);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(path_rollups_test)
+
+// -----------------------------------------------------------------------------
+//
+// Files are found by joining the components, and one the include graph
+// doesn't have keeps its own size from the path graph.
+BOOST_AUTO_TEST_CASE(named_by_component)
+{
+    cpp_dep::include_graph_t includes = make_includes();
+    cpp_dep::include_graph_t paths = make_named_graph(
+        { "/usr/include", "a.h", "sys", "b.h", "/proj", "c.h", "missing.h" },
+        { 0, 0, 0, 0, 0, 0, 7 },
+        { { 0, 1 }, { 0, 2 }, { 2, 3 }, { 4, 5 }, { 4, 6 } });
+
+    path_rollups_t rollups = rollup_paths(paths, includes);
+    BOOST_REQUIRE_EQUAL(rollups.size(), 7u);
+    check_rollup(rollups[0], 110, 2, 3);
+    check_rollup(rollups[1], 100, 1, 1);
+    check_rollup(rollups[2], 10, 1, 2);
+    check_rollup(rollups[3], 10, 1, 2);
+    check_rollup(rollups[4], 1007, 2, 1);
+    check_rollup(rollups[5], 1000, 1, 1);
+    check_rollup(rollups[6], 7, 1, 0);
+}
+
+// -----------------------------------------------------------------------------
+//
+BOOST_AUTO_TEST_CASE(named_in_full)
+{
+    cpp_dep::include_graph_t includes = make_includes();
+    cpp_dep::include_graph_t paths = make_named_graph(
+        { "/usr", "/usr/include", "/usr/include/a.h", "/usr/include/sys", "/usr/include/sys/b.h" },
+        { 0, 0, 0, 0, 0 },
+        { { 0, 1 }, { 1, 2 }, { 1, 3 }, { 3, 4 } });
+
+    path_rollups_t rollups = rollup_paths(paths, includes);
+    check_rollup(rollups[0], 110, 2, 3);
+    check_rollup(rollups[1], 110, 2, 3);
+    check_rollup(rollups[3], 10, 1, 2);
+}
+
+// -----------------------------------------------------------------------------
+//
+// A name that only shares a prefix with its parent isn't under it, so is
+// joined on.
+BOOST_AUTO_TEST_CASE(whole_segments_only)
+{
+    cpp_dep::include_graph_t includes = make_named_graph(
+        { "main.cpp", "/usr/include2.h" },
+        { 1, 50 },
+        { { 0, 1 } });
+
+    cpp_dep::include_graph_t paths = make_named_graph(
+        { "/usr/include", "/usr/include2.h" },
+        { 0, 3 },
+        { { 0, 1 } });
+
+    path_rollups_t rollups = rollup_paths(paths, includes);
+    check_rollup(rollups[0], 3, 1, 0);
+}
+
+// -----------------------------------------------------------------------------
+//
+// A file under two roots is only counted by the one that reaches it first.
+BOOST_AUTO_TEST_CASE(shared_files_counted_once)
+{
+    cpp_dep::include_graph_t includes = make_named_graph(
+        { "main.cpp", "/a/x.h" },
+        { 1, 50 },
+        { { 0, 1 } });
+
+    cpp_dep::include_graph_t paths = make_named_graph(
+        { "/a", "/b", "x.h" },
+        { 0, 0, 0 },
+        { { 0, 2 }, { 1, 2 } });
+
+    path_rollups_t rollups = rollup_paths(paths, includes);
+    check_rollup(rollups[0], 50, 1, 1);
+    check_rollup(rollups[1], 0, 0, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,194 @@
+// *****************************************************************************
+//
+// test/pch_recommender_test.cpp
+//
+// Which headers recommend_pch picks on small hand built graphs, the budget
+// and byte counts on random ones, and stopping when cancelled.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+
+#include "test_graphs.hpp"
+#include "analysis/pch_recommender.hpp"
+#include <boost/test/unit_test.hpp>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+typedef cpp_dep::include_vertex_descriptor_t vertex_t;
+
+class cancelled_monitor : public task_monitor
+{
+public:
+
+    void progress(char const*, int) override
+    {}
+
+    bool cancelled() const override
+    {
+        return true;
+    }
+};
+
+// Everything the picked headers include, each header once.
+std::vector<char> pch_contents(cpp_dep::include_graph_t const& g, pch_recommendation const& pch)
+{
+    std::vector<char> in_pch(boost::num_vertices(g), 0);
+    std::vector<vertex_t> pending;
+    for(auto&& h : pch.headers)
+    {
+        in_pch[h.vertex] = 1;
+        pending.push_back(h.vertex);
+    }
+
+    while(!pending.empty())
+    {
+        vertex_t v = pending.back();
+        pending.pop_back();
+        for(auto child : boost::make_iterator_range(boost::adjacent_vertices(v, g)))
+        {
+            if(!in_pch[child])
+            {
+                in_pch[child] = 1;
+                pending.push_back(child);
+            }
+        }
+    }
+
+    return in_pch;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(pch_recommender_test)
+
+// -----------------------------------------------------------------------------
+//
+// 0 and 1 are translation units that both include 2, which includes 4.
+// Only 0 includes 3, so it isn't shared enough to pick.
+BOOST_AUTO_TEST_CASE(hand_built_graph)
+{
+    cpp_dep::include_graph_t g = make_graph(
+        { 1, 1, 100, 1000, 10 },
+        { { 0, 2 }, { 1, 2 }, { 2, 4 }, { 0, 3 } });
+
+    std::vector<std::size_t> translation_units = translation_unit_counts(g);
+    std::vector<std::size_t> expected_units = { 1, 1, 2, 1, 2 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        translation_units.begin(), translation_units.end(),
+        expected_units.begin(), expected_units.end());
+
+    pch_recommendation pch = recommend_pch(g, translation_units);
+    BOOST_REQUIRE_EQUAL(pch.headers.size(), 1u);
+    BOOST_CHECK_EQUAL(pch.headers[0].vertex, 2u);
+    BOOST_CHECK_EQUAL(pch.headers[0].added_bytes, 110u);
+    BOOST_CHECK_EQUAL(pch.headers[0].saved_bytes, 220u);
+    BOOST_CHECK_EQUAL(pch.headers[0].num_translation_units, 2u);
+    BOOST_CHECK_EQUAL(pch.pch_bytes, 110u);
+    BOOST_CHECK_EQUAL(pch.bytes_saved, 220u);
+    BOOST_CHECK_EQUAL(pch.bytes_parsed, 1222u);
+
+    // 2 and what it includes no longer fit, but 4 alone does.
+    pch_options small;
+    small.budget = 50;
+    pch = recommend_pch(g, translation_units, small);
+    BOOST_REQUIRE_EQUAL(pch.headers.size(), 1u);
+    BOOST_CHECK_EQUAL(pch.headers[0].vertex, 4u);
+    BOOST_CHECK_EQUAL(pch.pch_bytes, 10u);
+    BOOST_CHECK_EQUAL(pch.bytes_saved, 20u);
+
+    // Letting 3 be picked from a single translation unit adds it too.
+    pch_options single;
+    single.min_translation_units = 1;
+    pch = recommend_pch(g, translation_units, single);
+    BOOST_CHECK_EQUAL(pch.pch_bytes, 1110u);
+    BOOST_CHECK_EQUAL(pch.bytes_saved, 1220u);
+}
+
+// -----------------------------------------------------------------------------
+//
+// 3 is in every translation unit so has the best ratio, but once it's in
+// 4 doesn't fit, and 4 alone saves more.
+BOOST_AUTO_TEST_CASE(best_single_header)
+{
+    cpp_dep::include_graph_t g = make_graph(
+        { 1, 1, 1, 10, 100 },
+        { { 0, 3 }, { 1, 3 }, { 2, 3 }, { 0, 4 }, { 1, 4 } });
+
+    pch_options options;
+    options.budget = 100;
+    pch_recommendation pch = recommend_pch(g, translation_unit_counts(g), options);
+    BOOST_REQUIRE_EQUAL(pch.headers.size(), 1u);
+    BOOST_CHECK_EQUAL(pch.headers[0].vertex, 4u);
+    BOOST_CHECK_EQUAL(pch.pch_bytes, 100u);
+    BOOST_CHECK_EQUAL(pch.bytes_saved, 200u);
+}
+
+// -----------------------------------------------------------------------------
+//
+// Whatever is picked fits the budget, and the bytes it reports are the
+// bytes of everything the picks pull in.
+BOOST_AUTO_TEST_CASE(byte_counts_on_random_graphs)
+{
+    std::mt19937 rng(5);
+    for(int i = 0; i < 200; ++i)
+    {
+        int num_vertices = 2 + rng() % 40;
+        cpp_dep::include_graph_t g = random_dag(rng, num_vertices, rng() % (num_vertices * 3));
+        std::vector<std::size_t> translation_units = translation_unit_counts(g);
+
+        pch_options options;
+        options.budget = rng() % 5000;
+        options.min_translation_units = 1 + rng() % 3;
+        options.num_threads = 1 + rng() % 4;
+        pch_recommendation pch = recommend_pch(g, translation_units, options);
+
+        std::vector<char> in_pch = pch_contents(g, pch);
+        std::size_t pch_bytes = 0;
+        std::size_t bytes_saved = 0;
+        std::size_t bytes_parsed = 0;
+        for(auto v : boost::make_iterator_range(boost::vertices(g)))
+        {
+            bytes_parsed += g[v].size * translation_units[v];
+            if(in_pch[v])
+            {
+                pch_bytes += g[v].size;
+                bytes_saved += g[v].size * translation_units[v];
+            }
+        }
+
+        std::size_t added_bytes = 0;
+        for(auto&& h : pch.headers)
+        {
+            BOOST_CHECK(boost::in_degree(h.vertex, g) != 0);
+            added_bytes += h.added_bytes;
+        }
+
+        BOOST_CHECK_LE(pch.pch_bytes, options.budget);
+        BOOST_CHECK_EQUAL(pch.pch_bytes, pch_bytes);
+        BOOST_CHECK_EQUAL(added_bytes, pch_bytes);
+        BOOST_CHECK_EQUAL(pch.bytes_saved, bytes_saved);
+        BOOST_CHECK_EQUAL(pch.bytes_parsed, bytes_parsed);
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+BOOST_AUTO_TEST_CASE(cancelled)
+{
+    std::mt19937 rng(6);
+    cpp_dep::include_graph_t g = random_dag(rng, 100, 300);
+    cancelled_monitor monitor;
+    BOOST_CHECK_THROW(
+        recommend_pch(g, translation_unit_counts(g), pch_options(), &monitor),
+        task_cancelled);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,161 @@
+// *****************************************************************************
+//
+// test/redundant_includes_test.cpp
+//
+// find_redundant_includes against a depth first search from every direct
+// include, over random graphs small enough to check by brute force.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+
+#include "test_graphs.hpp"
+#include "analysis/pch_recommender.hpp"
+#include "analysis/redundant_includes.hpp"
+#include <boost/test/unit_test.hpp>
+#include <set>
+#include <utility>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+typedef cpp_dep::include_vertex_descriptor_t vertex_t;
+
+// True if to can be reached from from through at least one include.
+bool reaches(cpp_dep::include_graph_t const& g, vertex_t from, vertex_t to)
+{
+    std::vector<char> visited(boost::num_vertices(g), 0);
+    std::vector<vertex_t> stack(1, from);
+    while(!stack.empty())
+    {
+        vertex_t v = stack.back();
+        stack.pop_back();
+        for(auto child : boost::make_iterator_range(boost::adjacent_vertices(v, g)))
+        {
+            if(child == to)
+                return true;
+
+            if(!visited[child])
+            {
+                visited[child] = 1;
+                stack.push_back(child);
+            }
+        }
+    }
+
+    return false;
+}
+
+std::set<std::pair<vertex_t, vertex_t>> brute_force_redundant(cpp_dep::include_graph_t const& g)
+{
+    std::set<std::pair<vertex_t, vertex_t>> redundant;
+    for(auto includer : boost::make_iterator_range(boost::vertices(g)))
+    {
+        for(auto included : boost::make_iterator_range(boost::adjacent_vertices(includer, g)))
+        {
+            for(auto via : boost::make_iterator_range(boost::adjacent_vertices(includer, g)))
+            {
+                if(reaches(g, via, included))
+                    redundant.emplace(includer, included);
+            }
+        }
+    }
+
+    return redundant;
+}
+
+void check_against_brute_force(cpp_dep::include_graph_t const& g, unsigned num_threads, std::size_t chunk_bytes)
+{
+    std::vector<std::size_t> translation_units = translation_unit_counts(g);
+    std::vector<redundant_include> found = find_redundant_includes(g, translation_units, num_threads, chunk_bytes);
+
+    std::set<std::pair<vertex_t, vertex_t>> found_edges;
+    for(auto&& r : found)
+    {
+        BOOST_CHECK(found_edges.emplace(r.includer, r.included).second);
+        BOOST_CHECK(boost::edge(r.includer, r.via, g).second);
+        BOOST_CHECK(r.via != r.included);
+        BOOST_CHECK(reaches(g, r.via, r.included));
+        BOOST_CHECK_EQUAL(r.bytes, g[r.included].size);
+        BOOST_CHECK_EQUAL(r.occurence, translation_units[r.includer]);
+    }
+
+    for(std::size_t i = 1; i < found.size(); ++i)
+    {
+        BOOST_CHECK_GE(found[i - 1].bytes * found[i - 1].occurence, found[i].bytes * found[i].occurence);
+    }
+
+    std::set<std::pair<vertex_t, vertex_t>> expected = brute_force_redundant(g);
+    BOOST_CHECK(found_edges == expected);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(redundant_includes_test)
+
+// -----------------------------------------------------------------------------
+//
+BOOST_AUTO_TEST_CASE(matches_brute_force_on_random_graphs)
+{
+    std::mt19937 rng(1);
+    for(int i = 0; i < 200; ++i)
+    {
+        int num_vertices = 2 + rng() % 30;
+        cpp_dep::include_graph_t g = random_dag(rng, num_vertices, rng() % (num_vertices * 3));
+        check_against_brute_force(g, 1, 32 * 1024 * 1024);
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+// A budget this small gives 64 targets per chunk, so graphs this size
+// take several chunks spread over several threads.
+BOOST_AUTO_TEST_CASE(matches_brute_force_across_chunks)
+{
+    std::mt19937 rng(2);
+    for(int i = 0; i < 10; ++i)
+    {
+        cpp_dep::include_graph_t g = random_dag(rng, 300, 1500);
+        check_against_brute_force(g, 4, 1);
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+BOOST_AUTO_TEST_CASE(hand_built_graph)
+{
+    // 0 includes 1 and 2 directly and 2 again through 1. 3 includes 4
+    // twice, which is only written twice and not redundant.
+    cpp_dep::include_graph_t g = make_graph(
+        { 10, 20, 30, 40, 50 },
+        { { 0, 1 }, { 0, 2 }, { 1, 2 }, { 3, 4 }, { 3, 4 } });
+
+    std::vector<redundant_include> found = find_redundant_includes(g, translation_unit_counts(g), 1);
+    BOOST_REQUIRE_EQUAL(found.size(), 1u);
+    BOOST_CHECK_EQUAL(found[0].includer, 0u);
+    BOOST_CHECK_EQUAL(found[0].included, 2u);
+    BOOST_CHECK_EQUAL(found[0].via, 1u);
+    BOOST_CHECK_EQUAL(found[0].bytes, 30u);
+    BOOST_CHECK_EQUAL(found[0].occurence, 1u);
+}
+
+// -----------------------------------------------------------------------------
+//
+BOOST_AUTO_TEST_CASE(cycle_is_not_redundant)
+{
+    // 1 and 2 include each other, so 2 reaches 3 only through its own
+    // includer and 1 including 3 isn't redundant.
+    cpp_dep::include_graph_t g = make_graph(
+        { 10, 20, 30, 40 },
+        { { 0, 1 }, { 1, 2 }, { 1, 3 }, { 2, 1 } });
+
+    BOOST_CHECK(find_redundant_includes(g, translation_unit_counts(g), 1).empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,254 @@
+// *****************************************************************************
+//
+// test/removal_simulator_test.cpp
+//
+// Removing and restoring includes, checked against what is still reachable
+// from the translation units and against the sizes before anything was
+// removed.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+
+#include "test_graphs.hpp"
+#include "ui/removal_simulator.hpp"
+#include "ui/tree_view_builder.hpp"
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+typedef cpp_dep::include_vertex_descriptor_t vertex_t;
+
+std::shared_ptr<include_tree> build_tree(cpp_dep::include_graph_t g)
+{
+    tree_view_builder build(tree_view_builder::option::checkbox);
+    return build(std::make_shared<cpp_dep::include_graph_t const>(std::move(g)));
+}
+
+// What the translation units still reach once removed is taken out.
+std::vector<bool> reachable(
+    cpp_dep::include_graph_t const& g,
+    std::set<std::pair<vertex_t, vertex_t>> const& removed)
+{
+    std::vector<bool> reached(boost::num_vertices(g), false);
+    std::vector<vertex_t> pending;
+    for(auto v : boost::make_iterator_range(boost::vertices(g)))
+    {
+        if(boost::in_degree(v, g) == 0)
+        {
+            reached[v] = true;
+            pending.push_back(v);
+        }
+    }
+
+    while(!pending.empty())
+    {
+        vertex_t v = pending.back();
+        pending.pop_back();
+        for(auto child : boost::make_iterator_range(boost::adjacent_vertices(v, g)))
+        {
+            if(!reached[child] && !removed.count(std::make_pair(v, child)))
+            {
+                reached[child] = true;
+                pending.push_back(child);
+            }
+        }
+    }
+
+    return reached;
+}
+
+// A random DAG with some includes back up the graph. Nothing includes
+// the translation units, so they stay the roots.
+cpp_dep::include_graph_t random_cyclic_graph(std::mt19937& rng, int num_vertices, int num_edges)
+{
+    cpp_dep::include_graph_t g = random_dag(rng, num_vertices, num_edges);
+    int num_back_edges = 1 + rng() % 4;
+    for(int e = 0; e < num_back_edges; ++e)
+    {
+        vertex_t a = rng() % num_vertices;
+        vertex_t b = rng() % num_vertices;
+        if(boost::in_degree(std::min(a, b), g) != 0)
+            boost::add_edge(std::max(a, b), std::min(a, b), g);
+    }
+
+    return g;
+}
+
+// Removes and restores random includes, checking after each step that
+// exactly what's reachable is included, then restores everything and
+// checks every size is back.
+void check_round_trips(cpp_dep::include_graph_t const& g, std::mt19937& rng)
+{
+    std::shared_ptr<include_tree> tree = build_tree(g);
+    removal_simulator removals(*tree);
+
+    std::size_t num_files = boost::num_vertices(g);
+    std::vector<std::size_t> initial_sizes;
+    for(vertex_t v = 0; v < num_files; ++v)
+        initial_sizes.push_back(removals.file_size(v));
+
+    std::vector<std::pair<vertex_t, vertex_t>> edges;
+    for(auto e : boost::make_iterator_range(boost::edges(g)))
+        edges.emplace_back(boost::source(e, g), boost::target(e, g));
+
+    if(edges.empty())
+        return;
+
+    std::set<std::pair<vertex_t, vertex_t>> removed;
+    for(int step = 0; step < 50; ++step)
+    {
+        std::pair<vertex_t, vertex_t> edge = edges[rng() % edges.size()];
+        if(rng() % 3 != 0)
+        {
+            BOOST_CHECK_EQUAL(removals.remove_include(edge.first, edge.second), removed.insert(edge).second);
+        }
+        else
+        {
+            BOOST_CHECK_EQUAL(removals.restore_include(edge.first, edge.second), removed.erase(edge) != 0);
+        }
+
+        std::vector<bool> expected = reachable(g, removed);
+        for(vertex_t v = 0; v < num_files; ++v)
+        {
+            BOOST_CHECK_EQUAL(removals.is_included(v), expected[v]);
+            if(!expected[v])
+                BOOST_CHECK_EQUAL(removals.file_size(v), 0u);
+        }
+    }
+
+    std::vector<std::pair<vertex_t, vertex_t>> to_restore(removed.begin(), removed.end());
+    std::shuffle(to_restore.begin(), to_restore.end(), rng);
+    for(auto&& edge : to_restore)
+        BOOST_CHECK(removals.restore_include(edge.first, edge.second));
+
+    for(vertex_t v = 0; v < num_files; ++v)
+    {
+        BOOST_CHECK(removals.is_included(v));
+        BOOST_CHECK_EQUAL(removals.file_size(v), initial_sizes[v]);
+        BOOST_CHECK_EQUAL(removals.removed_includes(v), 0);
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(removal_simulator_test)
+
+// -----------------------------------------------------------------------------
+//
+// 0 includes 1 and 3, which both include 2.
+BOOST_AUTO_TEST_CASE(hand_built_graph)
+{
+    cpp_dep::include_graph_t g = make_graph(
+        { 1, 10, 100, 1000 },
+        { { 0, 1 }, { 1, 2 }, { 0, 3 }, { 3, 2 } });
+
+    g[0].size_dependencies = 1110;
+    g[1].size_dependencies = 100;
+    g[3].size_dependencies = 100;
+
+    std::shared_ptr<include_tree> tree = build_tree(g);
+    removal_simulator removals(*tree);
+    BOOST_CHECK_EQUAL(removals.file_size(0), 1111u);
+
+    // 2 is still included through 3.
+    BOOST_CHECK(removals.remove_include(0, 1));
+    BOOST_CHECK(!removals.remove_include(0, 1));
+    BOOST_CHECK(removals.is_removed(0, 1));
+    BOOST_CHECK(!removals.is_included(1));
+    BOOST_CHECK(removals.is_included(2));
+    BOOST_CHECK_EQUAL(removals.file_size(1), 0u);
+    BOOST_CHECK_EQUAL(removals.file_size(0), 1101u);
+    BOOST_CHECK_EQUAL(removals.removed_includes(1), 1);
+
+    BOOST_CHECK(removals.remove_include(3, 2));
+    BOOST_CHECK(!removals.is_included(2));
+    BOOST_CHECK_EQUAL(removals.file_size(2), 0u);
+    BOOST_CHECK_EQUAL(removals.file_size(0), 1001u);
+
+    BOOST_CHECK(removals.restore_include(3, 2));
+    BOOST_CHECK(!removals.restore_include(3, 2));
+    BOOST_CHECK(removals.is_included(2));
+    BOOST_CHECK_EQUAL(removals.file_size(0), 1101u);
+
+    BOOST_CHECK(removals.restore_include(0, 1));
+    BOOST_CHECK(removals.is_included(1));
+    BOOST_CHECK_EQUAL(removals.file_size(0), 1111u);
+    BOOST_CHECK_EQUAL(removals.file_size(1), 110u);
+    BOOST_CHECK_EQUAL(removals.removed_includes(1), 0);
+}
+
+// -----------------------------------------------------------------------------
+//
+// 0 includes 1, and 1 and 2 include each other, so once 0 stops
+// including 1 the cycle is all that's left holding them.
+BOOST_AUTO_TEST_CASE(cycle_is_dropped)
+{
+    cpp_dep::include_graph_t g = make_graph(
+        { 1000, 100, 10 },
+        { { 0, 1 }, { 1, 2 }, { 2, 1 } });
+
+    g[0].size_dependencies = 110;
+    g[1].size_dependencies = 10;
+    g[2].size_dependencies = 100;
+
+    std::shared_ptr<include_tree> tree = build_tree(g);
+    removal_simulator removals(*tree);
+    BOOST_CHECK_EQUAL(removals.file_size(0), 1110u);
+
+    BOOST_CHECK(removals.remove_include(0, 1));
+    BOOST_CHECK(!removals.is_included(1));
+    BOOST_CHECK(!removals.is_included(2));
+    BOOST_CHECK_EQUAL(removals.file_size(0), 1000u);
+
+    BOOST_CHECK(removals.restore_include(0, 1));
+    BOOST_CHECK(removals.is_included(1));
+    BOOST_CHECK(removals.is_included(2));
+    BOOST_CHECK_EQUAL(removals.file_size(0), 1110u);
+    BOOST_CHECK_EQUAL(removals.removed_includes(1), 0);
+    BOOST_CHECK_EQUAL(removals.removed_includes(2), 0);
+
+    // Breaking the cycle itself leaves 1 included from 0.
+    BOOST_CHECK(removals.remove_include(2, 1));
+    BOOST_CHECK(removals.is_included(1));
+    BOOST_CHECK(removals.is_included(2));
+}
+
+// -----------------------------------------------------------------------------
+//
+// Random removals and restores, in any order, always leave exactly what's
+// reachable included, and restoring everything puts every size back.
+BOOST_AUTO_TEST_CASE(round_trips_on_random_graphs)
+{
+    std::mt19937 rng(3);
+    for(int i = 0; i < 100; ++i)
+    {
+        int num_vertices = 2 + rng() % 25;
+        check_round_trips(random_dag(rng, num_vertices, rng() % (num_vertices * 3)), rng);
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+BOOST_AUTO_TEST_CASE(round_trips_on_random_cyclic_graphs)
+{
+    std::mt19937 rng(4);
+    for(int i = 0; i < 200; ++i)
+    {
+        int num_vertices = 2 + rng() % 25;
+        check_round_trips(random_cyclic_graph(rng, num_vertices, rng() % (num_vertices * 3)), rng);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,103 @@
+// *****************************************************************************
+//
+// test/size_changes_test.cpp
+//
+// Headers matched by name between a reloaded graph and the one it replaces,
+// and which reloads give back exactly the graph they replace.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+
+#include "test_graphs.hpp"
+#include "analysis/size_changes.hpp"
+#include <boost/test/unit_test.hpp>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+cpp_dep::include_graph_t make_named_graph(
+    std::vector<std::string> const& names,
+    std::vector<std::size_t> const& sizes,
+    std::vector<std::pair<int, int>> const& edges)
+{
+    cpp_dep::include_graph_t g = make_graph(sizes, edges);
+    for(std::size_t i = 0; i < names.size(); ++i)
+        g[i].name = names[i];
+
+    return g;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(size_changes_test)
+
+// -----------------------------------------------------------------------------
+//
+// x.h grows, y.h shrinks, w.h is untouched, z.h is new and both v.h and
+// u.h have gone, in a different vertex order.
+BOOST_AUTO_TEST_CASE(compared_by_name)
+{
+    cpp_dep::include_graph_t previous = make_named_graph(
+        { "main.cpp", "x.h", "y.h", "w.h", "v.h", "u.h" },
+        { 1, 100, 50, 7, 20, 30 },
+        { { 0, 1 }, { 0, 2 }, { 0, 3 }, { 0, 4 }, { 4, 5 } });
+
+    cpp_dep::include_graph_t current = make_named_graph(
+        { "main.cpp", "z.h", "w.h", "y.h", "x.h" },
+        { 1, 5, 7, 40, 120 },
+        { { 0, 4 }, { 0, 3 }, { 0, 2 }, { 4, 1 } });
+
+    size_changes changes = compare_sizes(previous, current);
+    BOOST_REQUIRE_EQUAL(changes.vertices.size(), 5u);
+    BOOST_CHECK_EQUAL(changes.vertices[0].state, size_change::unchanged);
+    BOOST_CHECK_EQUAL(changes.vertices[1].state, size_change::added);
+    BOOST_CHECK_EQUAL(changes.vertices[1].delta, 5);
+    BOOST_CHECK_EQUAL(changes.vertices[2].state, size_change::unchanged);
+    BOOST_CHECK_EQUAL(changes.vertices[2].delta, 0);
+    BOOST_CHECK_EQUAL(changes.vertices[3].state, size_change::shrunk);
+    BOOST_CHECK_EQUAL(changes.vertices[3].delta, -10);
+    BOOST_CHECK_EQUAL(changes.vertices[4].state, size_change::grown);
+    BOOST_CHECK_EQUAL(changes.vertices[4].delta, 20);
+
+    BOOST_REQUIRE_EQUAL(changes.removed.size(), 2u);
+    BOOST_CHECK_EQUAL(changes.removed[0].name, "u.h");
+    BOOST_CHECK_EQUAL(changes.removed[0].size, 30u);
+    BOOST_CHECK_EQUAL(changes.removed[1].name, "v.h");
+    BOOST_CHECK_EQUAL(changes.num_changed(), 5u);
+}
+
+// -----------------------------------------------------------------------------
+//
+// Anything that could change what's worked out from a graph makes it a
+// different graph.
+BOOST_AUTO_TEST_CASE(same_graphs)
+{
+    std::vector<std::string> names = { "main.cpp", "a.h", "b.h" };
+    std::vector<std::size_t> sizes = { 1, 10, 100 };
+    std::vector<std::pair<int, int>> edges = { { 0, 1 }, { 0, 2 }, { 1, 2 } };
+    cpp_dep::include_graph_t g = make_named_graph(names, sizes, edges);
+
+    BOOST_CHECK(same_graph(g, make_named_graph(names, sizes, edges)));
+    BOOST_CHECK(compare_sizes(g, g).num_changed() == 0);
+
+    cpp_dep::include_graph_t resized = make_named_graph(names, sizes, edges);
+    resized[2].size_dependencies = 1;
+    BOOST_CHECK(!same_graph(g, resized));
+
+    BOOST_CHECK(!same_graph(g, make_named_graph({ "main.cpp", "a.h", "c.h" }, sizes, edges)));
+    BOOST_CHECK(!same_graph(g, make_named_graph(names, { 1, 10, 101 }, edges)));
+    BOOST_CHECK(!same_graph(g, make_named_graph(names, sizes, { { 0, 1 }, { 0, 2 } })));
+    BOOST_CHECK(!same_graph(g, make_named_graph(names, sizes, { { 0, 2 }, { 0, 1 }, { 1, 2 } })));
+    BOOST_CHECK(!same_graph(g, make_named_graph(names, sizes, { { 0, 1 }, { 0, 2 }, { 0, 2 } })));
+    BOOST_CHECK(!same_graph(g, make_named_graph({ "main.cpp", "a.h" }, { 1, 10 }, { { 0, 1 } })));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
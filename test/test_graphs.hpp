@@ -0,0 +1,99 @@
+// *****************************************************************************
+//
+// test/test_graphs.hpp
+//
+// Small include graphs for the regression tests, built by hand or at
+// random, and a printable summary of a graph for comparing two of them.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+#ifndef CPPSIZE_TEST_TESTGRAPHS_HPP_
+#define CPPSIZE_TEST_TESTGRAPHS_HPP_
+
+#include "cpp_dep/cpp_dep.hpp"
+#include <boost/range/iterator_range.hpp>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+// Vertex i is named h<i>.h and has sizes[i] bytes.
+inline cpp_dep::include_graph_t make_graph(
+    std::vector<std::size_t> const& sizes,
+    std::vector<std::pair<int, int>> const& edges)
+{
+    cpp_dep::include_graph_t g;
+    for(std::size_t i = 0; i < sizes.size(); ++i)
+    {
+        auto v = boost::add_vertex(g);
+        g[v].name = "h" + std::to_string(i) + ".h";
+        g[v].size = sizes[i];
+    }
+
+    for(auto&& edge : edges)
+    {
+        boost::add_edge(edge.first, edge.second, g);
+    }
+
+    return g;
+}
+
+// -----------------------------------------------------------------------------
+//
+// Edges only run from lower to higher vertices, so the graph is acyclic.
+// The same include can appear more than once, as it does in a log.
+inline cpp_dep::include_graph_t random_dag(
+    std::mt19937& rng,
+    int num_vertices,
+    int num_edges)
+{
+    std::vector<std::size_t> sizes;
+    for(int i = 0; i < num_vertices; ++i)
+    {
+        sizes.push_back(1 + rng() % 1000);
+    }
+
+    std::vector<std::pair<int, int>> edges;
+    for(int e = 0; e < num_edges; ++e)
+    {
+        int a = rng() % num_vertices;
+        int b = rng() % num_vertices;
+        if(a != b)
+            edges.emplace_back(std::min(a, b), std::max(a, b));
+    }
+
+    return make_graph(sizes, edges);
+}
+
+// -----------------------------------------------------------------------------
+//
+// Every vertex as name, size and size_dependencies and every edge by name,
+// sorted so graphs built in a different vertex order compare equal.
+inline std::vector<std::string> summarise(cpp_dep::include_graph_t const& g)
+{
+    std::vector<std::string> lines;
+    for(auto v : boost::make_iterator_range(boost::vertices(g)))
+    {
+        lines.push_back(
+            g[v].name + " " + std::to_string(g[v].size) + " " +
+            std::to_string(g[v].size_dependencies));
+    }
+
+    for(auto e : boost::make_iterator_range(boost::edges(g)))
+    {
+        lines.push_back(g[boost::source(e, g)].name + " -> " + g[boost::target(e, g)].name);
+    }
+
+    std::sort(lines.begin(), lines.end());
+    return lines;
+}
+
+#endif // CPPSIZE_TEST_TESTGRAPHS_HPP_
@@ -0,0 +1,18 @@
+// *****************************************************************************
+//
+// test/test_main.cpp
+//
+// Entry point for the regression tests. Boost.Test is used header only so
+// the tests need nothing beyond the Boost libraries the tools already use.
+// Run from the source directory so the sample logs in test/ are found.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+
+#define BOOST_TEST_MODULE cpp-size
+#include <boost/test/included/unit_test.hpp>
@@ -0,0 +1,155 @@
+// *****************************************************************************
+//
+// test/time_trace_test.cpp
+//
+// Header times read from clang traces and msvc reports, and matched to the
+// vertices of an include graph.
+//
+// Copyright Chris Glover 2015
+//
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt
+//
+// *****************************************************************************
+
+#include "test_graphs.hpp"
+#include "parse/time_trace.hpp"
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+//
+namespace {
+
+time_report read_clang(std::string const& text)
+{
+    std::istringstream in(text);
+    return read_clang_time_trace(in);
+}
+
+time_report read_msvc(std::string const& text)
+{
+    return read_msvc_time_report(text.data(), text.data() + text.size());
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(time_trace_test)
+
+// -----------------------------------------------------------------------------
+//
+// a.h is entered twice, the second time through b.h, and only complete
+// events count.
+BOOST_AUTO_TEST_CASE(clang_trace)
+{
+    time_report report = read_clang(
+        "{ \"traceEvents\": ["
+        "  { \"ph\": \"X\", \"name\": \"Source\", \"ts\": 10, \"dur\": 1000000, \"args\": { \"detail\": \"a.h\" } },"
+        "  { \"ph\": \"X\", \"name\": \"Source\", \"ts\": 2000000, \"dur\": 3000000, \"args\": { \"detail\": \"b.h\", \"x\": [1, 2] } },"
+        "  { \"ph\": \"X\", \"name\": \"Source\", \"ts\": 2500000, \"dur\": 500000, \"args\": { \"detail\": \"a.h\" } },"
+        "  { \"ph\": \"B\", \"name\": \"Source\", \"ts\": 0, \"dur\": 9000000, \"args\": { \"detail\": \"c.h\" } },"
+        "  { \"ph\": \"X\", \"name\": \"ExecuteCompiler\", \"ts\": 0, \"dur\": 8000000 }"
+        "], \"beginningOfTime\": 0 }");
+
+    BOOST_CHECK_CLOSE(report.total_seconds, 8.0, 1e-9);
+    BOOST_REQUIRE_EQUAL(report.header_seconds.size(), 2u);
+    BOOST_CHECK_CLOSE(report.header_seconds["a.h"], 1.5, 1e-9);
+    BOOST_CHECK_CLOSE(report.header_seconds["b.h"], 3.0, 1e-9);
+}
+
+// -----------------------------------------------------------------------------
+//
+// Without an ExecuteCompiler event the total is the span of the events.
+BOOST_AUTO_TEST_CASE(clang_trace_as_bare_array)
+{
+    time_report report = read_clang(
+        "[ { \"ph\": \"X\", \"name\": \"Source\", \"ts\": 1000000, \"dur\": 2000000, \"args\": { \"detail\": \"a.h\" } },"
+        "  { \"ph\": \"X\", \"name\": \"Frontend\", \"ts\": 500000, \"dur\": 4000000 } ]");
+
+    BOOST_CHECK_CLOSE(report.total_seconds, 4.0, 1e-9);
+    BOOST_CHECK_CLOSE(report.header_seconds["a.h"], 2.0, 1e-9);
+
+    BOOST_CHECK_THROW(read_clang("\"not a trace\""), std::runtime_error);
+    BOOST_CHECK_THROW(read_clang("{ \"traceEvents\": [ { \"ph\": "), std::runtime_error);
+}
+
+// -----------------------------------------------------------------------------
+//
+// Only the top level of each section counts towards the total, and the
+// rest of the log is ignored.
+BOOST_AUTO_TEST_CASE(msvc_report)
+{
+    time_report report = read_msvc(
+        "Compiling a.cpp\r\n"
+        "Include Headers:\r\n"
+        "\tCount: 3\r\n"
+        "\t\tC:\\inc\\x.h: 0.50000s\r\n"
+        "\t\t\tC:\\inc\\y.h: 0.20000s\r\n"
+        "\t\tz.h: 0.25000s\r\n"
+        "\t\tnot a timing\r\n"
+        "a.cpp\r\n"
+        "Include Headers:\n"
+        "\tCount: 1\n"
+        "\t\tC:\\inc\\y.h: 1.00000s\n");
+
+    BOOST_CHECK_CLOSE(report.total_seconds, 1.75, 1e-9);
+    BOOST_REQUIRE_EQUAL(report.header_seconds.size(), 3u);
+    BOOST_CHECK_CLOSE(report.header_seconds["C:\\inc\\x.h"], 0.5, 1e-9);
+    BOOST_CHECK_CLOSE(report.header_seconds["C:\\inc\\y.h"], 1.2, 1e-9);
+    BOOST_CHECK_CLOSE(report.header_seconds["z.h"], 0.25, 1e-9);
+
+    BOOST_CHECK(read_msvc("Compiling a.cpp\n").header_seconds.empty());
+    BOOST_CHECK(read_msvc("").header_seconds.empty());
+}
+
+// -----------------------------------------------------------------------------
+//
+BOOST_AUTO_TEST_CASE(merged_reports)
+{
+    time_report first = read_msvc("Include Headers:\n\t\ta.h: 1s\n");
+    time_report second = read_msvc("Include Headers:\n\t\ta.h: 2s\n\t\tb.h: 3s\n");
+    first.merge(second);
+
+    BOOST_CHECK_CLOSE(first.total_seconds, 6.0, 1e-9);
+    BOOST_CHECK_CLOSE(first.header_seconds["a.h"], 3.0, 1e-9);
+    BOOST_CHECK_CLOSE(first.header_seconds["b.h"], 3.0, 1e-9);
+}
+
+// -----------------------------------------------------------------------------
+//
+// Names are matched once normalised, spellings of one header are summed,
+// roots get the total and anything untimed is 0.
+BOOST_AUTO_TEST_CASE(attached_to_graph)
+{
+    cpp_dep::include_graph_t g = make_graph({ 0, 0, 0, 0 }, { { 0, 1 }, { 1, 2 }, { 0, 3 } });
+    g[0].name = "main.cpp";
+    g[1].name = "c:/inc/x.h";
+    g[2].name = "c:/inc/y.h";
+    g[3].name = "z.h";
+
+    time_report report;
+    report.total_seconds = 10;
+    report.header_seconds["C:\\inc\\x.h"] = 2;
+    report.header_seconds["C:/Inc/X.h"] = 1;
+    report.header_seconds["c:\\inc\\..\\inc\\y.h"] = 0.5;
+
+    std::vector<double> seconds = attach_header_times(report, g);
+    std::vector<double> expected = { 10, 3, 0.5, 0 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(seconds.begin(), seconds.end(), expected.begin(), expected.end());
+}
+
+// -----------------------------------------------------------------------------
+//
+BOOST_AUTO_TEST_CASE(trace_filenames)
+{
+    BOOST_CHECK(is_time_trace_filename("build/a.cpp.json"));
+    BOOST_CHECK(!is_time_trace_filename("build/compile_commands.json"));
+    BOOST_CHECK(!is_time_trace_filename("build/msvc.log"));
+    BOOST_CHECK(!is_time_trace_filename("build/a.json.txt"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()